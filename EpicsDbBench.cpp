@@ -0,0 +1,196 @@
+#include "stdafx.h"
+#include "ParseTpy.h"
+#include "TpyToEpics.h"
+#include <chrono>
+
+using namespace std;
+using namespace ParseUtil;
+using namespace ParseTpy;
+using namespace EpicsTpy;
+
+
+/** @file EpicsDbBench.cpp
+	Source for a micro benchmark of the EPICS channel name conversion
+ ************************************************************************/
+
+/** Reference implementation of the name conversion. It applies each
+	conversion step as a separate pass over the name and is used to
+	verify and compare the results of epics_conversion::to_epics.
+	@param conv EPICS conversion settings
+	@param name TwinCAT/opc name
+	@return EPICS name
+	@brief Reference name conversion
+ ************************************************************************/
+static string to_epics_reference (const epics_conversion& conv, const stringcase& name)
+{
+	stringcase n (name);
+	stringcase::size_type pos = 0;
+
+	// apply replacement rules
+	if (conv.HasRules()) {
+		n = conv.apply_replacement_rules (n);
+	}
+	// eliminate leading dot
+	if (conv.get_dot_rule() || (conv.get_conversion_rule() == tc_epics_conv::ligo_std) ||
+		(conv.get_conversion_rule() == tc_epics_conv::ligo_vac)) {
+		if (!n.empty() && (n[0] == '.')) {
+			n.erase (0, 1);
+		}
+		else if ((pos = n.find ('.')) != stringcase::npos) {
+			n.erase (0, pos + 1);
+		}
+	}
+	// apply conversion rules
+	const char sep = (conv.get_conversion_rule() == tc_epics_conv::ligo_vac) ? '_' : '.';
+	switch (conv.get_conversion_rule()) {
+	case tc_epics_conv::ligo_std:
+	case tc_epics_conv::ligo_vac:
+		if ((pos = n.find (sep)) != stringcase::npos) n[pos] = ':';
+		if ((pos = n.find (sep)) != stringcase::npos) n[pos] = '-';
+		while ((pos = n.find ('.')) != stringcase::npos) n[pos] = '_';
+		break;
+	case tc_epics_conv::no_dot:
+		while ((pos = n.find ('.')) != stringcase::npos) n[pos] = '_';
+		break;
+	default:
+		break;
+	}
+	// force case if necessary
+	if (conv.get_case_rule() != case_type::preserve) {
+		for (pos = 0; pos < n.size(); ++pos) {
+			n[pos] = (conv.get_case_rule() == case_type::upper) ? toupper (n[pos]) : tolower (n[pos]);
+		}
+	}
+	// replace array brackets with underscore if necessary
+	if (conv.get_array_rule()) {
+		while ((pos = n.find ('[')) != stringcase::npos) n[pos] = '_';
+		while ((pos = n.find (']')) != stringcase::npos) n.erase (pos, 1);
+	}
+	// add prefix
+	n = conv.get_prefix() + n;
+	return string (n.c_str());
+}
+
+/** Main program
+ ************************************************************************/
+int main(int argc, char *argv[])
+{
+	int				count = 1000000;
+	stringcase		aliasname;
+	stringcase		rulestr;
+	bool			argp[100] = {false};
+	int				help = 0;
+
+	// command line parsing
+	if (argc > 100) argc = 100;
+	for (int i = 1; i < argc; ++i) {
+		stringcase arg (argv[i] ? argv[i] : "");
+		// specify number of names
+		if ((arg == "-n" || arg == "/n") && i + 1 < argc) {
+			count = atoi (argv[i + 1]);
+			argp[i] = argp[i + 1] = true;
+			i += 1;
+		}
+		// specify alias name
+		else if ((arg == "-a" || arg == "/a") && i + 1 < argc) {
+			aliasname = argv[i + 1];
+			argp[i] = argp[i + 1] = true;
+			i += 1;
+		}
+		// specify replacement rules name
+		else if ((arg == "-r" || arg == "/r") && i + 1 < argc) {
+			rulestr = argv[i + 1];
+			argp[i] = argp[i + 1] = true;
+			i += 1;
+		}
+		// ask for help
+		else if (arg == "-h" || arg == "/h" ) {
+			help = 1;
+			argp[i] = true;
+		}
+	}
+	epics_conversion conv (argc, argv, argp);
+	ParseUtil::replacement_rules rules (rulestr, aliasname);
+	conv.set_rule_table (rules.get_rule_table());
+
+	// check if all arguments were processed
+	for (int i = 1; i < argc; ++i) {
+		if (!argp[i]) help = 2;
+	}
+	if (help || (count <= 0)) {
+		printf ("Usage: EpicsDbBench ['options']\n"
+			"       Measures the conversion of TwinCAT names to EPICS channel names.\n"
+			"       -n 'num' number of names (default 1000000)\n"
+			"       -a 'alias' alias name for plc name\n"
+			"       -r 'rules' replacement rules\n"
+			"       -yd includes leading dot\n"
+			"       -r[n|d|l|v] no|dot|ligo|vacuum conversion rule for EPICS names\n"
+			"       -c[p|u|l] preserve case/force upper/lower case for EPICS names\n"
+			"       -yi leave array indices in channel names\n"
+			"       -p 'name' include a prefix of 'name' for every channel\n");
+		return (help == 2) ? 1 : 0;
+	}
+
+	// generate names as they appear in a tpy file
+	vector<stringcase> names;
+	names.reserve (count);
+	char buf[256];
+	for (int i = 0; i < count; ++i) {
+		switch (i % 4) {
+		case 0:
+			sprintf_s (buf, sizeof (buf), ".GV_Sys%i.Sensor_%i.Axis[%i].Status.bValue", i % 17, i, i % 8);
+			break;
+		case 1:
+			sprintf_s (buf, sizeof (buf), "MAIN.fbChannel_%i.arrData[%i][%i]", i, i % 32, i % 4);
+			break;
+		case 2:
+			sprintf_s (buf, sizeof (buf), ".C1_VAC_Gauge%i.Pressure.fValue", i);
+			break;
+		default:
+			sprintf_s (buf, sizeof (buf), "GVL.Rack%i.Slot%i.Ch%i.nCounts", i % 7, i % 13, i);
+			break;
+		}
+		names.push_back (buf);
+	}
+
+	// reference implementation
+	size_t total_ref = 0;
+	vector<string> results;
+	results.reserve (count);
+	auto t0 = chrono::steady_clock::now();
+	for (const auto& n : names) {
+		results.push_back (to_epics_reference (conv, n));
+		total_ref += results.back().size();
+	}
+	auto t1 = chrono::steady_clock::now();
+
+	// single pass implementation
+	size_t total = 0;
+	int mismatch = 0;
+	auto t2 = chrono::steady_clock::now();
+	for (const auto& n : names) {
+		total += conv.to_epics (n).size();
+	}
+	auto t3 = chrono::steady_clock::now();
+
+	// verify
+	for (int i = 0; i < count; ++i) {
+		const string s = conv.to_epics (names[i]);
+		if (s != results[i]) {
+			if (mismatch < 10) {
+				fprintf (stderr, "Mismatch for %s: %s != %s\n",
+					names[i].c_str(), s.c_str(), results[i].c_str());
+			}
+			++mismatch;
+		}
+	}
+
+	const double ref_ms = chrono::duration<double, milli>(t1 - t0).count();
+	const double new_ms = chrono::duration<double, milli>(t3 - t2).count();
+	printf ("Names converted:   %i (%zu/%zu characters)\n", count, total, total_ref);
+	printf ("Reference:         %10.1f ms (%6.1f ns/name)\n", ref_ms, 1E6 * ref_ms / count);
+	printf ("Single pass:       %10.1f ms (%6.1f ns/name)\n", new_ms, 1E6 * new_ms / count);
+	printf ("Speedup:           %10.2f\n", (new_ms > 0) ? ref_ms / new_ms : 0.0);
+	printf ("Mismatches:        %i\n", mismatch);
+	return mismatch ? 1 : 0;
+}
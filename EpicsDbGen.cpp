@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "ParseTpy.h"
 #include "TpyToEpics.h"
+#include <filesystem>
 
 using namespace std;
 using namespace ParseUtil;
@@ -79,6 +80,31 @@ int main(int argc, char *argv[])
 	}
 	bool* argp = macros ? argp_macro : (listing ? argp_list : argp_db);
 	tpyfile.getopt (argc, argv, argp);
+	// check if the output is up to date, before the processors open 
+	// (and thereby truncate) their output files
+	generation_manifest manifest;
+	stringcase outputname;
+	generation_manifest::hash_type key = 0;
+	if (!outfilename.empty() && !inpfilename.empty()) {
+		outputname = outfilename;
+		if (macros) {
+			std::filesystem::path mname (outputname.c_str());
+			mname /= "EpicsDbGen";
+			manifest.read (stringcase (mname.string().c_str()) + generation_manifest::extension);
+		}
+		else {
+			manifest.read (outfilename + generation_manifest::extension);
+		}
+		key = generation_manifest::hash_file (inpfilename, generation_manifest::hash_version());
+		for (int i = 1; i < argc; ++i) {
+			key = generation_manifest::hash (argv[i] ? argv[i] : "", key);
+		}
+		if (key && manifest.is_current (outputname, key)) {
+			fprintf (stderr, "Output %s is up to date.\n", outputname.c_str());
+			return 0;
+		}
+	}
+
 	// default conversion rules
 	epics_list_processing	listproc;
 	epics_db_processing		dbproc;
@@ -150,7 +176,7 @@ int main(int argc, char *argv[])
 
 	// print status of output
 	fprintf (stderr, "Output to %s\n", 
-		listproc.get_file() == stdout ? "stdout" : outfilename.c_str());
+		outfilename.empty() ? "stdout" : outfilename.c_str());
 	fprintf (stderr, "Arguments are");
 	// print arguments
 	for (int i = 1; i < argc; ++i) {
@@ -169,6 +195,9 @@ int main(int argc, char *argv[])
 		fprintf (stderr, "Unable to parse %s.\n", inpfilename.c_str());
 		return 1;
 	}
+	fprintf (stderr, "Parsed %.1f MB in %.3f sec (%.1f MB/s).\n", 
+		tpyfile.get_parse_size() / 1E6, tpyfile.get_parse_time(), 
+		tpyfile.get_parse_rate());
 
 	// generate macro files
 	if (macros) {
@@ -196,6 +225,26 @@ int main(int argc, char *argv[])
 		dbproc.flush();
 	}
 
+	// remember the generated output
+	if (!outputname.empty() && key) {
+		std::vector<stringcase> files;
+		if (macros) {
+			files = generation_manifest::list_files (outputname);
+			const auto errfiles = macroproc.get_errorlist_files();
+			files.insert (files.end(), errfiles.begin(), errfiles.end());
+		}
+		else {
+			split_io_support& iosupp = listing ? 
+				(split_io_support&)(listproc) : (split_io_support&)(dbproc);
+			iosupp.close();
+			files = iosupp.get_filenames();
+		}
+		manifest.set_output (outputname, key, files);
+		if (!manifest.write()) {
+			fprintf (stderr, "Failed to write manifest for %s.\n", outputname.c_str());
+		}
+	}
+
 	// write summary information
 	if (macros) {
 		fprintf (stdout, "\nSummary:\n");
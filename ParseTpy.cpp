@@ -2,6 +2,7 @@
 #include "ParseTpy.h"
 #include "ParseUtilConst.h"
 #include "ParseTpyConst.h"
+#include <chrono>
 #define XML_STATIC ///< Static linking
 #include "Expat/expat.h"
 #if defined(__amigaos__) && defined(__USE_INLINE__)
@@ -117,6 +118,8 @@ public:
 	int				bitoffs_parse;
 	/// temporary data string for parsed igroup/ioffset/bitsize/bitoffs
 	std::stringcase	data;
+	/// temporary data string for a parsed type name
+	std::stringcase	type_data;
 
 	/// level indicator for array info parsing
 	int				array_parse;
@@ -170,6 +173,7 @@ private:
 	 ioffset_parse = 0;
 	 bitsize_parse = 0;
 	 data = std::stringcase ("");
+	 type_data.clear();
 	 array_parse = 0;
 	 array_data = std::stringcase ("");
 	 array_bounds = dimension (0, 0);
@@ -251,9 +255,10 @@ bool ads_routing_info::set (const std::stringcase& s)
 	char buf[256] = "";
 	int p = 0;
 	int end = 0;
-	const int num = sscanf_s (s.c_str(), " tc://%255s:%i%n", 
+	const int num = sscanf_s (s.c_str(), " tc://%255[^:]:%i%n", 
 		buf, static_cast<unsigned>(sizeof (buf)), &p, &end);
-	if ((num != 2) || (end != s.length())) {
+	if ((num != 2) || ((end != s.length()) && 
+		(s.compare (end, std::stringcase::npos, "/") != 0))) {
 		ads_netid = "";
 		ads_port = 0;
 		return false;
@@ -368,30 +373,93 @@ bool compareNamesWoNamespace (const std::stringcase& p1, const std::stringcase&
 const type_map::value_type::second_type* 
 type_map::find (value_type::first_type id, const std::stringcase& typn) const
 {
-	const_iterator t = end();
+#ifdef DEBUG
+	++lookups;
+#endif
+	// types without decoration are looked up by name only. Since the index 
+	// is in multimap order, types with a zero id are still found first.
+	if ((id == 0) && indexed) {
+		const auto bucket = name_index.find (base_name (typn));
+		if (bucket != name_index.end()) {
+			for (const type_record* t : bucket->second) {
+				if (compareNamesWoNamespace (t->get_name(), typn)) {
+#ifdef DEBUG
+					++index_hits;
+#endif
+					return t;
+				}
+			}
+		}
+#ifdef DEBUG
+		++misses;
+#endif
+		return nullptr;
+	}
 	const_iterator i = type_multipmap::find (id);
 	while (i != end()) {
 		if (i->first != id) {
 			break;
 		}
 		if (compareNamesWoNamespace (i->second.get_name(), typn)) {
-			t = i;
-			break;
+#ifdef DEBUG
+			++id_hits;
+#endif
+			return &i->second;
 		}
 		++i;
 	}
+	if (id != 0) {
+#ifdef DEBUG
+		++misses;
+#endif
+		return nullptr;
+	}
 	// fall back to linear search if id == 0, and not found with id == 0
-	if ((t == end()) && (id == 0)) {
-		i = begin();
-		while (i != end()) {
-			if (compareNamesWoNamespace(i->second.get_name(), typn)) {
-				t = i;
-				break;
-			}
-			++i;
+#ifdef DEBUG
+	++linear_searches;
+#endif
+	for (i = begin(); i != end(); ++i) {
+		if (compareNamesWoNamespace(i->second.get_name(), typn)) {
+			return &i->second;
 		}
 	}
-	return (t == end()) ? nullptr : &t->second;
+#ifdef DEBUG
+	++misses;
+#endif
+	return nullptr;
+}
+
+/* type_map::base_name
+ ************************************************************************/
+std::stringcase type_map::base_name (const std::stringcase& typn)
+{
+	const std::stringcase::size_type pos = typn.rfind ('.');
+	return (pos == std::stringcase::npos) ? typn : typn.substr (pos + 1);
+}
+
+/* type_map::build_index
+ ************************************************************************/
+void type_map::build_index()
+{
+	name_index.clear();
+	name_index.reserve (size());
+	for (const auto& i : *this) {
+		name_index[base_name (i.second.get_name())].push_back (&i.second);
+	}
+	indexed = true;
+}
+
+/* type_map::print_statistics
+ ************************************************************************/
+void type_map::print_statistics (FILE* fp) const
+{
+#ifdef DEBUG
+	fprintf (fp, "Type lookups: %lld total, %lld by id, %lld by name index, "
+		"%lld linear, %lld failed (%i types, %i names)\n", 
+		(long long)lookups, (long long)id_hits, (long long)index_hits, 
+		(long long)linear_searches, (long long)misses, 
+		(int)size(), (int)name_index.size());
+#endif
 }
 
 /* type_map::patch_type_decorators
@@ -403,6 +471,9 @@ int type_map::patch_type_decorators()
 	// simple data type
 	std::regex e(R"++(SINT|INT|DINT|LINT|USINT|UINT|UDINT|ULINT|BYTE|WORD|DWORD|LWORD|TIME|TOD|LTIME|DATE|DT|TIME_OF_DAY|DATE_AND_TIME|REAL|LREAL|BOOL|STRING|STRING\([0-9]+\))++");
 
+	// build the name index for lookups without type decoration
+	build_index();
+
 	for (auto& i : *this)	{
 		id = i.second.get_type_decoration();
 		// check for zero id, array type and non-trivial type
@@ -426,6 +497,64 @@ tpy_file::tpy_file (FILE* inp)
 	parse (inp);
 }
 
+/** Creates an XML parser with the tpy callbacks.
+	@param info Parser information
+	@return XML parser
+ ************************************************************************/
+static XML_Parser create_parser (parserinfo_type& info)
+{
+	XML_Parser parser = XML_ParserCreate (NULL);
+	if (parser) {
+		XML_SetUserData (parser, &info);
+		XML_SetElementHandler (parser, startElement, endElement);
+		XML_SetCdataSectionHandler (parser, startCData, endCData);
+		XML_SetCharacterDataHandler (parser, dataElement);
+	}
+	return parser;
+}
+
+/** Prints the XML parser error.
+	@param parser XML parser
+	@return False
+ ************************************************************************/
+static bool parse_error (XML_Parser parser)
+{
+	fprintf (stderr,
+		"%s at line %" XML_FMT_INT_MOD "u\n",
+		XML_ErrorString (XML_GetErrorCode (parser)),
+		XML_GetCurrentLineNumber (parser));
+	return false;
+}
+
+/** Feeds a memory region to the parser. The region is passed in 
+	windows, so that Expat only ever copies a window into its buffer.
+	Pages of a mapped file are dropped once they have been parsed.
+	@param parser XML parser
+	@param p Pointer to data
+	@param len Length of data
+	@param mapped Mapped file the region belongs to (or nullptr)
+	@return True if successful
+ ************************************************************************/
+static bool parse_region (XML_Parser parser, const char* p, size_t len,
+	mapped_file* mapped = nullptr)
+{
+	const size_t window = 1024 * 1024;
+	do {
+		const size_t n = (len > window) ? window : len;
+		len -= n;
+#pragma warning (disable : 26812)
+		if (XML_Parse (parser, p, (int)n, len == 0) == XML_Status::XML_STATUS_ERROR) {
+			return parse_error (parser);
+		}
+#pragma warning (default : 26812)
+		p += n;
+		if (mapped) {
+			mapped->release (p - mapped->data());
+		}
+	} while (len > 0);
+	return true;
+}
+
 /* tpy_file::parse
  ************************************************************************/
 bool tpy_file::parse (FILE* inp)
@@ -433,37 +562,63 @@ bool tpy_file::parse (FILE* inp)
 	if (!inp) {
 		return false;
 	}
+	const auto start = std::chrono::steady_clock::now();
 
 	// Set up parser info
 	parserinfo_type info (project_info, sym_list, type_list);
 
 	// Initialize XML parser
-	char buf[BUFSIZ] = "";
-	XML_Parser parser = XML_ParserCreate (NULL);
-	XML_SetUserData (parser, &info);
-	XML_SetElementHandler (parser, startElement, endElement);
-	XML_SetCdataSectionHandler (parser, startCData, endCData);
-	XML_SetCharacterDataHandler (parser, dataElement);
+	XML_Parser parser = create_parser (info);
+	if (!parser) {
+		return false;
+	}
 
-	// read data and parse
-	bool done = false;
-	do {
-		const int len = (int)fread(buf, 1, sizeof(buf), inp);
-		done = len < sizeof(buf);
-#pragma warning (disable : 26812)
-		if (XML_Parse (parser, buf, len, done) == XML_Status::XML_STATUS_ERROR) {
-			fprintf (stderr,
-				"%s at line %" XML_FMT_INT_MOD "u\n",
-				XML_ErrorString (XML_GetErrorCode (parser)),
-				XML_GetCurrentLineNumber (parser));
-			return false;
+	// parse a regular file in place
+	bool succ = true;
+	size_t total = 0;
+	mapped_file mapped;
+	{
+		startup_profiler::phase prof ("file read");
+		mapped.open (inp);
+	}
+	{
+		startup_profiler::phase prof ("xml parse");
+		if (mapped.is_open()) {
+			total = mapped.size();
+			succ = parse_region (parser, mapped.data(), total, &mapped);
 		}
+		// otherwise read data directly into the parser buffer
+		else {
+			const int chunk = 1024 * 1024;
+			bool done = false;
+			do {
+				void* const buf = XML_GetBuffer (parser, chunk);
+				if (!buf) {
+					succ = parse_error (parser);
+					break;
+				}
+				const int len = (int)fread (buf, 1, chunk, inp);
+				done = len < chunk;
+				total += len;
+#pragma warning (disable : 26812)
+				if (XML_ParseBuffer (parser, len, done) == XML_Status::XML_STATUS_ERROR) {
+					succ = parse_error (parser);
+					break;
+				}
 #pragma warning (default : 26812)
-	} while (!done);
+			} while (!done);
+		}
+	}
 
 	// Finish up
-	XML_ParserFree(parser);
+	XML_ParserFree (parser);
+	if (!succ) {
+		return false;
+	}
 	parse_finish();
+	parse_size = total;
+	parse_time = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
 	return true;
 }
 
@@ -474,42 +629,689 @@ bool tpy_file::parse (const char* p, int len)
 	if (!p || (len < 0)) {
 		return false;
 	}
+	const auto start = std::chrono::steady_clock::now();
+
 	// Set up parser info
 	parserinfo_type info (project_info, sym_list, type_list);
 
 	// Initialize XML parser
-	XML_Parser parser = XML_ParserCreate (NULL);
-	XML_SetUserData (parser, &info);
-	XML_SetElementHandler (parser, startElement, endElement);
-	XML_SetCdataSectionHandler (parser, startCData, endCData);
-	XML_SetCharacterDataHandler (parser, dataElement);
-
-	// read data and parse
-#pragma warning (disable : 26812)
-	if (XML_Parse (parser, p, len, true) == XML_Status::XML_STATUS_ERROR) {
-		fprintf (stderr,
-			"%s at line %" XML_FMT_INT_MOD "u\n",
-			XML_ErrorString (XML_GetErrorCode (parser)),
-			XML_GetCurrentLineNumber (parser));
+	XML_Parser parser = create_parser (info);
+	if (!parser) {
 		return false;
 	}
-#pragma warning (default : 26812)
+
+	// parse data
+	bool succ = false;
+	{
+		startup_profiler::phase prof ("xml parse");
+		succ = parse_region (parser, p, (size_t)len);
+	}
 
 	// Finish up
-	XML_ParserFree(parser);
+	XML_ParserFree (parser);
+	if (!succ) {
+		return false;
+	}
 	parse_finish();
+	parse_size = (size_t)len;
+	parse_time = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
 	return true;
 }
 
+/** This class reads little endian fields from an ADS symbol upload
+	and keeps track of the remaining length of the entry.
+	@brief ADS upload reader
+ ************************************************************************/
+class upload_reader
+{
+public:
+	/// Constructor
+	upload_reader (const char* first, const char* last) noexcept
+		: p (first), end (last) {}
+
+	/// Remaining number of bytes
+	size_t size() const noexcept { return (p < end) ? end - p : 0; }
+	/// Current position
+	const char* pos() const noexcept { return p; }
+	/// Read a plain value
+	template <typename T>
+	bool get (T& val) noexcept {
+		if (size() < sizeof (T)) return false;
+		memcpy (&val, p, sizeof (T));
+		p += sizeof (T);
+		return true;
+	}
+	/// Read a zero terminated string of given length
+	bool get (std::stringcase& str, size_t len) {
+		if (size() < len + 1) return false;
+		str.assign (p, len);
+		p += len + 1;
+		return true;
+	}
+	/// Skip a number of bytes
+	bool skip (size_t len) noexcept {
+		if (size() < len) return false;
+		p += len;
+		return true;
+	}
+
+protected:
+	/// Current position
+	const char*	p;
+	/// End of entry
+	const char*	end;
+};
+
+/** This class writes little endian fields of an entry of an ADS symbol 
+	upload. The entry starts with its length, which is filled in when
+	the entry is finished.
+	@brief ADS upload writer
+ ************************************************************************/
+class upload_writer
+{
+public:
+	/// Constructor, starts an entry at the end of the buffer
+	explicit upload_writer (symbol_upload::buffer_type& buffer)
+		: buf (buffer), start (buffer.size()) { put ((unsigned int)0); }
+
+	/// Write a plain value
+	template <typename T>
+	void put (const T& val) {
+		const char* const p = reinterpret_cast<const char*>(&val);
+		buf.insert (buf.end(), p, p + sizeof (T));
+	}
+	/// Write a zero terminated string
+	void put (const std::stringcase& str) {
+		buf.insert (buf.end(), str.c_str(), str.c_str() + str.length() + 1);
+	}
+	/// Finish the entry by filling in its length
+	void finish() noexcept {
+		const unsigned int len = (unsigned int)(buf.size() - start);
+		memcpy (buf.data() + start, &len, sizeof (len));
+	}
+
+protected:
+	/// Buffer
+	symbol_upload::buffer_type&	buf;
+	/// Start of entry
+	size_t		start;
+};
+
+/** Adds an OPC setting from an attribute or a comment
+	@param opc OPC list
+	@param name Attribute name: opc or opc_prop[nnnn]
+	@param value Attribute value
+ ************************************************************************/
+static void upload_opc (opc_list& opc, std::stringcase name, 
+						const std::stringcase& value)
+{
+	trim_space (name);
+	if (name.compare (opcExport) == 0) {
+		const int num = strtol (value.c_str(), NULL, 10);
+		opc.set_opc_state (num ? opc_enum::publish : opc_enum::silent);
+	}
+	else if (name.compare (0, 8, opcProp) == 0) {
+		name.erase (0, 8);
+		trim_space (name);
+		if (name.compare (0, 1, opcBracket) == 0) name.erase (0, 1);
+		const int num = strtol (name.c_str(), NULL, 10);
+		if (num > 0) {
+			std::stringcase val (value);
+			trim_space (val);
+			opc.add (property_el (num, val));
+		}
+	}
+}
+
+/** Adds the OPC settings from a TwinCAT 2 comment of the form
+	(OPC : 1 : text) (OPC_PROP[nnnn] : value : text)
+	@param opc OPC list
+	@param comment Comment of symbol or data type
+ ************************************************************************/
+static void upload_comment (opc_list& opc, const std::stringcase& comment)
+{
+	if (comment.empty()) return;
+	static const std::regex e (R"++(\(\s*(OPC|OPC_PROP\s*\[\s*[0-9]+\s*\])\s*:\s*([^:)]*))++",
+		std::regex_constants::icase);
+	const std::string s (comment.c_str());
+	for (std::sregex_iterator i (s.begin(), s.end(), e); i != std::sregex_iterator(); ++i) {
+		upload_opc (opc, (*i)[1].str().c_str(), (*i)[2].str().c_str());
+	}
+}
+
+/** Reads the attribute list of a symbol or data type entry
+	@param r Reader positioned at the attribute count
+	@param opc OPC list
+	@return True if successful
+ ************************************************************************/
+static bool upload_attributes (upload_reader& r, opc_list& opc)
+{
+	unsigned short num = 0;
+	if (!r.get (num)) return false;
+	for (unsigned short i = 0; i < num; ++i) {
+		unsigned char namelen = 0;
+		unsigned char valuelen = 0;
+		std::stringcase name;
+		std::stringcase value;
+		if (!r.get (namelen) || !r.get (valuelen) ||
+			!r.get (name, namelen) || !r.get (value, valuelen)) {
+			return false;
+		}
+		upload_opc (opc, name, value);
+	}
+	return true;
+}
+
+/** Checks if a type name describes a pointer or a reference
+ ************************************************************************/
+static bool upload_is_pointer (const std::stringcase& typn)
+{
+	return (typn.compare (0, 10, "POINTER TO") == 0) ||
+		   (typn.compare (0, 12, "REFERENCE TO") == 0);
+}
+
+/** Parses a data type entry of an ADS data type upload (including its
+	sub items, which are data type entries themselves)
+	@param p Pointer to entry
+	@param end End of upload
+	@param rec Type record (return)
+	@param bitoffs Bit offset of sub item within its parent (return)
+	@return Length of entry, 0 on error
+ ************************************************************************/
+static unsigned int upload_datatype (const char* p, const char* end, 
+									 type_record& rec, int& bitoffs)
+{
+	unsigned int entryLength = 0;
+	unsigned int version = 0;
+	unsigned int hashValue = 0;
+	unsigned int typeHashValue = 0;
+	unsigned int size = 0;
+	unsigned int offs = 0;
+	unsigned int dataType = 0;
+	unsigned int flags = 0;
+	unsigned short nameLength = 0;
+	unsigned short typeLength = 0;
+	unsigned short commentLength = 0;
+	unsigned short arrayDim = 0;
+	unsigned short subItems = 0;
+	upload_reader hdr (p, end);
+	if (!hdr.get (entryLength) || (entryLength > hdr.size() + sizeof (entryLength))) {
+		return 0;
+	}
+	upload_reader r (hdr.pos(), p + entryLength);
+	std::stringcase name;
+	std::stringcase typn;
+	std::stringcase comment;
+	if (!r.get (version) || !r.get (hashValue) || !r.get (typeHashValue) ||
+		!r.get (size) || !r.get (offs) || !r.get (dataType) || !r.get (flags) ||
+		!r.get (nameLength) || !r.get (typeLength) || !r.get (commentLength) ||
+		!r.get (arrayDim) || !r.get (subItems) || !r.get (name, nameLength) || 
+		!r.get (typn, typeLength) || !r.get (comment, commentLength)) {
+		return 0;
+	}
+	trim_space (typn);
+	rec.set_name (name);
+	rec.set_type_name (typn);
+	rec.set_type_pointer (upload_is_pointer (typn));
+	const bool bits = (flags & adsDtFlagBitValues) != 0;
+	rec.set_bit_size (bits ? size : 8 * size);
+	bitoffs = bits ? offs : 8 * offs;
+	upload_comment (rec.get_opc(), comment);
+
+	// array dimensions
+	for (unsigned short i = 0; i < arrayDim; ++i) {
+		int lBound = 0;
+		int elements = 0;
+		if (!r.get (lBound) || !r.get (elements)) return 0;
+		rec.get_array_dimensions().push_back (dimension (lBound, elements));
+	}
+	// sub items
+	for (unsigned short i = 0; i < subItems; ++i) {
+		type_record sub;
+		int subofs = 0;
+		const unsigned int len = upload_datatype (r.pos(), r.pos() + r.size(), sub, subofs);
+		if ((len == 0) || !r.skip (len)) return 0;
+		item_record item;
+		item.set_name (sub.get_name());
+		item.set_type_name (sub.get_type_name());
+		item.set_type_pointer (sub.get_type_pointer());
+		item.get_opc() = sub.get_opc();
+		item.set_bit_offset (subofs);
+		item.set_bit_size (sub.get_bit_size());
+		rec.get_struct_list().push_back (item);
+	}
+	// TwinCAT 3 extensions
+	if ((flags & adsDtFlagTypeGuid) && !r.skip (adsGuidLength)) return 0;
+	if ((flags & adsDtFlagCopyMask) && !r.skip (size)) return 0;
+	if (flags & adsDtFlagMethodInfos) {
+		unsigned short num = 0;
+		if (!r.get (num)) return 0;
+		for (unsigned short i = 0; i < num; ++i) {
+			upload_reader m (r.pos(), r.pos() + r.size());
+			unsigned int len = 0;
+			if (!m.get (len) || !r.skip (len)) return 0;
+		}
+	}
+	if ((flags & adsDtFlagAttributes) && !upload_attributes (r, rec.get_opc())) return 0;
+	if (flags & adsDtFlagEnumInfos) {
+		unsigned short num = 0;
+		if (!r.get (num)) return 0;
+		for (unsigned short i = 0; i < num; ++i) {
+			unsigned char len = 0;
+			std::stringcase ename;
+			long long val = 0;
+			if (!r.get (len) || !r.get (ename, len) || (size > sizeof (val))) return 0;
+			upload_reader v (r.pos(), r.pos() + r.size());
+			switch (size) {
+			case 1: { signed char x = 0; if (!v.get (x)) return 0; val = x; break; }
+			case 2: { short x = 0; if (!v.get (x)) return 0; val = x; break; }
+			case 4: { int x = 0; if (!v.get (x)) return 0; val = x; break; }
+			default: { if (!v.get (val)) return 0; break; }
+			}
+			if (!r.skip (size)) return 0;
+			rec.get_enum_list().insert (enum_pair ((int)val, ename));
+		}
+	}
+
+	// type description
+	if (!rec.get_enum_list().empty()) {
+		rec.set_type_description (type_enum::enumtype);
+	}
+	else if (arrayDim > 0) {
+		rec.set_type_description (type_enum::arraytype);
+	}
+	else if (subItems > 0) {
+		rec.set_type_description (type_enum::structtype);
+	}
+	else {
+		rec.set_type_description (type_enum::simple);
+	}
+	return entryLength;
+}
+
+/** Parses a symbol entry of an ADS symbol upload
+	@param p Pointer to entry
+	@param end End of upload
+	@param sym Symbol record (return)
+	@param bitvalue True if offset and size are in bits (return)
+	@return Length of entry, 0 on error
+ ************************************************************************/
+static unsigned int upload_symbol (const char* p, const char* end, symbol_record& sym,
+								   bool& bitvalue)
+{
+	unsigned int entryLength = 0;
+	unsigned int iGroup = 0;
+	unsigned int iOffs = 0;
+	unsigned int size = 0;
+	unsigned int dataType = 0;
+	unsigned int flags = 0;
+	unsigned short nameLength = 0;
+	unsigned short typeLength = 0;
+	unsigned short commentLength = 0;
+	upload_reader hdr (p, end);
+	if (!hdr.get (entryLength) || (entryLength > hdr.size() + sizeof (entryLength))) {
+		return 0;
+	}
+	upload_reader r (hdr.pos(), p + entryLength);
+	std::stringcase name;
+	std::stringcase typn;
+	std::stringcase comment;
+	if (!r.get (iGroup) || !r.get (iOffs) || !r.get (size) || 
+		!r.get (dataType) || !r.get (flags) || !r.get (nameLength) || 
+		!r.get (typeLength) || !r.get (commentLength) || 
+		!r.get (name, nameLength) || !r.get (typn, typeLength) || 
+		!r.get (comment, commentLength)) {
+		return 0;
+	}
+	trim_space (typn);
+	bitvalue = (flags & adsSymFlagBitValue) != 0;
+	sym.set_name (name);
+	sym.set_type_name (typn);
+	sym.set_type_pointer (upload_is_pointer (typn));
+	sym.set_igroup (iGroup);
+	sym.set_ioffset (iOffs);
+	sym.set_bytesize (size);
+	upload_comment (sym.get_opc(), comment);
+	// TwinCAT 3 extensions
+	if ((flags & adsSymFlagTypeGuid) && !r.skip (adsGuidLength)) return 0;
+	if ((flags & adsSymFlagAttributes) && !upload_attributes (r, sym.get_opc())) return 0;
+	return entryLength;
+}
+
+/** TwinCAT 2 does not upload array types that are declared implicitly, 
+	like A : ARRAY [1..10] OF INT. Add a type record for them.
+	@param types Type map
+	@param typn Name of the array type
+	@param bitsize Size of the array in bits
+ ************************************************************************/
+static void upload_implicit_array (type_map& types, const std::stringcase& typn, 
+								   int bitsize)
+{
+	if ((typn.compare (0, 5, "ARRAY") != 0) || types.find (0, typn)) {
+		return;
+	}
+	static const std::regex e (R"++(ARRAY\s*\[(.*)\]\s*OF\s+(.+))++", 
+		std::regex_constants::icase);
+	static const std::regex d (R"++(\s*(-?[0-9]+)\s*\.\.\s*(-?[0-9]+)\s*)++");
+	std::cmatch m;
+	if (!std::regex_match (typn.c_str(), m, e)) {
+		return;
+	}
+	type_record rec;
+	rec.set_name (typn);
+	std::stringcase base (m[2].str().c_str());
+	trim_space (base);
+	rec.set_type_name (base);
+	rec.set_bit_size (bitsize);
+	rec.set_type_description (type_enum::arraytype);
+	const std::string dims = m[1].str();
+	for (std::sregex_iterator i (dims.begin(), dims.end(), d); i != std::sregex_iterator(); ++i) {
+		const int lbound = strtol ((*i)[1].str().c_str(), NULL, 10);
+		const int ubound = strtol ((*i)[2].str().c_str(), NULL, 10);
+		rec.get_array_dimensions().push_back (dimension (lbound, ubound - lbound + 1));
+	}
+	if (rec.get_array_dimensions().empty()) {
+		return;
+	}
+	types.insert (type_map::value_type (0, rec));
+}
+
+/* tpy_file::parse
+ ************************************************************************/
+bool tpy_file::parse (const symbol_upload& upload)
+{
+	if (upload.empty() || !upload.get_target().isValid()) {
+		return false;
+	}
+	// data types
+	std::list<std::pair<std::stringcase, int>> items;
+	const char* p = upload.get_datatypes().data();
+	const char* end = p + upload.get_datatypes().size();
+	while (p < end) {
+		type_record rec;
+		int bitoffs = 0;
+		const unsigned int len = upload_datatype (p, end, rec, bitoffs);
+		if (len == 0) {
+			fprintf (stderr, "Invalid data type entry at offset %i\n", 
+				(int)(p - upload.get_datatypes().data()));
+			return false;
+		}
+		for (const auto& item : rec.get_struct_list()) {
+			items.push_back (std::make_pair (item.get_type_name(), item.get_bit_size()));
+		}
+		type_list.insert (type_map::value_type (0, rec));
+		p += len;
+	}
+	// symbols
+	p = upload.get_symbols().data();
+	end = p + upload.get_symbols().size();
+	while (p < end) {
+		symbol_record sym;
+		bool bitvalue = false;
+		const unsigned int len = upload_symbol (p, end, sym, bitvalue);
+		if (len == 0) {
+			fprintf (stderr, "Invalid symbol entry at offset %i\n", 
+				(int)(p - upload.get_symbols().data()));
+			return false;
+		}
+		p += len;
+		// records address whole bytes, bit symbols can not be read
+		if (bitvalue) {
+			fprintf (stderr, "Skipping bit symbol %s\n", sym.get_name().c_str());
+			continue;
+		}
+		sym_list.push_back (sym);
+	}
+	// implicit array types
+	for (const auto& sym : sym_list) {
+		upload_implicit_array (type_list, sym.get_type_name(), 8 * sym.get_bytesize());
+	}
+	for (const auto& i : items) {
+		upload_implicit_array (type_list, i.first, i.second);
+	}
+
+	// project information
+	project_info.set_netid (upload.get_target().get_netid());
+	project_info.set_port (upload.get_target().get_port());
+	project_info.set_tcat_versionstr ((upload.get_target().get_port() >= 850) ? "3.1.0" : "2.11.0");
+
+	parse_finish();
+	return true;
+}
+
+/* symbol_upload::read
+ ************************************************************************/
+bool symbol_upload::read (FILE* inp)
+{
+	if (!inp) {
+		return false;
+	}
+	char magic[8] = {};
+	unsigned int version = 0;
+	unsigned int len = 0;
+	if ((fread (magic, 1, sizeof (magic), inp) != sizeof (magic)) ||
+		(memcmp (magic, adsUploadMagic, sizeof (magic)) != 0) ||
+		(fread (&version, sizeof (version), 1, inp) != 1) ||
+		(version != adsUploadVersion) ||
+		(fread (&len, sizeof (len), 1, inp) != 1) || (len > 1024)) {
+		return false;
+	}
+	std::string addr (len, 0);
+	if ((fread (addr.data(), 1, len, inp) != len) || !target.set (addr.c_str())) {
+		return false;
+	}
+	for (buffer_type* buf : { &symbols, &datatypes }) {
+		if (fread (&len, sizeof (len), 1, inp) != 1) {
+			return false;
+		}
+		buf->resize (len);
+		if (fread (buf->data(), 1, len, inp) != len) {
+			buf->clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+/* symbol_upload::write
+ ************************************************************************/
+bool symbol_upload::write (FILE* outp) const
+{
+	if (!outp) {
+		return false;
+	}
+	const std::stringcase addr = target.get();
+	unsigned int len = (unsigned int)addr.length();
+	if ((fwrite (adsUploadMagic, 1, 8, outp) != 8) ||
+		(fwrite (&adsUploadVersion, sizeof (adsUploadVersion), 1, outp) != 1) ||
+		(fwrite (&len, sizeof (len), 1, outp) != 1) ||
+		(fwrite (addr.c_str(), 1, len, outp) != len)) {
+		return false;
+	}
+	for (const buffer_type* buf : { &symbols, &datatypes }) {
+		len = (unsigned int)buf->size();
+		if ((fwrite (&len, sizeof (len), 1, outp) != 1) ||
+			(fwrite (buf->data(), 1, len, outp) != len)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Returns the attributes which describe the OPC settings
+	@param opc OPC list
+	@return List of name and value pairs
+ ************************************************************************/
+static std::vector<std::pair<std::stringcase, std::stringcase>> 
+encode_opc (const opc_list& opc)
+{
+	std::vector<std::pair<std::stringcase, std::stringcase>> attr;
+	if (opc.get_opc_state() != opc_enum::no_change) {
+		attr.push_back (std::make_pair (std::stringcase (opcExport), 
+			std::stringcase ((opc.get_opc_state() == opc_enum::publish) ? "1" : "0")));
+	}
+	for (const auto& prop : opc.get_properties()) {
+		std::stringcase name (opcProp);
+		name += opcBracket;
+		name += std::to_string (prop.first).c_str();
+		name += "]";
+		attr.push_back (std::make_pair (name, prop.second));
+	}
+	return attr;
+}
+
+/** Writes the attribute list of a symbol or data type entry
+	@param w Writer positioned at the attribute count
+	@param attr List of name and value pairs
+ ************************************************************************/
+static void encode_attributes (upload_writer& w,
+	const std::vector<std::pair<std::stringcase, std::stringcase>>& attr)
+{
+	w.put ((unsigned short)attr.size());
+	for (const auto& a : attr) {
+		const std::stringcase name (a.first.substr (0, 255));
+		const std::stringcase value (a.second.substr (0, 255));
+		w.put ((unsigned char)name.length());
+		w.put ((unsigned char)value.length());
+		w.put (name);
+		w.put (value);
+	}
+}
+
+/** Writes a data type entry of an ADS data type upload. A sub item is
+	written as a data type entry without dimensions and sub items.
+	@param buf Buffer
+	@param name Name of data type or sub item
+	@param typn Type name
+	@param opc OPC list
+	@param bitsize Size in bits
+	@param bitoffs Bit offset of sub item within its parent
+	@param rec Type record, nullptr for a sub item
+ ************************************************************************/
+static void encode_datatype (symbol_upload::buffer_type& buf, 
+							 const std::stringcase& name, const std::stringcase& typn,
+							 const opc_list& opc, int bitsize, int bitoffs,
+							 const type_record* rec)
+{
+	const auto attr = encode_opc (opc);
+	const bool bits = (bitsize % 8 != 0) || (bitoffs % 8 != 0);
+	unsigned int size = bits ? bitsize : bitsize / 8;
+	unsigned int flags = bits ? adsDtFlagBitValues : 0;
+	if (!attr.empty()) flags |= adsDtFlagAttributes;
+	const bool isenum = rec && !rec->get_enum_list().empty();
+	if (isenum) {
+		flags |= adsDtFlagEnumInfos;
+		if ((size != 1) && (size != 2) && (size != 4) && (size != 8)) size = 2;
+	}
+	const std::stringcase nam (name.substr (0, 0xFFFF));
+	const std::stringcase typ (typn.substr (0, 0xFFFF));
+	const unsigned short arrayDim = rec ? (unsigned short)rec->get_array_dimensions().size() : 0;
+	const unsigned short subItems = rec ? (unsigned short)rec->get_struct_list().size() : 0;
+
+	upload_writer w (buf);
+	w.put ((unsigned int)1);	// version
+	w.put ((unsigned int)0);	// hash value
+	w.put ((unsigned int)0);	// type hash value
+	w.put (size);
+	w.put ((unsigned int)(bits ? bitoffs : bitoffs / 8));
+	w.put ((unsigned int)0);	// ADS data type
+	w.put (flags);
+	w.put ((unsigned short)nam.length());
+	w.put ((unsigned short)typ.length());
+	w.put ((unsigned short)0);	// comment length
+	w.put (arrayDim);
+	w.put (subItems);
+	w.put (nam);
+	w.put (typ);
+	w.put (std::stringcase());
+	if (rec) {
+		for (const auto& dim : rec->get_array_dimensions()) {
+			w.put ((int)dim.first);
+			w.put ((int)dim.second);
+		}
+		for (const auto& item : rec->get_struct_list()) {
+			encode_datatype (buf, item.get_name(), item.get_type_name(), item.get_opc(),
+				item.get_bit_size(), item.get_bit_offset(), nullptr);
+		}
+	}
+	if (!attr.empty()) encode_attributes (w, attr);
+	if (isenum) {
+		w.put ((unsigned short)rec->get_enum_list().size());
+		for (const auto& e : rec->get_enum_list()) {
+			const std::stringcase ename (e.second.substr (0, 255));
+			w.put ((unsigned char)ename.length());
+			w.put (ename);
+			const long long val = e.first;
+			const char* const p = reinterpret_cast<const char*>(&val);
+			buf.insert (buf.end(), p, p + size);
+		}
+	}
+	w.finish();
+}
+
+/** Writes a symbol entry of an ADS symbol upload
+	@param buf Buffer
+	@param sym Symbol record
+ ************************************************************************/
+static void encode_symbol (symbol_upload::buffer_type& buf, const symbol_record& sym)
+{
+	const auto attr = encode_opc (sym.get_opc());
+	const std::stringcase nam (sym.get_name().substr (0, 0xFFFF));
+	const std::stringcase typ (sym.get_type_name().substr (0, 0xFFFF));
+	upload_writer w (buf);
+	w.put ((unsigned int)sym.get_igroup());
+	w.put ((unsigned int)sym.get_ioffset());
+	w.put ((unsigned int)sym.get_bytesize());
+	w.put ((unsigned int)0);	// ADS data type
+	w.put ((unsigned int)(attr.empty() ? 0 : adsSymFlagAttributes));
+	w.put ((unsigned short)nam.length());
+	w.put ((unsigned short)typ.length());
+	w.put ((unsigned short)0);	// comment length
+	w.put (nam);
+	w.put (typ);
+	w.put (std::stringcase());
+	if (!attr.empty()) encode_attributes (w, attr);
+	w.finish();
+}
+
+/* symbol_upload::encode
+ ************************************************************************/
+bool symbol_upload::encode (const tpy_file& tpy)
+{
+	try {
+		target = tpy.get_project_info();
+		symbols.clear();
+		datatypes.clear();
+		for (const auto& sym : tpy.get_symbols()) {
+			encode_symbol (symbols, sym);
+		}
+		for (const auto& typ : tpy.get_types()) {
+			const type_record& rec = typ.second;
+			encode_datatype (datatypes, rec.get_name(), rec.get_type_name(), 
+				rec.get_opc(), rec.get_bit_size(), 0, &rec);
+		}
+	}
+	catch (...) {
+		symbols.clear();
+		datatypes.clear();
+		return false;
+	}
+	return !symbols.empty();
+}
+
 /* tpy_file::parse_finish
  ************************************************************************/
 void tpy_file::parse_finish ()
 {
 	// patch missing type decorators
+	startup_profiler::phase prof ("type patching");
 	const int num = type_list.patch_type_decorators();
 	if (num > 0) {
 		// fprintf(stderr, "Patching %d type decorators\n", num);
 	}
+	// release the slack left from growing the symbol list
+	sym_list.shrink_to_fit();
 	// set plc name in opc
 	std::stringcase tcname = project_info.get();
 	if (!tcname.empty()) {
@@ -949,7 +1751,9 @@ static void XMLCALL endElement (void *userData, const char *name)
 		// parsed a type (trim space)
 		else if (n.compare (xmlType) == 0 && pinfo->type_parse == 2) {
 			pinfo->type_parse = 1;
-			trim_space (pinfo->sym.get_type_name());
+			trim_space (pinfo->type_data);
+			pinfo->sym.set_type_name (pinfo->type_data);
+			pinfo->type_data.clear();
 		}
 		// opc properties
 		else if (n.compare (xmlProperties) == 0 && pinfo->opc_parse == 1) {
@@ -1027,7 +1831,9 @@ static void XMLCALL endElement (void *userData, const char *name)
 		// parsed a type (trim space)
 		else if (n.compare (xmlType) == 0 && pinfo->type_parse == 2) {
 			pinfo->type_parse = 1;
-			trim_space (pinfo->rec.get_type_name());
+			trim_space (pinfo->type_data);
+			pinfo->rec.set_type_name (pinfo->type_data);
+			pinfo->type_data.clear();
 		}
 		// parsed a bit size
 		else if (n.compare (xmlBitSize) == 0 && pinfo->bitsize_parse == 2) {
@@ -1093,7 +1899,9 @@ static void XMLCALL endElement (void *userData, const char *name)
 		}
 		// subitem type
 		else if (n.compare (xmlType) == 0 && pinfo->struct_parse == 4) {
-			trim_space (pinfo->struct_element.get_type_name());
+			trim_space (pinfo->type_data);
+			pinfo->struct_element.set_type_name (pinfo->type_data);
+			pinfo->type_data.clear();
 			pinfo->struct_parse = 2;
 		}
 		// subitem bitsize
@@ -1222,7 +2030,7 @@ static void XMLCALL dataElement (void *userData, const char *data, int len)
 		}
 		// append string to type
 		else if (pinfo->type_parse == 2) {
-			pinfo->sym.get_type_name().append (data, len);
+			pinfo->type_data.append (data, len);
 		}
 		// append opc data
 		else if (pinfo->opc_parse >= 3) {
@@ -1245,7 +2053,7 @@ static void XMLCALL dataElement (void *userData, const char *data, int len)
 		}
 		// append string to type
 		else if (pinfo->type_parse == 2) {
-			pinfo->rec.get_type_name().append (data, len);
+			pinfo->type_data.append (data, len);
 		}
 		// append string to bitdata
 		else if (pinfo->bitsize_parse == 2) {
@@ -1265,7 +2073,7 @@ static void XMLCALL dataElement (void *userData, const char *data, int len)
 		}
 		// append struct element type
 		else if (pinfo->struct_parse == 4) {
-			pinfo->struct_element.get_type_name().append (data, len);
+			pinfo->type_data.append (data, len);
 		}
 		// append struct element bitsize
 		else if (pinfo->struct_parse == 5) {
@@ -165,14 +165,16 @@ public:
 	/// @param td Type decortation or id
 	base_record (const std::stringcase& n, const ParseUtil::opc_list& o,
 		const std::stringcase& tn, unsigned int td = 0) 
-		: name (n), type_n (tn), type_decoration (td), opc(o) {}
+		: name (n), type_n (&ParseUtil::string_pool::get().intern (tn)), 
+		type_decoration (td), opc(o) {}
 	/// Constructor
 	/// @param n Name
 	/// @param tn Type name
 	/// @param td Type decortation or id
 	base_record (const std::stringcase& n, 
 		const std::stringcase& tn, unsigned int td = 0)
-		: name (n), type_n (tn), type_decoration (td) {}
+		: name (n), type_n (&ParseUtil::string_pool::get().intern (tn)), 
+		type_decoration (td) {}
 
 	/// Get name
 	const std::stringcase& get_name() const noexcept { return name; }
@@ -181,11 +183,10 @@ public:
 	/// Set name
 	void set_name (std::stringcase n) { name = n; }
 	/// Get type name 
-	const std::stringcase& get_type_name() const noexcept { return type_n; }
-	/// Get type name 
-	std::stringcase& get_type_name() noexcept { return type_n; }
+	const std::stringcase& get_type_name() const noexcept { return *type_n; }
 	/// Set type name
-	void set_type_name (std::stringcase t) noexcept { type_n = t; }
+	void set_type_name (const std::stringcase& t) {
+		type_n = &ParseUtil::string_pool::get().intern (t); }
 	/// Get type decoration
 	unsigned int get_type_decoration () const noexcept { return type_decoration; }
 	/// Set type decoration 
@@ -203,8 +204,8 @@ public:
 protected:
 	/// name of type
 	std::stringcase		name;
-	/// type definition
-	std::stringcase		type_n;
+	/// type definition (pooled, type names are shared by many records)
+	const std::stringcase*	type_n = &ParseUtil::string_pool::empty_string();
 	/// decoration or type ID of type definition
 	unsigned int		type_decoration = 0;
 	/// this is a pointer
@@ -220,7 +221,7 @@ using dimension = std::pair<int, int>;
 
 /** This list stores lbound, elements pairs.
 ************************************************************************/
-using dimensions = std::list<dimension>;
+using dimensions = std::vector<dimension>;
 
 /** This map stores a list of enum values.
 ************************************************************************/
@@ -242,7 +243,7 @@ public:
 
 /** This class stores a list of subitems.
 ************************************************************************/
-using item_list = std::list<item_record>;
+using item_list = std::vector<item_record>;
 
 
 /** This structure describes a type record
@@ -321,15 +322,62 @@ class type_map : protected type_multipmap
 public:
 	/// value type
 	using type_multipmap::value_type;
-	using type_multipmap::insert;
+	/// const iterator
+	using type_multipmap::const_iterator;
+	/// Number of types
+	using type_multipmap::size;
 
 	/// Constructor
 	type_map() = default;
+	/// Copy constructor, rebuilds the name index since it points into the map
+	type_map (const type_map& tmap) : type_multipmap (tmap) {
+		if (tmap.indexed) build_index(); }
+	/// Copy assignment, rebuilds the name index since it points into the map
+	type_map& operator= (const type_map& tmap) {
+		if (this == &tmap) return *this;
+		type_multipmap::operator= (tmap); name_index.clear(); indexed = false;
+		if (tmap.indexed) build_index();
+		return *this; }
+
+	/// First type
+	const_iterator begin() const noexcept { return type_multipmap::begin(); }
+	/// Past the last type
+	const_iterator end() const noexcept { return type_multipmap::end(); }
+
+	/// Insert an element, invalidates the name index
+	iterator insert (const value_type& val) {
+		indexed = false; return type_multipmap::insert (val); }
 	/// find an element
 	const value_type::second_type* 
 	find (value_type::first_type id, const std::stringcase& typn) const;
 	// patch type name decorators that are zero but shouldn't
 	int patch_type_decorators();
+	/// Build the index by type names without namespace. 
+	/// Called by patch_type_decorators.
+	void build_index();
+	/// Print lookup statistics
+	void print_statistics (FILE* fp) const;
+
+protected:
+	/// Returns the last component of a dotted type name
+	static std::stringcase base_name (const std::stringcase& typn);
+
+	/// Types by last name component, in order of the multimap
+	std::unordered_map<std::stringcase, std::vector<const type_record*>> name_index;
+	/// Index is up to date
+	bool			indexed = false;
+#ifdef DEBUG
+	/// Number of lookups
+	mutable std::atomic<long long>	lookups = 0;
+	/// Number of lookups resolved by the type decoration
+	mutable std::atomic<long long>	id_hits = 0;
+	/// Number of lookups resolved through the name index
+	mutable std::atomic<long long>	index_hits = 0;
+	/// Number of lookups which required a linear search
+	mutable std::atomic<long long>	linear_searches = 0;
+	/// Number of failed lookups
+	mutable std::atomic<long long>	misses = 0;
+#endif
 };
 
 
@@ -350,7 +398,57 @@ public:
 
 /** This is a list of symbol records
 ************************************************************************/
-using symbol_list = std::list<symbol_record>;
+using symbol_list = std::vector<symbol_record>;
+
+/** Forward declaration
+ ************************************************************************/
+class tpy_file;
+
+/** This class holds the symbol and data type tables in the compact
+	binary form as uploaded from a TwinCAT PLC through ADS. It can be
+	written to and restored from a local cache file.
+	@brief ADS symbol upload
+************************************************************************/
+class symbol_upload
+{
+public:
+	/// Buffer type
+	using buffer_type = std::vector<char>;
+
+	/// Default constructor
+	symbol_upload() = default;
+
+	/// Get ADS target
+	const ads_routing_info& get_target() const noexcept { return target; }
+	/// Get ADS target
+	ads_routing_info& get_target() noexcept { return target; }
+	/// Get symbol table (ADSIGRP_SYM_UPLOAD)
+	const buffer_type& get_symbols() const noexcept { return symbols; }
+	/// Get symbol table (ADSIGRP_SYM_UPLOAD)
+	buffer_type& get_symbols() noexcept { return symbols; }
+	/// Get data type table (ADSIGRP_SYM_DT_UPLOAD)
+	const buffer_type& get_datatypes() const noexcept { return datatypes; }
+	/// Get data type table (ADSIGRP_SYM_DT_UPLOAD)
+	buffer_type& get_datatypes() noexcept { return datatypes; }
+	/// Nothing uploaded
+	bool empty() const noexcept { return symbols.empty(); }
+
+	/// Read the upload from a cache file
+	bool read (FILE* inp);
+	/// Write the upload to a cache file
+	bool write (FILE* outp) const;
+	/// Encode the symbol and data type tables of a parsed tpy file, 
+	/// as they would be uploaded from the PLC
+	bool encode (const tpy_file& tpy);
+
+protected:
+	/// ADS target the tables were uploaded from
+	ads_routing_info	target;
+	/// Symbol table
+	buffer_type			symbols;
+	/// Data type table
+	buffer_type			datatypes;
+};
 
 
 /** This class holds the structure of a tpy file
@@ -368,6 +466,8 @@ public:
 	bool parse (FILE* inp);
 	/// Parse a memory region
 	bool parse (const char* p, int len);
+	/// Parse the symbol and data type tables uploaded through ADS
+	bool parse (const symbol_upload& upload);
 
 	/// Return list of symbols
 	const symbol_list& get_symbols() const noexcept { return sym_list; }
@@ -376,6 +476,14 @@ public:
 	/// Return project information
 	const project_record& get_project_info() const noexcept { return project_info; }
 
+	/// Return the number of bytes read by the last XML parse
+	size_t get_parse_size() const noexcept { return parse_size; }
+	/// Return the time in seconds taken by the last XML parse
+	double get_parse_time() const noexcept { return parse_time; }
+	/// Return the throughput of the last XML parse in MB/s
+	double get_parse_rate() const noexcept {
+		return (parse_time > 0) ? parse_size / 1E6 / parse_time : 0.0; }
+
 	/** Iterates over the symbol list and processes all specified tags.
 	@param process Function class
 	@param prefix Prefix which is added to all variable names
@@ -446,6 +554,10 @@ protected:
 	symbol_list		sym_list;
 	/// List of types
 	type_map		type_list;
+	/// Bytes read by the last XML parse
+	size_t			parse_size = 0;
+	/// Seconds taken by the last XML parse
+	double			parse_time = 0.0;
 
 	/** This function is called at the end of parsing.
 	Here we set the TC server name in the OPC variables for each symbol
@@ -105,4 +105,36 @@ const char* const xmlSubstitution = "TcSubstitution";
 const char* const xmlAlias = "Alias";
 /** @} */
 
-}
\ No newline at end of file
+/** @defgroup parsetpyconstads ADS symbol upload constants
+ ************************************************************************/
+/** @{ */
+
+/// Symbol flag: offset and size are in bits
+constexpr unsigned int adsSymFlagBitValue = 0x0002;
+/// Symbol flag: type GUID follows the comment
+constexpr unsigned int adsSymFlagTypeGuid = 0x0008;
+/// Symbol flag: attributes follow the comment
+constexpr unsigned int adsSymFlagAttributes = 0x1000;
+
+/// Data type flag: offset and size are in bits
+constexpr unsigned int adsDtFlagBitValues = 0x0020;
+/// Data type flag: type GUID follows the sub items
+constexpr unsigned int adsDtFlagTypeGuid = 0x0080;
+/// Data type flag: copy mask follows the type GUID
+constexpr unsigned int adsDtFlagCopyMask = 0x0200;
+/// Data type flag: method infos follow the copy mask
+constexpr unsigned int adsDtFlagMethodInfos = 0x0800;
+/// Data type flag: attributes follow the method infos
+constexpr unsigned int adsDtFlagAttributes = 0x1000;
+/// Data type flag: enum infos follow the attributes
+constexpr unsigned int adsDtFlagEnumInfos = 0x2000;
+
+/// Length of a type GUID
+constexpr int adsGuidLength = 16;
+/// Magic string at the beginning of a symbol upload cache file
+const char* const adsUploadMagic = "TCSYMUPL";
+/// Version of the symbol upload cache file format
+constexpr unsigned int adsUploadVersion = 1;
+/** @} */
+
+}
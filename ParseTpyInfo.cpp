@@ -67,6 +67,10 @@ bool syminfo_processing::operator() (const process_arg& arg) const noexcept
 	case process_type_enum::pt_binary:
 		fprintf (outf, "binary ");
 		break;
+	// Array type
+	case process_type_enum::pt_array:
+		fprintf (outf, "array  ");
+		break;
 	// Invalid type
 	case process_type_enum::pt_invalid:
 	default:
@@ -169,8 +173,9 @@ int main (int argc, const char *argv[])
 		return 1;
 	}
 	clock_t t3 = clock();
-	fprintf (stderr, "Time to parse file %g sec, time to build list %g sec.\n", 
+	fprintf (stderr, "Time to parse file %g sec (%.1f MB/s), time to build list %g sec.\n", 
 		static_cast<double>((int64_t)t2 - (int64_t)t1)/CLOCKS_PER_SEC, 
+		tpyfile.get_parse_rate(),
 		static_cast<double>((int64_t)t3 - (int64_t)t2)/CLOCKS_PER_SEC);
 
 	// close files
@@ -16,6 +16,9 @@ namespace ParseTpy {
 				num += process_type_tree (sym, process, prefix);
 			}
 		}
+#ifdef DEBUG
+		type_list.print_statistics (stderr);
+#endif
 		return num;
 	}
 	
@@ -77,9 +80,37 @@ namespace ParseTpy {
 					typ.get_type_decoration(), defopc, loc, process, varname, level);
 			}
 		case type_enum::arraytype :
-			// process array and iterate over all subindices
-			return process_array (typ, typ.get_array_dimensions(), defopc, loc, 
-				process, varname, level);
+			{
+				int num = 0;
+				// process an array of a simple type as a single waveform
+				const ParseUtil::process_array_enum mode = get_process_arrays (defopc);
+				if (mode != ParseUtil::process_array_enum::elements) {
+					const int elsize = ParseUtil::process_arg::get_simple_size (typ.get_type_name());
+					int elements = (elsize > 0) ? 1 : 0;
+					for (const auto& d : typ.get_array_dimensions()) {
+						elements *= (d.second > 0) ? d.second : 0;
+					}
+					if ((elements > 0) && (typ.get_bit_size() == 8 * elsize * elements) &&
+						(get_process_tags() == ParseUtil::process_tag_enum::atomic ||
+						 get_process_tags() == ParseUtil::process_tag_enum::all)) {
+						ParseUtil::process_arg_tc arg (loc, varname, ParseUtil::process_type_enum::pt_array, 
+							defopc, typ.get_type_name(), true, elements);
+						num = process (arg) ? 1 : 0;
+						if (mode == ParseUtil::process_array_enum::waveform) {
+							// Call process for entire array (not an atomic type)
+							if (get_process_tags() == ParseUtil::process_tag_enum::all) {
+								ParseUtil::process_arg_tc barg (loc, varname, ParseUtil::process_type_enum::pt_binary, 
+									defopc, typ.get_name(), false);
+								num += process (barg) ? 1 : 0;
+							}
+							return num;
+						}
+					}
+				}
+				// process array and iterate over all subindices
+				return num + process_array (typ, typ.get_array_dimensions(), defopc, loc, 
+					process, varname, level);
+			}
 		case type_enum::enumtype :
 			if (get_process_tags() == ParseUtil::process_tag_enum::atomic ||
 				get_process_tags() == ParseUtil::process_tag_enum::all) {
@@ -229,7 +260,7 @@ namespace ParseTpy {
 		// If not process through the indices
 		else {
 			const dimension d = dim.front();
-			dim.pop_front();
+			dim.erase (dim.begin());
 			// invalid number of elements
 			if (d.second < 0) {
 				fprintf (stderr, "Array with negative element number for %s\n", 
@@ -2,6 +2,17 @@
 #include "ParseUtil.h"
 #include "ParseUtilConst.h"
 #include "ParseTpyConst.h"
+#include <algorithm>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #define XML_STATIC ///< Static linking
 #include "Expat/expat.h"
 #if defined(__amigaos__) && defined(__USE_INLINE__)
@@ -88,6 +99,257 @@ namespace ParseUtil {
 
 
 
+/** Compiled replacement rules. The rule table is stored in a hashed,
+	case insensitive lookup. In recursive mode the values are expanded 
+	once when compiling. Names are expanded in a single scan without
+	restarting from the beginning. The expanded template, i.e., the part 
+	of a name up to the last suffix, is remembered per thread, so that 
+	consecutive names sharing the same structure are not scanned again.
+	In recursive mode a name is rescanned from the beginning after each
+	replacement, if the single scan is not conclusive, e.g., when a
+	marker is formed across the boundary of a value, as in $${A} with 
+	A={B}.
+	@brief Compiled replacement rules
+ ************************************************************************/
+class compiled_rules
+{
+public:
+	/// Constructor
+	compiled_rules (const replacement_table& table, bool rec);
+
+	/// Apply the rules
+	stringcase apply (const stringcase& arg) const;
+protected:
+	/// Hashed lookup type
+	using lookup_type = std::unordered_map<stringcase, stringcase>;
+
+	/// Expands all variables in a single scan
+	/// @param ret Expanded string (return)
+	/// @param arg String to expand
+	/// @param lookup Table with variable values
+	/// @param depth Recursion depth (values are expanded when > 0)
+	/// @return False, if a variable name contains a prefix, a prefix 
+	/// has no suffix or an expanded value gets too long
+	static bool expand (stringcase& ret, const stringcase& arg, 
+		const lookup_type& lookup, int depth);
+	/// Expands all variables by rescanning from the beginning after each
+	/// replacement (used for malformed names in recursive mode)
+	/// @param arg String to expand
+	/// @return Expanded string
+	stringcase expand_rescan (const stringcase& arg) const;
+	/// Checks if the result of a single scan has to be rescanned
+	/// @param expanded Result of the single scan
+	/// @param wellformed Return value of the single scan
+	/// @return True in recursive mode, if the name or a value is malformed
+	/// or if the result contains a prefix
+	bool needs_rescan (const stringcase& expanded, bool wellformed) const noexcept;
+
+	/// Maximum recursion depth for values that reference other variables
+	static constexpr int max_depth = 20;
+	/// Maximum length of an expanded value (catches self references)
+	static constexpr stringcase::size_type max_length = 65536;
+
+	/// Unique id of the compiled rules
+	unsigned long long	id = 0;
+	/// Values by variable name (expanded in recursive mode)
+	lookup_type			values;
+	/// Values by variable name as given (recursive mode only)
+	lookup_type			raw;
+	/// Values which could not be expanded in a single scan
+	bool				malformed = false;
+	/// Recursive replacement
+	bool				recursive = true;
+};
+
+/* compiled_rules::compiled_rules
+ ************************************************************************/
+compiled_rules::compiled_rules (const replacement_table& table, bool rec)
+	: recursive (rec)
+{
+	static std::atomic<unsigned long long> next_id (0);
+	id = ++next_id;
+	lookup_type& given = recursive ? raw : values;
+	for (const auto& i : table) {
+		given[i.first] = i.second;
+	}
+	if (!recursive) {
+		return;
+	}
+	for (const auto& i : raw) {
+		stringcase val;
+		// a value which still contains a prefix forms new markers
+		if (!expand (val, i.second, raw, 1) || 
+			(val.find (replacement_rules::prefix) != stringcase::npos)) {
+			malformed = true;
+		}
+		values[i.first] = val;
+	}
+}
+
+/* compiled_rules::expand
+ ************************************************************************/
+bool compiled_rules::expand (stringcase& ret, const stringcase& arg, 
+	const lookup_type& lookup, int depth)
+{
+	const stringcase::size_type prefixlen = strlen (replacement_rules::prefix);
+	const stringcase::size_type suffixlen = strlen (replacement_rules::suffix);
+	bool wellformed = true;
+	stringcase var;
+	ret.reserve (ret.size() + arg.size());
+	// markers are not case sensitive: search with standard traits
+	const std::string_view sv (arg.data(), arg.size());
+	stringcase::size_type pos = 0;
+	stringcase::size_type pos1 = 0;
+	while ((pos1 = sv.find (replacement_rules::prefix, pos)) != stringcase::npos) {
+		if ((depth > 0) && (ret.size() > max_length)) {
+			return false;
+		}
+		ret.append (arg, pos, pos1 - pos);
+		// look for suffix
+		const stringcase::size_type pos2 = sv.find (replacement_rules::suffix, pos1 + prefixlen);
+		// no suffix? What's up? remove prefix and move on
+		if (pos2 == stringcase::npos) {
+			wellformed = false;
+			pos = pos1 + prefixlen;
+			continue;
+		}
+		// determine variable name
+		var.assign (arg, pos1 + prefixlen, pos2 - (pos1 + prefixlen));
+		if (sv.substr (pos1 + prefixlen, pos2 - (pos1 + prefixlen)).find (replacement_rules::prefix) != 
+			std::string_view::npos) {
+			wellformed = false;
+		}
+		trim_space (var);
+		// check for value in table
+		const auto rep = var.empty() ? lookup.end() : lookup.find (var);
+		if (rep == lookup.end()) {
+			ret += var;
+		}
+		else if ((depth > 0) && (depth < max_depth)) {
+			if (!expand (ret, rep->second, lookup, depth + 1)) wellformed = false;
+		}
+		else {
+			ret += rep->second;
+		}
+		pos = pos2 + suffixlen;
+	}
+	ret.append (arg, pos, stringcase::npos);
+	return wellformed;
+}
+
+/* compiled_rules::expand_rescan
+ ************************************************************************/
+stringcase compiled_rules::expand_rescan (const stringcase& arg) const
+{
+	const stringcase::size_type prefixlen = strlen (replacement_rules::prefix);
+	const stringcase::size_type suffixlen = strlen (replacement_rules::suffix);
+	stringcase ret (arg);
+	stringcase var;
+	stringcase::size_type pos1 = 0;
+	stringcase::size_type pos2 = 0;
+	// limit the number of replacements to catch self references
+	for (int count = 0; (count < 1000) && 
+		 ((pos1 = ret.find (replacement_rules::prefix, pos2)) != stringcase::npos); ++count) {
+		// look for suffix
+		pos2 = ret.find (replacement_rules::suffix, pos1 + prefixlen);
+		// no suffix? What's up? remove prefix and start from beginning
+		if (pos2 == stringcase::npos) {
+			ret.erase (pos1, prefixlen);
+			pos2 = 0;
+			continue;
+		}
+		// determine variable name
+		var = ret.substr (pos1 + prefixlen, pos2 - (pos1 + prefixlen));
+		trim_space (var);
+		// check for value in table
+		const auto rep = var.empty() ? raw.end() : raw.find (var);
+		if (rep != raw.end()) {
+			var = rep->second;
+		}
+		// replace var with value and start from beginning
+		ret.replace (pos1, pos2 - pos1 + suffixlen, var);
+		pos2 = 0;
+	}
+	return ret;
+}
+
+/* compiled_rules::needs_rescan
+ ************************************************************************/
+bool compiled_rules::needs_rescan (const stringcase& expanded, bool wellformed) const noexcept
+{
+	if (!recursive) {
+		return false;
+	}
+	const std::string_view sv (expanded.data(), expanded.size());
+	return !wellformed || malformed || 
+		(sv.find (replacement_rules::prefix) != std::string_view::npos);
+}
+
+/* compiled_rules::apply
+ ************************************************************************/
+stringcase compiled_rules::apply (const stringcase& arg) const
+{
+	/// Last expanded template of this thread
+	struct memo_type {
+		/// Id of compiled rules
+		unsigned long long	id = 0;
+		/// Template
+		std::string			head;
+		/// Expanded template
+		stringcase			expanded;
+	};
+	thread_local memo_type memo;
+
+	// nothing to replace (markers are not case sensitive)
+	const std::string_view sv (arg.data(), arg.size());
+	if (sv.find (replacement_rules::prefix) == std::string_view::npos) {
+		return arg;
+	}
+	// split into template and tail, tail must not contain a prefix
+	const std::string_view::size_type last = sv.rfind (replacement_rules::suffix);
+	if ((last == std::string_view::npos) || (last < sv.rfind (replacement_rules::prefix))) {
+		stringcase ret;
+		const bool wellformed = expand (ret, arg, values, 0);
+		return needs_rescan (ret, wellformed) ? expand_rescan (arg) : ret;
+	}
+	const stringcase::size_type split = last + strlen (replacement_rules::suffix);
+	// same template as the previous name (case sensitive)?
+	if ((memo.id != id) || (memo.head.size() != split) ||
+		(memcmp (memo.head.data(), arg.data(), split) != 0)) {
+		stringcase head (arg, 0, split);
+		stringcase expanded;
+		const bool wellformed = expand (expanded, head, values, 0);
+		if (needs_rescan (expanded, wellformed)) {
+			expanded = expand_rescan (head);
+		}
+		memo.id = id;
+		memo.head.assign (arg.data(), split);
+		memo.expanded = std::move (expanded);
+	}
+	stringcase ret;
+	ret.reserve (memo.expanded.size() + arg.size() - split);
+	ret.append (memo.expanded);
+	ret.append (arg, split, stringcase::npos);
+	// a prefix formed across the end of the template is rescanned
+	if (recursive) {
+		const std::string_view rv (ret.data(), ret.size());
+		const std::string_view::size_type len = strlen (replacement_rules::prefix) - 1;
+		if (rv.find (replacement_rules::prefix, 
+			memo.expanded.size() - std::min (memo.expanded.size(), len)) != std::string_view::npos) {
+			return expand_rescan (arg);
+		}
+	}
+	return ret;
+}
+
+
+/* replacement_rules::compile
+ ************************************************************************/
+void replacement_rules::compile()
+{
+	compiled = std::make_shared<const compiled_rules> (table, recursive);
+}
+
 /* replacement_rules::parse_rules
  ************************************************************************/
 bool replacement_rules::parse_rules(const std::stringcase& s, const std::stringcase alias)
@@ -102,10 +364,11 @@ bool replacement_rules::parse_rules(const std::stringcase& s, const std::stringc
 			trim_space(var);
 			std::stringcase val(m[2].str().c_str());
 			trim_space(val);
-			if (!var.empty()) add_rule(var, val);
+			if (!var.empty()) table[var] = val;
 		}
 		p += m.length();
 	}
+	compile();
 	return !*p;
 }
 
@@ -127,41 +390,10 @@ std::stringcase replacement_rules::get_rule_string() const
  ************************************************************************/
 std::stringcase replacement_rules::apply_replacement_rules(const std::stringcase& arg) const
 {
-	stringcase ret(arg);
-	stringcase var;
-	stringcase val;
-	stringcase::size_type pos1 = 0;
-	stringcase::size_type pos2 = 0;
-	const stringcase::size_type prefixlen = strlen(prefix);
-	const stringcase::size_type suffixlen = strlen(suffix);
-	replacement_table::const_iterator rep;
-
-	// start from beginning
-	pos2 = 0;
-	while ((pos1 = ret.find(prefix, pos2)) != stringcase::npos) {
-		// look for suffix
-		pos2 = ret.find(suffix, pos1 + prefixlen);
-		// no suffix? What's up? remove prefix and move on
-		if (pos2 == stringcase::npos) {
-			ret.erase(pos1, prefixlen);
-			// if recursive start from beginning
-			pos2 = is_recursive() ? 0 : pos1;
-			continue;
-		}
-		// determine variable name
-		var = ret.substr(pos1 + prefixlen, pos2 - (pos1 + prefixlen));
-		trim_space(var);
-		// check for value in table
-		if (!var.empty() &&
-			(rep = table.find(var)) != table.end()) {
-			var = rep->second;
-		}
-		// replace var with value
-		ret.replace(pos1, pos2 - pos1 + suffixlen, var);
-		// if recursive start from beginning
-		pos2 = is_recursive() ? 0 : pos1 + var.size();
+	if (compiled) {
+		return compiled->apply (arg);
 	}
-	return ret;
+	return compiled_rules (table, recursive).apply (arg);
 }
 
 
@@ -226,6 +458,396 @@ void optarg::setup (size_t size) noexcept
 
 
 
+/* property_map::insert
+ ************************************************************************/
+std::pair<property_map::iterator, bool> property_map::insert (const value_type& val)
+{
+	const iterator i = lower_bound (val.first);
+	if ((i != end()) && (i->first == val.first)) {
+		return std::make_pair (i, false);
+	}
+	return std::make_pair (elements.insert (i, val), true);
+}
+
+/* property_map::operator[]
+ ************************************************************************/
+property_map::mapped_type& property_map::operator[] (key_type key)
+{
+	iterator i = lower_bound (key);
+	if ((i == end()) || (i->first != key)) {
+		i = elements.insert (i, value_type (key, mapped_type()));
+	}
+	return i->second;
+}
+
+/* property_map::erase
+ ************************************************************************/
+property_map::size_type property_map::erase (key_type key)
+{
+	const iterator i = find (key);
+	if (i == end()) {
+		return 0;
+	}
+	elements.erase (i);
+	return 1;
+}
+
+/* property_map::lower_bound
+ ************************************************************************/
+property_map::iterator property_map::lower_bound (key_type key) noexcept
+{
+	return std::lower_bound (elements.begin(), elements.end(), key, 
+		[](const value_type& el, key_type k) { return el.first < k; });
+}
+
+/* property_map::lower_bound
+ ************************************************************************/
+property_map::const_iterator property_map::lower_bound (key_type key) const noexcept
+{
+	return std::lower_bound (elements.begin(), elements.end(), key, 
+		[](const value_type& el, key_type k) { return el.first < k; });
+}
+
+/* string_pool::get
+ ************************************************************************/
+string_pool& string_pool::get()
+{
+	static string_pool strpool;
+	return strpool;
+}
+
+/* string_pool::empty_string
+ ************************************************************************/
+const std::stringcase& string_pool::empty_string() noexcept
+{
+	static const std::stringcase empty;
+	return empty;
+}
+
+/* string_pool::intern
+ ************************************************************************/
+const std::stringcase& string_pool::intern (const std::stringcase& s)
+{
+	if (s.empty()) {
+		return empty_string();
+	}
+	std::lock_guard<std::mutex> lock (mux);
+	return *pool.insert (s).first;
+}
+
+/* string_pool::size
+ ************************************************************************/
+size_t string_pool::size() const
+{
+	std::lock_guard<std::mutex> lock (mux);
+	return pool.size();
+}
+
+/* mapped_file::open
+ ************************************************************************/
+bool mapped_file::open (FILE* fp) noexcept
+{
+	close();
+	if (!fp) {
+		return false;
+	}
+	const long pos = ftell (fp);
+	if (pos < 0) {
+		return false;
+	}
+#ifdef _WIN32
+	const HANDLE fh = (HANDLE)_get_osfhandle (_fileno (fp));
+	LARGE_INTEGER fsize;
+	if ((fh == INVALID_HANDLE_VALUE) || (GetFileType (fh) != FILE_TYPE_DISK) ||
+		!GetFileSizeEx (fh, &fsize) || (fsize.QuadPart <= pos)) {
+		return false;
+	}
+	const HANDLE mh = CreateFileMapping (fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mh) {
+		return false;
+	}
+	const void* const p = MapViewOfFile (mh, FILE_MAP_READ, 0, 0, 0);
+	if (!p) {
+		CloseHandle (mh);
+		return false;
+	}
+	handle = mh;
+	length = static_cast<size_t>(fsize.QuadPart);
+#else
+	struct stat st;
+	const int fd = fileno (fp);
+	if ((fstat (fd, &st) != 0) || !S_ISREG (st.st_mode) || (st.st_size <= pos)) {
+		return false;
+	}
+	void* const p = mmap (nullptr, static_cast<size_t>(st.st_size), 
+		PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		return false;
+	}
+	madvise (p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+	length = static_cast<size_t>(st.st_size);
+#endif
+	base = static_cast<const char*>(p);
+	offset = static_cast<size_t>(pos);
+	return true;
+}
+
+/* mapped_file::release
+ ************************************************************************/
+void mapped_file::release (size_t pos) noexcept
+{
+	if (!base) {
+		return;
+	}
+#ifdef _WIN32
+	static const size_t page = [] () noexcept {
+		SYSTEM_INFO info;
+		GetSystemInfo (&info);
+		return static_cast<size_t>(info.dwPageSize); } ();
+#else
+	static const size_t page = static_cast<size_t>(sysconf (_SC_PAGESIZE));
+#endif
+	if (page == 0) {
+		return;
+	}
+	const size_t end = ((offset + pos) / page) * page;
+	if (end <= released) {
+		return;
+	}
+#ifdef _WIN32
+	// unlocking pages which are not locked removes them from the working set
+	VirtualUnlock (const_cast<char*>(base) + released, end - released);
+#else
+	madvise (const_cast<char*>(base) + released, end - released, MADV_DONTNEED);
+#endif
+	released = end;
+}
+
+/* mapped_file::close
+ ************************************************************************/
+void mapped_file::close() noexcept
+{
+	if (!base) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile (base);
+	CloseHandle ((HANDLE)handle);
+#else
+	munmap (const_cast<char*>(base), length);
+#endif
+	base = nullptr;
+	handle = nullptr;
+	length = 0;
+	offset = 0;
+	released = 0;
+}
+
+/* startup_profiler::get
+ ************************************************************************/
+startup_profiler& startup_profiler::get()
+{
+	static startup_profiler profiler;
+	return profiler;
+}
+
+/** PLC of the calling thread for the startup profiler
+ ************************************************************************/
+static thread_local std::stringcase profiler_plc;
+
+/* startup_profiler::get_plc
+ ************************************************************************/
+const std::stringcase& startup_profiler::get_plc() noexcept
+{
+	return profiler_plc;
+}
+
+/* startup_profiler::memory_usage
+ ************************************************************************/
+long long startup_profiler::memory_usage() noexcept
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS_EX pmc;
+	if (GetProcessMemoryInfo (GetCurrentProcess(), 
+		(PROCESS_MEMORY_COUNTERS*)&pmc, sizeof (pmc))) {
+		return (long long)pmc.PrivateUsage;
+	}
+	return 0;
+#else
+	long long pages = 0;
+	long long resident = 0;
+	FILE* fp = fopen ("/proc/self/statm", "r");
+	if (!fp) {
+		return 0;
+	}
+	if (fscanf (fp, "%lld %lld", &pages, &resident) != 2) {
+		resident = 0;
+	}
+	fclose (fp);
+	return resident * sysconf (_SC_PAGESIZE);
+#endif
+}
+
+/* startup_profiler::enable
+ ************************************************************************/
+void startup_profiler::enable (const std::stringcase& fname)
+{
+	std::lock_guard<std::mutex> lock (mux);
+	jsonfile = fname;
+	enabled = true;
+}
+
+/* startup_profiler::add
+ ************************************************************************/
+void startup_profiler::add (const std::stringcase& plc, const char* phase, 
+	double seconds, long long memory)
+{
+	std::lock_guard<std::mutex> lock (mux);
+	auto e = std::find_if (entries.begin(), entries.end(), 
+		[&plc, phase](const entry& el) { 
+			return (el.plc == plc) && (el.phase == phase); });
+	if (e == entries.end()) {
+		entries.push_back (entry());
+		e = entries.end() - 1;
+		e->plc = plc;
+		e->phase = phase;
+	}
+	e->seconds += seconds;
+	e->memory += memory;
+	++e->count;
+}
+
+/* startup_profiler::print
+ ************************************************************************/
+void startup_profiler::print (FILE* fp) const
+{
+	std::lock_guard<std::mutex> lock (mux);
+	fprintf (fp, "%-40s %-20s %10s %10s %8s\n", 
+		"PLC", "Phase", "Time (s)", "Mem (MB)", "Count");
+	for (const auto& e : entries) {
+		// show the end of long file names
+		const char* p = e.plc.c_str();
+		if (e.plc.size() > 40) p += e.plc.size() - 40;
+		fprintf (fp, "%-40s %-20s %10.3f %10.1f %8i\n", p, e.phase.c_str(), 
+			e.seconds, e.memory / 1E6, e.count);
+	}
+}
+
+/** Escapes a string for JSON
+	@param s String
+	@return Escaped string
+ ************************************************************************/
+static std::string json_escape (const char* s)
+{
+	std::string ret;
+	for (; *s; ++s) {
+		if ((*s == '"') || (*s == '\\')) {
+			ret += '\\';
+			ret += *s;
+		}
+		else if ((unsigned char)*s < 0x20) {
+			char buf[8];
+			snprintf (buf, sizeof (buf), "\\u%04x", (unsigned char)*s);
+			ret += buf;
+		}
+		else {
+			ret += *s;
+		}
+	}
+	return ret;
+}
+
+/* startup_profiler::write_json
+ ************************************************************************/
+bool startup_profiler::write_json (const std::stringcase& fname) const
+{
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, fname.c_str(), "w") || !fp) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock (mux);
+	fprintf (fp, "{\n  \"phases\": [");
+	bool first = true;
+	for (const auto& e : entries) {
+		fprintf (fp, "%s\n    {\"plc\": \"%s\", \"phase\": \"%s\", "
+			"\"seconds\": %.6f, \"memory\": %lld, \"count\": %i}",
+			first ? "" : ",", json_escape (e.plc.c_str()).c_str(), 
+			json_escape (e.phase.c_str()).c_str(), e.seconds, e.memory, e.count);
+		first = false;
+	}
+	fprintf (fp, "\n  ]\n}\n");
+	return fclose (fp) == 0;
+}
+
+/* startup_profiler::report
+ ************************************************************************/
+void startup_profiler::report()
+{
+	if (!enabled) {
+		return;
+	}
+	print (stdout);
+	std::stringcase fname;
+	{
+		std::lock_guard<std::mutex> lock (mux);
+		fname = jsonfile;
+	}
+	if (!fname.empty()) {
+		if (write_json (fname)) {
+			printf ("Wrote startup profile %s.\n", fname.c_str());
+		}
+		else {
+			printf ("Failed to write startup profile %s.\n", fname.c_str());
+		}
+	}
+}
+
+/* startup_profiler::plc_scope::plc_scope
+ ************************************************************************/
+startup_profiler::plc_scope::plc_scope (const std::stringcase& plc)
+	: previous (profiler_plc)
+{
+	profiler_plc = plc;
+}
+
+/* startup_profiler::plc_scope::~plc_scope
+ ************************************************************************/
+startup_profiler::plc_scope::~plc_scope()
+{
+	profiler_plc = previous;
+}
+
+/* startup_profiler::phase::phase
+ ************************************************************************/
+startup_profiler::phase::phase (const char* n, bool mem) noexcept
+{
+	if (!startup_profiler::get().is_enabled()) {
+		return;
+	}
+	name = n;
+	if (mem) {
+		memory = memory_usage();
+	}
+	start = std::chrono::steady_clock::now();
+}
+
+/* startup_profiler::phase::~phase
+ ************************************************************************/
+startup_profiler::phase::~phase()
+{
+	if (!name) {
+		return;
+	}
+	try {
+		const double sec = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+		const long long mem = (memory >= 0) ? memory_usage() - memory : 0;
+		startup_profiler::get().add (profiler_plc, name, sec, mem);
+	}
+	catch (...) {
+	}
+}
+
 /* OPC list members: add
  ************************************************************************/
  void opc_list::add (const opc_list& o) 
@@ -233,6 +855,10 @@ void optarg::setup (size_t size) noexcept
 	 if (o.opc != opc_enum::no_change) {
 		 opc = o.opc;
 	 }
+	 if (opc_prop.empty()) {
+		 opc_prop = o.opc_prop;
+		 return;
+	 }
 	 for (const auto& i : o.opc_prop) {
 		 opc_prop[i.first] = i.second;
 	 }
@@ -413,13 +1039,34 @@ std::stringcase process_arg::get_process_string () const
 		return "enum";
 	case process_type_enum::pt_binary:
 		return "binary";
+	case process_type_enum::pt_array:
+		return "array";
 	case process_type_enum::pt_invalid:
 	default:
 		return "invalid";
 	}
 }
 
-/* process_arg_tc::get
+/* process_arg::get_simple_size
+ ************************************************************************/
+int process_arg::get_simple_size (const std::stringcase& typn) noexcept
+{
+	if (typn == "BOOL" || typn == "SINT" || typn == "USINT" || typn == "BYTE")
+		return 1;
+	else if (typn == "INT" || typn == "UINT" || typn == "WORD")
+		return 2;
+	else if (typn == "DINT" || typn == "UDINT" || typn == "DWORD" || typn == "REAL" ||
+		     typn == "TIME" || typn == "TOD"   || typn == "DATE"  || 
+		     typn == "DT" || typn == "TIME_OF_DAY" || typn == "DATE_AND_TIME")
+		return 4;
+	else if (typn == "LINT" || typn == "ULINT" || typn == "LWORD" || typn == "LREAL" ||
+		     typn == "LTIME")
+		return 8;
+	else
+		return 0;
+}
+
+/* process_arg::deduce_size
  ************************************************************************/
 void process_arg::deduce_size()
 {
@@ -428,20 +1075,9 @@ void process_arg::deduce_size()
 		while ((s.length() > 0) && !isdigit(s[0])) s.erase(0, 1);
 		size = strtol(s.c_str(), nullptr, 10);;
 	}
-	else if (ptype == process_type_enum::pt_int) {
-		if (get_type_name() == "SINT" || get_type_name() == "USINT" || get_type_name() == "BYTE")
-			size = 1;
-		else if (get_type_name() == "INT" || get_type_name() == "UINT" || get_type_name() == "WORD")
-			size = 2;
-		else if (get_type_name() == "DINT" || get_type_name() == "UDINT" || get_type_name() == "DWORD" || 
-			     get_type_name() == "TIME" || get_type_name() == "TOD"   || get_type_name() == "DATE"  || 
-			     get_type_name() == "DT" || get_type_name() == "TIME_OF_DAY" || get_type_name() == "DATE_AND_TIME")
-			size = 4;
-		else if (get_type_name() == "LINT" || get_type_name() == "ULINT" || get_type_name() == "LWORD" || 
-			     get_type_name() == "LTIME")
-			size = 8;
-		else
-			size = 0;
+	else if ((ptype == process_type_enum::pt_int) || 
+			 (ptype == process_type_enum::pt_array)) {
+		size = get_simple_size (get_type_name());
 	}
 	else {
 		size = 0;
@@ -464,6 +1100,24 @@ std::stringcase process_arg_tc::get_full () const
 }
 
 
+/* tag_processing::get_process_arrays
+ ************************************************************************/
+process_array_enum tag_processing::get_process_arrays (const opc_list& opc) const
+{
+	int mode = 0;
+	if (!opc.get_property (OPC_PROP_ARRAY, mode)) {
+		return process_arrays;
+	}
+	switch (mode) {
+	case 1:
+		return process_array_enum::waveform;
+	case 2:
+		return process_array_enum::both;
+	default:
+		return process_array_enum::elements;
+	}
+}
+
 /* tag_processing::getopt
  ************************************************************************/
 int tag_processing::getopt (int argc, const char* const argv[], bool argp[]) noexcept
@@ -512,6 +1166,21 @@ int tag_processing::getopt (int argc, const char* const argv[], bool argp[]) noe
 			set_process_tags (process_tag_enum::structured);
 			++num;
 		}
+		// Process array elements (default)
+		else if (arg == "-ae" || arg == "/ae") {
+			set_process_arrays (process_array_enum::elements);
+			++num;
+		}
+		// Process arrays as waveforms
+		else if (arg == "-aw" || arg == "/aw") {
+			set_process_arrays (process_array_enum::waveform);
+			++num;
+		}
+		// Process arrays as waveforms and elements
+		else if (arg == "-ab" || arg == "/ab") {
+			set_process_arrays (process_array_enum::both);
+			++num;
+		}
 		// no set flag to indicated a processed option
 		if (argp && (num > oldnum)) {
 			argp[i] = true;
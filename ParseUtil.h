@@ -1,5 +1,6 @@
 #pragma once
 #include "stdafx.h"
+#include <chrono>
 
 /** @file ParseUtil.h
 	Header which includes utility classes for parsing. 
@@ -20,6 +21,8 @@ namespace ParseUtil {
  ************************************************************************/
 using replacement_table = std::map <std::stringcase, std::stringcase>;
 
+class compiled_rules;
+
 /** Epics channel conversion arguments
     Epics channels are generated from opc through a conversion rule
 	@brief Replacement rules
@@ -30,23 +33,20 @@ public:
 	explicit replacement_rules (bool rec = true) noexcept : recursive (rec) {}
 	/// Constructor
 	explicit replacement_rules (const replacement_table& t, bool rec = true)
-		: table (t), recursive(rec) {}
+		: table (t), recursive(rec) { compile(); }
 	/// Constructor
 	/// @param s Rule string of the form VAR1=VAL1,VAR2=VAL2,...
 	/// @param alias Alias name
 	explicit replacement_rules(const std::stringcase& s, const std::stringcase alias = "")	{
 		parse_rules(s, alias);	}
 	/// Clear
-	void clear() { table.clear(); }
+	void clear() { table.clear(); compiled.reset(); }
 	/// Add a rule
 	void add_rule (const std::stringcase& var, const std::stringcase& val) {
-		table[var] = val; }
+		table[var] = val; compile(); }
 	/// set table
 	void set_rule_table (const replacement_table& t) {
-		table = t; }
-	/// get table
-	replacement_table& get_rule_table() noexcept {
-		return table; }
+		table = t; compile(); }
 	/// get table
 	const replacement_table& get_rule_table() const noexcept {
 		return table; }
@@ -58,8 +58,8 @@ public:
 	/// Is recursive?
 	bool is_recursive() const noexcept { return recursive; }
 	/// Set recursive
-	void set_recursive (bool rec) noexcept {
-		recursive = rec; }
+	void set_recursive (bool rec) {
+		recursive = rec; compile(); }
 
 	/// Parse a rule string
 	/// @param s Rule string of the form VAR1=VAL1,VAR2=VAL2,...
@@ -74,10 +74,16 @@ public:
 	/// suffix for replacement rule: }
 	inline static const char* const suffix = "}";
 protected:
+	/// Compiles the replacement table into a hashed lookup
+	void compile();
+
 	/// Replacement table
 	replacement_table		table;
 	/// Recusrsive replacement
 	bool					recursive = true;
+	/// Compiled rules: hashed lookup with expanded values and a cache
+	/// of expanded templates (shared between copies, replaced on change)
+	std::shared_ptr<const compiled_rules> compiled;
 };
 
 
@@ -151,14 +157,290 @@ enum class opc_enum
 	silent
 };
 
-/** This map stores a list of opc properties.
- ************************************************************************/
-using property_map = std::map<int, std::stringcase>;
-
 /** This pair stores one element of opc properties.
  ************************************************************************/
 using property_el = std::pair<int, std::stringcase>;
 
+/** This map stores a list of opc properties. The elements are kept 
+	sorted by property number in a single vector. It implements the 
+	subset of the std::map interface needed for opc lists.
+	@brief Property map
+ ************************************************************************/
+class property_map
+{
+public:
+	/// Key type
+	using key_type = int;
+	/// Mapped type
+	using mapped_type = std::stringcase;
+	/// Value type
+	using value_type = property_el;
+	/// Container type
+	using container_type = std::vector<value_type>;
+	/// Iterator
+	using iterator = container_type::iterator;
+	/// Constant iterator
+	using const_iterator = container_type::const_iterator;
+	/// Size type
+	using size_type = container_type::size_type;
+
+	/// Default constructor
+	property_map() noexcept = default;
+	/// Constructor
+	property_map (std::initializer_list<value_type> il) {
+		elements.reserve (il.size()); for (const auto& el : il) insert (el); }
+
+	/// Begin
+	iterator begin() noexcept { return elements.begin(); }
+	/// Begin
+	const_iterator begin() const noexcept { return elements.begin(); }
+	/// End
+	iterator end() noexcept { return elements.end(); }
+	/// End
+	const_iterator end() const noexcept { return elements.end(); }
+	/// Is empty?
+	bool empty() const noexcept { return elements.empty(); }
+	/// Number of elements
+	size_type size() const noexcept { return elements.size(); }
+	/// Remove all elements
+	void clear() noexcept { elements.clear(); }
+	/// Reserve space
+	void reserve (size_type n) { elements.reserve (n); }
+
+	/// Find an element
+	iterator find (key_type key) noexcept {
+		const iterator i = lower_bound (key);
+		return ((i != end()) && (i->first == key)) ? i : end(); }
+	/// Find an element
+	const_iterator find (key_type key) const noexcept {
+		const const_iterator i = lower_bound (key);
+		return ((i != end()) && (i->first == key)) ? i : end(); }
+	/// Count elements with key
+	size_type count (key_type key) const noexcept {
+		return (find (key) != end()) ? 1 : 0; }
+	/// Insert an element, an existing element is not replaced
+	std::pair<iterator, bool> insert (const value_type& val);
+	/// Access an element, inserts an empty one if not found
+	mapped_type& operator[] (key_type key);
+	/// Erase an element
+	size_type erase (key_type key);
+
+protected:
+	/// First element not less than key
+	iterator lower_bound (key_type key) noexcept;
+	/// First element not less than key
+	const_iterator lower_bound (key_type key) const noexcept;
+
+	/// Elements sorted by key
+	container_type	elements;
+};
+
+/** This is a pool of interned strings. Each distinct string is stored 
+	only once and stays valid for the lifetime of the program. Strings
+	are compared case sensitive, so that the original spelling is kept.
+	@brief String pool
+ ************************************************************************/
+class string_pool
+{
+public:
+	/// Get the pool (a function-local static, which owns its mutex,
+	/// so nothing is allocated on the heap or leaked at exit)
+	static string_pool& get();
+	/// Get the empty string
+	static const std::stringcase& empty_string() noexcept;
+
+	/// Intern a string
+	/// @param s String
+	/// @return Reference to the pooled string
+	const std::stringcase& intern (const std::stringcase& s);
+	/// Number of pooled strings
+	size_t size() const;
+
+protected:
+	/// Hash which is case sensitive
+	struct exact_hash {
+		size_t operator() (const std::stringcase& s) const noexcept {
+			return std::hash<std::string_view>()(std::string_view (s.data(), s.size())); }
+	};
+	/// Comparison which is case sensitive
+	struct exact_equal {
+		bool operator() (const std::stringcase& s1, const std::stringcase& s2) const noexcept {
+			return (s1.size() == s2.size()) && 
+				(memcmp (s1.data(), s2.data(), s1.size()) == 0); }
+	};
+
+	/// Default constructor
+	string_pool() = default;
+
+	/// Mutex guarding the pool (a plain member of the static pool)
+	mutable std::mutex	mux;
+	/// Pooled strings
+	std::unordered_set<std::stringcase, exact_hash, exact_equal>	pool;
+};
+
+/** This class maps the contents of an open file into memory, so that 
+	a parser can read it in place. Mapping fails for anything which is 
+	not a regular file, such as a pipe or stdin. The caller then has to 
+	fall back to reading the file.
+	@brief Memory mapped file
+ ************************************************************************/
+class mapped_file
+{
+public:
+	/// Default constructor
+	mapped_file() noexcept = default;
+	/// Constructor
+	/// @param fp File to map, starting at its current position
+	explicit mapped_file (FILE* fp) noexcept { open (fp); }
+	/// Destructor
+	~mapped_file() { close(); }
+	/// Disable copy constructor
+	mapped_file (const mapped_file&) = delete;
+	/// Disable copy operator
+	mapped_file& operator= (const mapped_file&) = delete;
+
+	/// Map a file, starting at its current position
+	/// @param fp File to map
+	/// @return True if successful
+	bool open (FILE* fp) noexcept;
+	/// Unmap the file
+	void close() noexcept;
+	/// Drop the pages of the data before the specified position from
+	/// memory (from the working set on Windows), they are read again 
+	/// from the file if accessed later
+	/// @param pos Position relative to data()
+	void release (size_t pos) noexcept;
+	/// Is mapped?
+	bool is_open() const noexcept { return base != nullptr; }
+	/// Pointer to the mapped data (current file position)
+	const char* data() const noexcept { return base ? base + offset : nullptr; }
+	/// Size of the mapped data (from the current file position)
+	size_t size() const noexcept { return length - offset; }
+
+protected:
+	/// Start of mapping
+	const char*	base = nullptr;
+	/// Length of mapping
+	size_t		length = 0;
+	/// Offset of the file position within the mapping
+	size_t		offset = 0;
+	/// Length from the start of the mapping which has been released
+	size_t		released = 0;
+	/// Mapping handle (Windows only)
+	void*		handle = nullptr;
+};
+
+/** This class records the wall time and the memory growth of startup 
+	phases, such as parsing a tpy file or loading a database. Phases 
+	are attributed to the PLC set for the calling thread. Repeated 
+	phases of the same PLC are accumulated. Memory is measured as the 
+	change of the process memory, so concurrent phases share it. The 
+	profiler is off by default and costs a single check when disabled.
+	@brief Startup profiler
+ ************************************************************************/
+class startup_profiler
+{
+public:
+	/// Get the profiler
+	static startup_profiler& get();
+
+	/// Is enabled?
+	bool is_enabled() const noexcept { return enabled; }
+	/// Enable profiling
+	/// @param fname Name of JSON file written by report (or empty)
+	void enable (const std::stringcase& fname = std::stringcase());
+
+	/// Add a measurement
+	/// @param plc PLC name
+	/// @param phase Phase name
+	/// @param seconds Wall time in seconds
+	/// @param memory Change of process memory in bytes
+	void add (const std::stringcase& plc, const char* phase, 
+		double seconds, long long memory);
+	/// Print a summary table
+	void print (FILE* fp) const;
+	/// Write all measurements to a JSON file
+	bool write_json (const std::stringcase& fname) const;
+	/// Print the summary and write the JSON file, if enabled
+	void report();
+
+	/// Get the PLC of the calling thread
+	static const std::stringcase& get_plc() noexcept;
+	/// Get the current process memory in bytes
+	static long long memory_usage() noexcept;
+
+	/** Sets the PLC of the calling thread for the lifetime of the object
+		@brief PLC scope
+	 ********************************************************************/
+	class plc_scope
+	{
+	public:
+		/// Constructor
+		explicit plc_scope (const std::stringcase& plc);
+		/// Destructor
+		~plc_scope();
+		/// Disable copy constructor
+		plc_scope (const plc_scope&) = delete;
+		/// Disable copy operator
+		plc_scope& operator= (const plc_scope&) = delete;
+	protected:
+		/// Previous PLC
+		std::stringcase	previous;
+	};
+
+	/** Measures the lifetime of the object as a phase of the current PLC
+		@brief Phase scope
+	 ********************************************************************/
+	class phase
+	{
+	public:
+		/// Constructor
+		/// @param name Phase name (string literal)
+		/// @param mem Measure memory as well (expensive for short phases)
+		explicit phase (const char* name, bool mem = true) noexcept;
+		/// Destructor
+		~phase();
+		/// Disable copy constructor
+		phase (const phase&) = delete;
+		/// Disable copy operator
+		phase& operator= (const phase&) = delete;
+	protected:
+		/// Phase name (nullptr when disabled)
+		const char*		name = nullptr;
+		/// Start time
+		std::chrono::steady_clock::time_point start;
+		/// Process memory at start (or -1)
+		long long		memory = -1;
+	};
+
+protected:
+	/// Default constructor
+	startup_profiler() = default;
+
+	/// Measurement
+	struct entry {
+		/// PLC name
+		std::stringcase	plc;
+		/// Phase name
+		std::string		phase;
+		/// Accumulated wall time in seconds
+		double			seconds = 0;
+		/// Accumulated memory change in bytes
+		long long		memory = 0;
+		/// Number of measurements
+		int				count = 0;
+	};
+
+	/// Enabled
+	std::atomic<bool>	enabled = false;
+	/// Name of JSON file
+	std::stringcase		jsonfile;
+	/// Mutex guarding the entries
+	mutable std::mutex	mux;
+	/// Entries in the order of their first measurement
+	std::vector<entry>	entries;
+};
+
 /** This class stores OPC properties.
 	@brief OPC list
 ************************************************************************/
@@ -358,7 +640,9 @@ enum class process_type_enum
 	/// Enumerated type
 	pt_enum, 
 	/// Binary type
-	pt_binary
+	pt_binary,
+	/// Array of a simple type (waveform)
+	pt_array
 };
 
 /** Argument which is passed to the name/tag processing function.
@@ -373,10 +657,11 @@ public:
 	/// @param o OPC list
 	/// @param tname Type name
 	/// @param at Atomic type
+	/// @param elems Number of array elements (arrays only)
 	process_arg (const variable_name& vname, process_type_enum pt, 
-		const opc_list& o, const std::stringcase& tname, bool at)
-		: name (vname), type_n (tname), opc (o), ptype (pt), atomic (at) { 
-		deduce_size(); }
+		const opc_list& o, const std::stringcase& tname, bool at, int elems = 0)
+		: name (vname), type_n (tname), opc (o), ptype (pt), atomic (at), 
+		elements (elems) { deduce_size(); }
 	/// Destructor
 	virtual ~process_arg() = default;
 	/// Copy constructor
@@ -407,6 +692,12 @@ public:
 	bool is_atomic() const noexcept { return atomic; }
 	/// Get string length
 	int get_size() const noexcept { return size; }
+	/// Get number of array elements (type name is the element type)
+	int get_elements() const noexcept { return elements; }
+	/// Get the size in bytes of a simple numeric or logic type
+	/// @param typn Type name
+	/// @return Size in bytes, 0 if not a simple numeric or logic type
+	static int get_simple_size (const std::stringcase& typn) noexcept;
 
 	/// Gets a string representation of a PLC & memory location
 	/// @return string with format "prefixigroup/ioffset:size", empty on error
@@ -425,6 +716,8 @@ protected:
 	bool					atomic = false;
 	// Length of string
 	int						size = 0;
+	/// Number of array elements
+	int						elements = 0;
 
 	/// deduce string and int length from type
 	void deduce_size();
@@ -443,10 +736,11 @@ public:
 	/// @param o OPC list
 	/// @param tname Type name
 	/// @param at Atomic type
+	/// @param elems Number of array elements (arrays only)
 	process_arg_tc (const memory_location& loc,
 		const variable_name& vname, process_type_enum pt,
-		const opc_list& o, const std::stringcase& tname, bool at)
-		: process_arg (vname, pt, o, tname, at), memloc(loc) {}
+		const opc_list& o, const std::stringcase& tname, bool at, int elems = 0)
+		: process_arg (vname, pt, o, tname, at, elems), memloc(loc) {}
 
 	/// Get IGroup
 	int get_igroup() const noexcept { return memloc.get_igroup(); }
@@ -479,6 +773,19 @@ enum class process_tag_enum
 	structured
 };
 
+/** Enumerated type to describe how arrays of simple types are processed
+	@brief Array processing enum
+************************************************************************/
+enum class process_array_enum 
+{
+	/// Process each array element separately
+	elements,
+	/// Process the entire array as a single waveform
+	waveform,
+	/// Process both the waveform and the elements
+	both
+};
+
 /** Class to specify which symbols and tags/names to process
 	@brief Tag processing selection
 ************************************************************************/
@@ -520,6 +827,9 @@ public:
 	/// /pa: Call process for all types (default)
 	/// /ps: Call process for simple (atomic) types only
 	/// /pc: Call process for complex (structure and array) types only
+	/// /ae: Process array elements separately (default)
+	/// /aw: Process arrays of simple types as a single waveform
+	/// /ab: Process arrays of simple types as waveform and as elements
 	///
 	/// Command line arguments can use '-' instead of a '/'. Capitalization does
 	/// not matter. getopt will only override arguments that are specifically 
@@ -545,6 +855,14 @@ public:
 	/// Set the string rule
 	void set_no_strings (bool nostring) noexcept {
 		no_string_tags = nostring; }
+	/// Get the array rule
+	process_array_enum get_process_arrays () const noexcept { return process_arrays; }
+	/// Set the array rule
+	void set_process_arrays (process_array_enum procarrays) noexcept {
+		process_arrays = procarrays; }
+	/// Get the array rule for a variable, OPC_PROP_ARRAY overrides the default
+	/// @param opc OPC list of the variable
+	process_array_enum get_process_arrays (const opc_list& opc) const;
 
 protected:
 	/// Process all symbols regarless of opc publish setting
@@ -553,6 +871,8 @@ protected:
 	process_tag_enum	process_tags = process_tag_enum::all;
 	/// Don't process strings
 	bool			no_string_tags = false;
+	/// Process arrays as elements and/or waveforms
+	process_array_enum	process_arrays = process_array_enum::elements;
 };
 
 
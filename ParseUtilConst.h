@@ -64,6 +64,7 @@ const char* const OPC_PROP_OUTPUT = "output"; /**< output */
 constexpr int OPC_PROP_TSE=		  8602;	/**< time stamp */
 constexpr int OPC_PROP_PINI=	  8603;	/**< initialization */
 constexpr int OPC_PROP_DTYP=	  8604;	/**< DTYP field: opc or opcRaw */
+constexpr int OPC_PROP_ARRAY=	  8605;	/**< arrays: 0 elements, 1 waveform, 2 both */
 constexpr int OPC_PROP_SERVER=	  8610;	/**< server name */
 constexpr int OPC_PROP_PLCNAME=   8611; /**< tc name including ads routing info and port */
 constexpr int OPC_PROP_ALIAS=     8620; /**< alias for structure item or symbol name */
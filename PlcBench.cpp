@@ -0,0 +1,359 @@
+#include "stdafx.h"
+#include "plcBase.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+using namespace plc;
+
+
+/** @file PlcBench.cpp
+	Source for a micro benchmark of the data value and record classes
+	which are used on every read and write between the PLC and EPICS.
+ ************************************************************************/
+
+/** Result of a single benchmark
+	@brief Benchmark result
+ ************************************************************************/
+struct bench_result {
+	/// Name of benchmark
+	string		name;
+	/// Time per operation in ns
+	double		ns_per_op = 0.0;
+	/// Number of operations
+	long long	ops = 0;
+	/// Baseline time per operation in ns (0 if none)
+	double		baseline = 0.0;
+};
+
+/// List of benchmark results
+using bench_list = vector<bench_result>;
+
+/// Sink to keep the compiler from optimizing away reads
+static volatile double sink = 0.0;
+
+/** Runs a benchmark function count times and records the time per call
+	@param results List of results (in/out)
+	@param name Name of benchmark
+	@param count Number of iterations
+	@param f Function to call with the iteration index
+	@brief Run a benchmark
+ ************************************************************************/
+template <typename Function>
+static void run_bench (bench_list& results, const string& name, int count, Function f)
+{
+	auto t0 = chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i) {
+		f (i);
+	}
+	auto t1 = chrono::steady_clock::now();
+	bench_result res;
+	res.name = name;
+	res.ops = count;
+	res.ns_per_op = chrono::duration<double, nano>(t1 - t0).count() / count;
+	results.push_back (res);
+}
+
+/** Interface which only counts push and pull calls
+	@brief Counting interface
+ ************************************************************************/
+class bench_interface : public Interface {
+public:
+	/// Constructor
+	explicit bench_interface (BaseRecord& dval) noexcept : Interface (dval) {}
+	/// Count push
+	bool push() noexcept override { ++pushes; return true; }
+	/// Count pull
+	bool pull() noexcept override { ++pulls; return true; }
+	/// Number of push calls
+	long long	pushes = 0;
+	/// Number of pull calls
+	long long	pulls = 0;
+};
+
+/// Names and types of all simple data types
+static const pair<const char*, data_type_enum> simple_types[] = {
+	{"bool", data_type_enum::dtBool},
+	{"int8", data_type_enum::dtInt8},
+	{"uint8", data_type_enum::dtUInt8},
+	{"int16", data_type_enum::dtInt16},
+	{"uint16", data_type_enum::dtUInt16},
+	{"int32", data_type_enum::dtInt32},
+	{"uint32", data_type_enum::dtUInt32},
+	{"int64", data_type_enum::dtInt64},
+	{"uint64", data_type_enum::dtUInt64},
+	{"float", data_type_enum::dtFloat},
+	{"double", data_type_enum::dtDouble}
+};
+
+/** Benchmarks the data value access for all data types
+	@param results List of results (in/out)
+	@param count Number of iterations
+	@brief Data value benchmarks
+ ************************************************************************/
+static void bench_datavalue (bench_list& results, int count)
+{
+	for (const auto& t : simple_types) {
+		DataValue val (t.second);
+		const string n = string ("DataValue.") + t.first;
+		char buf[8] = {0};
+		run_bench (results, n + ".PlcWriteBinary", count, [&](int i) {
+			buf[0] = (char)(i & 1);
+			val.PlcWriteBinary (buf, val.get_size()); });
+		run_bench (results, n + ".UserRead", count, [&](int) {
+			double d = 0; val.UserRead (d); sink = d; });
+		run_bench (results, n + ".UserWrite", count, [&](int i) {
+			val.UserWrite ((double)(i & 1)); });
+		run_bench (results, n + ".PlcRead", count, [&](int) {
+			double d = 0; val.PlcRead (d); sink = d; });
+	}
+
+	// binary
+	const int binsize = 256;
+	DataValue bin (data_type_enum::dtBinary, binsize);
+	vector<char> binbuf (binsize, 1);
+	run_bench (results, "DataValue.binary.PlcWriteBinary", count, [&](int) {
+		bin.PlcWriteBinary (binbuf.data(), binsize); });
+	run_bench (results, "DataValue.binary.UserReadBinary", count, [&](int) {
+		bin.UserReadBinary (binbuf.data(), binsize); });
+
+	// strings are converted through the atomic string type
+	DataValue str (data_type_enum::dtString);
+	const string s1 ("MAIN.fbChannel_1.arrData");
+	const string s2 ("GVL.Rack3.Slot7.Ch12.nCounts");
+	run_bench (results, "DataValue.string.PlcWrite", count, [&](int i) {
+		const string& s = (i & 1) ? s1 : s2;
+		str.PlcWrite (s.c_str(), s.size() + 1); });
+	run_bench (results, "DataValue.string.UserRead", count, [&](int) {
+		string s; str.UserRead (s); sink = (double)s.size(); });
+	run_bench (results, "DataValue.string.UserWrite", count, [&](int i) {
+		str.UserWrite ((i & 1) ? s1 : s2); });
+	run_bench (results, "DataValue.string.PlcRead", count, [&](int) {
+		char b[64]; str.PlcRead (b, sizeof (b)); sink = b[0]; });
+
+	DataValue wstr (data_type_enum::dtWString);
+	const wstring w1 (L"MAIN.fbChannel_1.arrData");
+	const wstring w2 (L"GVL.Rack3.Slot7.Ch12.nCounts");
+	run_bench (results, "DataValue.wstring.PlcWrite", count, [&](int i) {
+		const wstring& w = (i & 1) ? w1 : w2;
+		wstr.PlcWrite (w.c_str(), w.size() + 1); });
+	run_bench (results, "DataValue.wstring.UserRead", count, [&](int) {
+		wstring w; wstr.UserRead (w); sink = (double)w.size(); });
+	run_bench (results, "DataValue.wstring.UserWrite", count, [&](int i) {
+		wstr.UserWrite ((i & 1) ? w1 : w2); });
+}
+
+/** Benchmarks the push/pull dispatch of a record to its interfaces
+	@param results List of results (in/out)
+	@param count Number of iterations
+	@brief Record benchmarks
+ ************************************************************************/
+static void bench_record (bench_list& results, int count)
+{
+	BaseRecord rec ("bench", data_type_enum::dtDouble);
+	bench_interface* user = new bench_interface (rec);
+	bench_interface* plcif = new bench_interface (rec);
+	rec.set_userInterface (user);
+	rec.set_plcInterface (plcif);
+
+	// a plc write pushes the user, a user read pulls the plc
+	run_bench (results, "BaseRecord.PlcWrite", count, [&](int i) {
+		rec.PlcWrite ((double)i); });
+	run_bench (results, "BaseRecord.UserRead", count, [&](int) {
+		double d = 0; rec.UserRead (d); sink = d; });
+	run_bench (results, "BaseRecord.UserWrite", count, [&](int i) {
+		rec.UserWrite ((double)i); });
+	run_bench (results, "BaseRecord.PlcRead", count, [&](int) {
+		double d = 0; rec.PlcRead (d); sink = d; });
+	run_bench (results, "BaseRecord.UserPush", count, [&](int) {
+		rec.UserPush (true); });
+	if (user->pushes == 0 || plcif->pulls == 0) {
+		fprintf (stderr, "Record interfaces were not called\n");
+	}
+}
+
+/** Benchmarks the dirty flag handling with concurrent readers and a
+	writer, as with the read scanner and EPICS scan threads.
+	@param results List of results (in/out)
+	@param count Number of writes
+	@param maxthreads Maximum number of reader threads
+	@brief Contention benchmarks
+ ************************************************************************/
+static void bench_contention (bench_list& results, int count, int maxthreads)
+{
+	const int numrec = 64;
+	// 1, 2, 4, ... and the maximum number of readers
+	vector<int> steps;
+	for (int n = 1; n < maxthreads; n *= 2) steps.push_back (n);
+	steps.push_back (maxthreads);
+	for (const int readers : steps) {
+		vector<DataValue> vals (numrec, DataValue (data_type_enum::dtDouble));
+		atomic<bool> done (false);
+		atomic<long long> reads (0);
+		vector<thread> threads;
+		for (int r = 0; r < readers; ++r) {
+			threads.emplace_back ([&, r]() {
+				long long n = 0;
+				double d = 0;
+				while (!done.load()) {
+					for (int j = r; j < numrec; j += readers) {
+						if (vals[j].UserIsDirty() && vals[j].UserRead (d)) ++n;
+					}
+				}
+				reads += n;
+			});
+		}
+		auto t0 = chrono::steady_clock::now();
+		for (int i = 0; i < count; ++i) {
+			vals[i % numrec].PlcWrite ((double)i);
+		}
+		auto t1 = chrono::steady_clock::now();
+		done = true;
+		for (auto& t : threads) t.join();
+
+		bench_result res;
+		res.name = "Contention.PlcWrite." + to_string (readers) + "readers";
+		res.ops = count;
+		res.ns_per_op = chrono::duration<double, nano>(t1 - t0).count() / count;
+		results.push_back (res);
+	}
+}
+
+/** Reads baselines from a JSON file written by a previous run
+	@param fname Name of JSON file
+	@param results List of results to attach the baselines to (in/out)
+	@return Number of baselines found
+	@brief Read baselines
+ ************************************************************************/
+static int read_baseline (const string& fname, bench_list& results)
+{
+	ifstream inp (fname);
+	if (!inp) {
+		fprintf (stderr, "Failed to open baseline %s\n", fname.c_str());
+		return 0;
+	}
+	stringstream ss;
+	ss << inp.rdbuf();
+	const string text = ss.str();
+	const regex entry ("\"name\"\\s*:\\s*\"([^\"]+)\"\\s*,\\s*\"ns_per_op\"\\s*:\\s*([-+0-9.eE]+)");
+	map<string, double> base;
+	for (sregex_iterator it (text.begin(), text.end(), entry), end; it != end; ++it) {
+		base[(*it)[1].str()] = strtod ((*it)[2].str().c_str(), nullptr);
+	}
+	int num = 0;
+	for (auto& r : results) {
+		const auto b = base.find (r.name);
+		if (b != base.end()) {
+			r.baseline = b->second;
+			++num;
+		}
+	}
+	return num;
+}
+
+/** Writes the results as JSON
+	@param fname Name of JSON file
+	@param results List of results
+	@return True if successful
+	@brief Write results
+ ************************************************************************/
+static bool write_json (const string& fname, const bench_list& results)
+{
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, fname.c_str(), "w") || !fp) {
+		fprintf (stderr, "Failed to open %s\n", fname.c_str());
+		return false;
+	}
+	fprintf (fp, "{\n  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		fprintf (fp, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"ops\": %lld}%s\n",
+			results[i].name.c_str(), results[i].ns_per_op, results[i].ops,
+			(i + 1 < results.size()) ? "," : "");
+	}
+	fprintf (fp, "  ]\n}\n");
+	fclose (fp);
+	return true;
+}
+
+/** Main program
+ ************************************************************************/
+int main(int argc, char *argv[])
+{
+	int				count = 1000000;
+	int				maxthreads = 4;
+	double			tolerance = 25.0;
+	string			jsonname;
+	string			basename;
+	int				help = 0;
+
+	// command line parsing
+	for (int i = 1; i < argc; ++i) {
+		stringcase arg (argv[i] ? argv[i] : "");
+		// specify number of iterations
+		if ((arg == "-n" || arg == "/n") && i + 1 < argc) {
+			count = atoi (argv[++i]);
+		}
+		// specify maximum number of reader threads
+		else if ((arg == "-t" || arg == "/t") && i + 1 < argc) {
+			maxthreads = atoi (argv[++i]);
+		}
+		// specify JSON output file
+		else if ((arg == "-j" || arg == "/j") && i + 1 < argc) {
+			jsonname = argv[++i];
+		}
+		// specify JSON baseline file
+		else if ((arg == "-b" || arg == "/b") && i + 1 < argc) {
+			basename = argv[++i];
+		}
+		// specify allowed slow down in percent
+		else if ((arg == "-x" || arg == "/x") && i + 1 < argc) {
+			tolerance = atof (argv[++i]);
+		}
+		// ask for help
+		else if (arg == "-h" || arg == "/h" ) {
+			help = 1;
+		}
+		else {
+			help = 2;
+		}
+	}
+	if (help || (count <= 0) || (maxthreads <= 0)) {
+		printf ("Usage: PlcBench ['options']\n"
+			"       Measures the data value and record access between PLC and EPICS.\n"
+			"       -n 'num' number of iterations (default 1000000)\n"
+			"       -t 'num' maximum number of reader threads (default 4)\n"
+			"       -j 'file' write results as JSON\n"
+			"       -b 'file' compare against baseline results in JSON\n"
+			"                 (written by a previous run with -j)\n"
+			"       -x 'pct' allowed slow down against the baseline (default 25)\n");
+		return (help == 2) ? 1 : 0;
+	}
+
+	bench_list results;
+	bench_datavalue (results, count);
+	bench_record (results, count);
+	bench_contention (results, count, maxthreads);
+
+	int regressions = 0;
+	const bool compare = !basename.empty() && (read_baseline (basename, results) > 0);
+	for (const auto& r : results) {
+		if (compare && (r.baseline > 0)) {
+			const double change = 100.0 * (r.ns_per_op - r.baseline) / r.baseline;
+			const bool slow = change > tolerance;
+			if (slow) ++regressions;
+			printf ("%-40s %10.2f ns/op  (baseline %10.2f, %+6.1f%%)%s\n", r.name.c_str(),
+				r.ns_per_op, r.baseline, change, slow ? "  REGRESSION" : "");
+		}
+		else {
+			printf ("%-40s %10.2f ns/op\n", r.name.c_str(), r.ns_per_op);
+		}
+	}
+	if (!jsonname.empty()) {
+		write_json (jsonname, results);
+	}
+	if (compare) {
+		printf ("Regressions:       %i\n", regressions);
+	}
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,829 @@
+#include "stdafx.h"
+#include "ParseTpy.h"
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace ParseUtil;
+using namespace ParseTpy;
+
+
+/** @file TpyGen.cpp
+	Source for a generator of synthetic tpy files and matching PLC
+	memory images. It is used for scale and stress testing of the tpy
+	parser, the EPICS database generation and the IOC.
+ ************************************************************************/
+
+/// Index group of the generated symbols (PLC memory area)
+const int gen_igroup = 16448;
+/// Maximum alignment in bytes (TwinCAT pack mode 8)
+const int gen_max_align = 8;
+
+/** Simple types used for atomic values
+ ************************************************************************/
+static const struct {
+	/// Type name
+	const char*	name;
+	/// Size in bytes
+	int			size;
+	/// Name prefix
+	const char*	prefix;
+} gen_simple[] = {
+	{"BOOL", 1, "b"},
+	{"INT", 2, "n"},
+	{"DINT", 4, "n"},
+	{"UDINT", 4, "u"},
+	{"REAL", 4, "f"},
+	{"LREAL", 8, "f"},
+	{"STRING(80)", 81, "s"}
+};
+/// Number of simple numeric types (excludes the string)
+const int gen_num_numeric = 6;
+/// Index of the string type
+const int gen_string = 6;
+
+/** Kind of a generated type
+	@brief Generated type kind
+ ************************************************************************/
+enum class gen_kind {
+	/// Simple type
+	simple,
+	/// Enumerated type
+	enumtype,
+	/// Array type
+	arraytype,
+	/// Structured type
+	structtype
+};
+
+/** Member of a generated structure
+	@brief Generated structure member
+ ************************************************************************/
+struct gen_item {
+	/// Member name
+	string		name;
+	/// Index of the member type
+	int			type = 0;
+	/// Byte offset within the structure
+	int			offset = 0;
+	/// Has OPC properties
+	bool		props = false;
+};
+
+/** Generated data type
+	@brief Generated data type
+ ************************************************************************/
+struct gen_type {
+	/// Type name as it appears in the tpy file
+	string		name;
+	/// Kind of type
+	gen_kind	kind = gen_kind::simple;
+	/// Index into gen_simple for simple types and enums
+	int			basic = 0;
+	/// Size in bytes
+	int			size = 0;
+	/// Alignment in bytes
+	int			align = 1;
+	/// Element type for arrays
+	int			elem = -1;
+	/// Number of array elements or enum values
+	int			elements = 0;
+	/// Difference between adjacent enum values
+	int			step = 1;
+	/// Members of structures
+	vector<gen_item> items;
+	/// Number of atomic values
+	int			leaves = 1;
+};
+
+/** Generated symbol
+	@brief Generated symbol
+ ************************************************************************/
+struct gen_symbol {
+	/// Symbol name
+	string		name;
+	/// Index of the symbol type
+	int			type = 0;
+	/// Byte offset in the index group
+	int			offset = 0;
+	/// Has OPC properties
+	bool		props = false;
+};
+
+/** Generator settings
+	@brief Generator settings
+ ************************************************************************/
+struct gen_settings {
+	/// Number of atomic values
+	int			values = 10000;
+	/// Nesting depth of structures
+	int			depth = 3;
+	/// Average number of array elements
+	int			arraysize = 10;
+	/// Percentage of structured top level symbols
+	int			structpct = 40;
+	/// Percentage of arrays
+	int			arraypct = 15;
+	/// Percentage of enumerated values
+	int			enumpct = 10;
+	/// Percentage of strings
+	int			stringpct = 2;
+	/// Percentage of symbols and members with OPC properties
+	int			opcpct = 20;
+	/// Maximum address gap between symbols in bytes
+	int			gapmax = 0;
+	/// Percentage of symbols followed by a gap
+	int			gappct = 10;
+	/// Exponential instead of uniform gap distribution
+	bool		gapexp = false;
+	/// Random seed
+	unsigned int seed = 1;
+	/// ADS net id
+	string		netid = "127.0.0.1.1.1";
+	/// ADS port
+	int			port = 851;
+};
+
+/** Generator for a synthetic PLC program. It creates enums, arrays and
+	nested structures, lays out the symbols in a single index group and
+	writes the tpy file and the matching memory image.
+	@brief Synthetic PLC program
+ ************************************************************************/
+class tpy_generator {
+public:
+	/// Constructor
+	explicit tpy_generator (const gen_settings& set)
+		: settings (set), rng (set.seed) {}
+
+	/// Generate types and symbols
+	void generate ();
+	/// Write the tpy file
+	bool write_tpy (FILE* fp) const;
+	/// Write the memory image
+	bool write_image (FILE* fp) const;
+
+	/// Number of atomic values
+	int get_values () const noexcept { return values; }
+	/// Number of symbols
+	int get_symbol_num () const noexcept { return (int)symbols.size(); }
+	/// Number of data types (excluding the simple ones)
+	int get_type_num () const noexcept { return (int)(types.size() - gen_string - 1); }
+	/// Size of the memory image in bytes
+	int get_image_size () const noexcept { return imagesize; }
+
+protected:
+	/// Random percentage check
+	bool chance (int pct) { return (int)(rng() % 100) < pct; }
+	/// Random number between lo and hi (inclusive)
+	int uniform (int lo, int hi) { return lo + (int)(rng() % (unsigned int)(hi - lo + 1)); }
+	/// Pick a simple numeric, string or enum type
+	int pick_atomic ();
+	/// Pick an array type
+	int pick_array (int level);
+	/// Get or create an array type
+	int array_type (int elem, int elements);
+	/// Create a structure type of a given level
+	int struct_type (int level, int variant);
+	/// Gap after a symbol
+	int pick_gap ();
+
+	/// Write OPC properties
+	void write_props (FILE* fp, const gen_type& typ, int num, bool opc,
+		bool props, const char* indent) const;
+	/// Fill memory image with values
+	void fill (vector<unsigned char>& image, int type, int offset,
+		unsigned int& count) const;
+
+	/// Settings
+	gen_settings		settings;
+	/// Random number generator
+	mt19937				rng;
+	/// Types
+	vector<gen_type>	types;
+	/// Array types by name
+	map<string, int>	arrays;
+	/// Enum types
+	vector<int>			enums;
+	/// Structure types by level
+	vector<vector<int>>	structs;
+	/// Symbols
+	vector<gen_symbol>	symbols;
+	/// Number of atomic values
+	int					values = 0;
+	/// Image size in bytes
+	int					imagesize = 0;
+};
+
+/* Round up to alignment
+ ************************************************************************/
+static int align_to (int offset, int align) noexcept
+{
+	return (offset + align - 1) / align * align;
+}
+
+/* tpy_generator::pick_atomic
+ ************************************************************************/
+int tpy_generator::pick_atomic ()
+{
+	const int r = uniform (0, 99);
+	if (r < settings.enumpct) {
+		return enums[rng() % enums.size()];
+	}
+	else if (r < settings.enumpct + settings.stringpct) {
+		return gen_string;
+	}
+	return rng() % gen_num_numeric;
+}
+
+/* tpy_generator::pick_array
+ ************************************************************************/
+int tpy_generator::pick_array (int level)
+{
+	const int elements = uniform (1, 2 * settings.arraysize - 1);
+	// array of structures
+	if ((level > 0) && chance (settings.structpct)) {
+		const vector<int>& sub = structs[level - 1];
+		return array_type (sub[rng() % sub.size()], elements);
+	}
+	return array_type (pick_atomic(), elements);
+}
+
+/* tpy_generator::array_type
+ ************************************************************************/
+int tpy_generator::array_type (int elem, int elements)
+{
+	char buf[256];
+	sprintf_s (buf, sizeof (buf), "ARRAY [0..%i] OF %s",
+		elements - 1, types[elem].name.c_str());
+	auto a = arrays.find (buf);
+	if (a != arrays.end()) {
+		return a->second;
+	}
+	gen_type t;
+	t.name = buf;
+	t.kind = gen_kind::arraytype;
+	t.elem = elem;
+	t.elements = elements;
+	t.size = elements * types[elem].size;
+	t.align = types[elem].align;
+	t.leaves = elements * types[elem].leaves;
+	types.push_back (t);
+	arrays[buf] = (int)types.size() - 1;
+	return (int)types.size() - 1;
+}
+
+/* tpy_generator::struct_type
+ ************************************************************************/
+int tpy_generator::struct_type (int level, int variant)
+{
+	char buf[256];
+	gen_type t;
+	sprintf_s (buf, sizeof (buf), "ST_Gen_L%i_%i", level, variant);
+	t.name = buf;
+	t.kind = gen_kind::structtype;
+	t.leaves = 0;
+
+	// nested structures first, then atomic values and arrays
+	vector<int> members;
+	if (level > 0) {
+		const vector<int>& sub = structs[level - 1];
+		const int nested = chance (settings.structpct) ? 2 : 1;
+		for (int i = 0; i < nested; ++i) {
+			members.push_back (sub[rng() % sub.size()]);
+		}
+	}
+	const int num = uniform (4, 12);
+	for (int i = 0; i < num; ++i) {
+		members.push_back (chance (settings.arraypct) ?
+			pick_array (level) : pick_atomic());
+	}
+
+	// layout
+	int offset = 0;
+	for (size_t i = 0; i < members.size(); ++i) {
+		const gen_type& m = types[members[i]];
+		gen_item item;
+		switch (m.kind) {
+		case gen_kind::structtype:
+			sprintf_s (buf, sizeof (buf), "stSub%i", (int)i);
+			break;
+		case gen_kind::arraytype:
+			sprintf_s (buf, sizeof (buf), "arrData%i", (int)i);
+			break;
+		case gen_kind::enumtype:
+			sprintf_s (buf, sizeof (buf), "eMode%i", (int)i);
+			break;
+		default:
+			sprintf_s (buf, sizeof (buf), "%sValue%i", gen_simple[m.basic].prefix, (int)i);
+			break;
+		}
+		item.name = buf;
+		item.type = members[i];
+		item.offset = offset = align_to (offset, m.align);
+		item.props = chance (settings.opcpct);
+		offset += m.size;
+		t.align = max (t.align, m.align);
+		t.leaves += m.leaves;
+		t.items.push_back (item);
+	}
+	t.size = align_to (offset, t.align);
+	types.push_back (t);
+	return (int)types.size() - 1;
+}
+
+/* tpy_generator::pick_gap
+ ************************************************************************/
+int tpy_generator::pick_gap ()
+{
+	if ((settings.gapmax <= 0) || !chance (settings.gappct)) {
+		return 0;
+	}
+	// mostly small gaps with an occasional large one
+	if (settings.gapexp) {
+		exponential_distribution<double> dist (4.0 / settings.gapmax);
+		return min (settings.gapmax, 1 + (int)dist (rng));
+	}
+	return uniform (1, settings.gapmax);
+}
+
+/* tpy_generator::generate
+ ************************************************************************/
+void tpy_generator::generate ()
+{
+	types.clear();
+	arrays.clear();
+	enums.clear();
+	structs.clear();
+	symbols.clear();
+	values = 0;
+	imagesize = 0;
+
+	// simple types
+	for (int i = 0; i <= gen_string; ++i) {
+		gen_type t;
+		t.name = gen_simple[i].name;
+		t.basic = i;
+		t.size = gen_simple[i].size;
+		t.align = (i == gen_string) ? 1 : t.size;
+		types.push_back (t);
+	}
+	// enums: the last one has values outside 0 to 15
+	const int num_enums = 8;
+	for (int i = 0; i < num_enums; ++i) {
+		gen_type t;
+		char buf[256];
+		sprintf_s (buf, sizeof (buf), "E_Gen%i", i);
+		t.name = buf;
+		t.kind = gen_kind::enumtype;
+		t.basic = 1;
+		t.size = t.align = 2;
+		t.elements = 2 + 2 * i;
+		t.step = (i == num_enums - 1) ? 100 : 1;
+		types.push_back (t);
+		enums.push_back ((int)types.size() - 1);
+	}
+	// structures, level by level
+	const int variants = 4;
+	structs.resize (settings.depth);
+	for (int l = 0; l < settings.depth; ++l) {
+		for (int v = 0; v < variants; ++v) {
+			structs[l].push_back (struct_type (l, v));
+		}
+	}
+
+	// symbols
+	int offset = 0;
+	char buf[256];
+	while (values < settings.values) {
+		const int i = (int)symbols.size();
+		gen_symbol s;
+		const int r = uniform (0, 99);
+		if ((r < settings.structpct) && (settings.depth > 0)) {
+			const vector<int>& st = structs[rng() % structs.size()];
+			s.type = st[rng() % st.size()];
+			sprintf_s (buf, sizeof (buf), "GVL_Gen%i.stData%i", i / 1000, i);
+		}
+		else if (r < settings.structpct + settings.arraypct) {
+			s.type = pick_array (min (settings.depth, 1));
+			sprintf_s (buf, sizeof (buf), "GVL_Gen%i.arrData%i", i / 1000, i);
+		}
+		else {
+			s.type = pick_atomic();
+			if (types[s.type].kind == gen_kind::enumtype) {
+				sprintf_s (buf, sizeof (buf), "GVL_Gen%i.eMode%i", i / 1000, i);
+			}
+			else {
+				sprintf_s (buf, sizeof (buf), "GVL_Gen%i.%sValue%i", i / 1000,
+					gen_simple[types[s.type].basic].prefix, i);
+			}
+		}
+		const gen_type& t = types[s.type];
+		s.name = buf;
+		s.offset = offset = align_to (offset, min (t.align, gen_max_align));
+		s.props = chance (settings.opcpct);
+		offset += t.size + pick_gap();
+		values += t.leaves;
+		symbols.push_back (s);
+	}
+	imagesize = align_to (offset, gen_max_align);
+}
+
+/* tpy_generator::write_props
+ ************************************************************************/
+void tpy_generator::write_props (FILE* fp, const gen_type& typ, int num,
+	bool opc, bool props, const char* indent) const
+{
+	if (!opc && !props) {
+		return;
+	}
+	fprintf (fp, "%s<Properties>\n", indent);
+	if (opc) {
+		fprintf (fp, "%s\t<Property><Name>opc</Name><Value>1</Value></Property>\n", indent);
+	}
+	if (props) {
+		fprintf (fp, "%s\t<Property><Name>opc_prop[0101]</Name><Value>Generated value %i</Value></Property>\n",
+			indent, num);
+		if ((typ.kind == gen_kind::simple) && (typ.basic == 4 || typ.basic == 5)) {
+			fprintf (fp, "%s\t<Property><Name>opc_prop[0100]</Name><Value>mm</Value></Property>\n", indent);
+			fprintf (fp, "%s\t<Property><Name>opc_prop[8500]</Name><Value>3</Value></Property>\n", indent);
+		}
+		if (num % 4 == 0) {
+			fprintf (fp, "%s\t<Property><Name>opc_prop[0005]</Name><Value>1</Value></Property>\n", indent);
+		}
+	}
+	fprintf (fp, "%s</Properties>\n", indent);
+}
+
+/* tpy_generator::write_tpy
+ ************************************************************************/
+bool tpy_generator::write_tpy (FILE* fp) const
+{
+	fprintf (fp, "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
+	fprintf (fp, "<PlcProjectInfo>\n");
+	fprintf (fp, "\t<ProjectInfo/>\n");
+	fprintf (fp, "\t<RoutingInfo>\n");
+	fprintf (fp, "\t\t<AdsInfo>\n");
+	fprintf (fp, "\t\t\t<NetId>%s</NetId>\n", settings.netid.c_str());
+	fprintf (fp, "\t\t\t<Port>%i</Port>\n", settings.port);
+	fprintf (fp, "\t\t\t<TargetName>TpyGen</TargetName>\n");
+	fprintf (fp, "\t\t</AdsInfo>\n");
+	fprintf (fp, "\t</RoutingInfo>\n");
+	fprintf (fp, "\t<CompilerInfo>\n");
+	fprintf (fp, "\t\t<CompilerVersion>3.1.4024.22</CompilerVersion>\n");
+	fprintf (fp, "\t\t<TwinCATVersion>3.1.4024.22</TwinCATVersion>\n");
+	fprintf (fp, "\t\t<CpuFamily>Intel x64</CpuFamily>\n");
+	fprintf (fp, "\t</CompilerInfo>\n");
+
+	// data types
+	fprintf (fp, "\t<DataTypes>\n");
+	for (const auto& t : types) {
+		switch (t.kind) {
+		case gen_kind::enumtype:
+			fprintf (fp, "\t\t<DataType>\n");
+			fprintf (fp, "\t\t\t<Name>%s</Name>\n", t.name.c_str());
+			fprintf (fp, "\t\t\t<BitSize>%i</BitSize>\n", 8 * t.size);
+			fprintf (fp, "\t\t\t<Type>%s</Type>\n", gen_simple[t.basic].name);
+			for (int i = 0; i < t.elements; ++i) {
+				fprintf (fp, "\t\t\t<EnumInfo><Text>%s_V%i</Text><Enum>%i</Enum></EnumInfo>\n",
+					t.name.c_str(), i, i * t.step);
+			}
+			fprintf (fp, "\t\t</DataType>\n");
+			break;
+		case gen_kind::arraytype:
+			fprintf (fp, "\t\t<DataType>\n");
+			fprintf (fp, "\t\t\t<Name>%s</Name>\n", t.name.c_str());
+			fprintf (fp, "\t\t\t<BitSize>%i</BitSize>\n", 8 * t.size);
+			fprintf (fp, "\t\t\t<Type>%s</Type>\n", types[t.elem].name.c_str());
+			fprintf (fp, "\t\t\t<ArrayInfo><LBound>0</LBound><Elements>%i</Elements></ArrayInfo>\n",
+				t.elements);
+			fprintf (fp, "\t\t</DataType>\n");
+			break;
+		case gen_kind::structtype:
+			fprintf (fp, "\t\t<DataType>\n");
+			fprintf (fp, "\t\t\t<Name>%s</Name>\n", t.name.c_str());
+			fprintf (fp, "\t\t\t<BitSize>%i</BitSize>\n", 8 * t.size);
+			for (size_t i = 0; i < t.items.size(); ++i) {
+				const gen_item& item = t.items[i];
+				fprintf (fp, "\t\t\t<SubItem>\n");
+				fprintf (fp, "\t\t\t\t<Name>%s</Name>\n", item.name.c_str());
+				fprintf (fp, "\t\t\t\t<Type>%s</Type>\n", types[item.type].name.c_str());
+				fprintf (fp, "\t\t\t\t<BitSize>%i</BitSize>\n", 8 * types[item.type].size);
+				fprintf (fp, "\t\t\t\t<BitOffs>%i</BitOffs>\n", 8 * item.offset);
+				write_props (fp, types[item.type], (int)i, false, item.props, "\t\t\t\t");
+				fprintf (fp, "\t\t\t</SubItem>\n");
+			}
+			fprintf (fp, "\t\t</DataType>\n");
+			break;
+		default:
+			break;
+		}
+	}
+	fprintf (fp, "\t</DataTypes>\n");
+
+	// symbols
+	fprintf (fp, "\t<Symbols>\n");
+	for (size_t i = 0; i < symbols.size(); ++i) {
+		const gen_symbol& s = symbols[i];
+		const gen_type& t = types[s.type];
+		fprintf (fp, "\t\t<Symbol>\n");
+		fprintf (fp, "\t\t\t<Name>%s</Name>\n", s.name.c_str());
+		fprintf (fp, "\t\t\t<Type>%s</Type>\n", t.name.c_str());
+		fprintf (fp, "\t\t\t<IGroup>%i</IGroup>\n", gen_igroup);
+		fprintf (fp, "\t\t\t<IOffset>%i</IOffset>\n", s.offset);
+		fprintf (fp, "\t\t\t<BitSize>%i</BitSize>\n", 8 * t.size);
+		write_props (fp, t, (int)i, true, s.props, "\t\t\t");
+		fprintf (fp, "\t\t</Symbol>\n");
+	}
+	fprintf (fp, "\t</Symbols>\n");
+	fprintf (fp, "</PlcProjectInfo>\n");
+	return !ferror (fp);
+}
+
+/* tpy_generator::fill
+ ************************************************************************/
+void tpy_generator::fill (vector<unsigned char>& image, int type, int offset,
+	unsigned int& count) const
+{
+	const gen_type& t = types[type];
+	unsigned char* p = image.data() + offset;
+	switch (t.kind) {
+	case gen_kind::structtype:
+		for (const auto& item : t.items) {
+			fill (image, item.type, offset + item.offset, count);
+		}
+		return;
+	case gen_kind::arraytype:
+		for (int i = 0; i < t.elements; ++i) {
+			fill (image, t.elem, offset + i * types[t.elem].size, count);
+		}
+		return;
+	case gen_kind::enumtype:
+		{
+			const short v = (short)((count % t.elements) * t.step);
+			memcpy (p, &v, sizeof (v));
+			break;
+		}
+	default:
+		switch (t.basic) {
+		case 0:
+			*p = (unsigned char)(count & 1);
+			break;
+		case 1:
+			{
+				const short v = (short)(count * 7);
+				memcpy (p, &v, sizeof (v));
+				break;
+			}
+		case 2:
+			{
+				const int v = (int)(count * 13);
+				memcpy (p, &v, sizeof (v));
+				break;
+			}
+		case 3:
+			{
+				const unsigned int v = count * 17;
+				memcpy (p, &v, sizeof (v));
+				break;
+			}
+		case 4:
+			{
+				const float v = 0.5f * (float)(count % 100000);
+				memcpy (p, &v, sizeof (v));
+				break;
+			}
+		case 5:
+			{
+				const double v = 0.25 * count;
+				memcpy (p, &v, sizeof (v));
+				break;
+			}
+		default:
+			sprintf_s ((char*)p, t.size, "Value %u", count);
+			break;
+		}
+		break;
+	}
+	++count;
+}
+
+/* tpy_generator::write_image
+ ************************************************************************/
+bool tpy_generator::write_image (FILE* fp) const
+{
+	// values are stored little endian as on the PLC
+	vector<unsigned char> image (imagesize, 0);
+	unsigned int count = 0;
+	for (const auto& s : symbols) {
+		fill (image, s.type, s.offset, count);
+	}
+	return image.empty() ||
+		(fwrite (image.data(), 1, image.size(), fp) == image.size());
+}
+
+/** Symbol processing for the verification of a generated file
+	@brief Verify processing
+ ************************************************************************/
+class verify_processing {
+public:
+	/// Constructor
+	explicit verify_processing (int size) noexcept : imagesize (size) {}
+	/// Process
+	bool operator() (const process_arg& arg) noexcept {
+		++num;
+		const process_arg_tc* targ = dynamic_cast<const process_arg_tc*>(&arg);
+		if (!targ || (targ->get_igroup() != gen_igroup) || (targ->get_ioffset() < 0) ||
+			(targ->get_ioffset() + targ->get_bytesize() > imagesize)) {
+			++outside;
+		}
+		return true;
+	}
+	/// Number of processed values
+	int		num = 0;
+	/// Number of values outside the memory image
+	int		outside = 0;
+protected:
+	/// Image size
+	int		imagesize;
+};
+
+/** Main program
+ ************************************************************************/
+int main(int argc, char *argv[])
+{
+	gen_settings	settings;
+	string			tpyfilename;
+	string			imgfilename;
+	bool			verify = false;
+	int				help = 0;
+
+	// command line parsing
+	for (int i = 1; i < argc; ++i) {
+		stringcase arg (argv[i] ? argv[i] : "");
+		const bool hasval = (i + 1 < argc);
+		// number of atomic values
+		if ((arg == "-n" || arg == "/n") && hasval) {
+			settings.values = atoi (argv[++i]);
+		}
+		// nesting depth
+		else if ((arg == "-d" || arg == "/d") && hasval) {
+			settings.depth = atoi (argv[++i]);
+		}
+		// array size
+		else if ((arg == "-a" || arg == "/a") && hasval) {
+			settings.arraysize = atoi (argv[++i]);
+		}
+		// percentage of structures
+		else if ((arg == "-ps" || arg == "/ps") && hasval) {
+			settings.structpct = atoi (argv[++i]);
+		}
+		// percentage of arrays
+		else if ((arg == "-pa" || arg == "/pa") && hasval) {
+			settings.arraypct = atoi (argv[++i]);
+		}
+		// percentage of enums
+		else if ((arg == "-pe" || arg == "/pe") && hasval) {
+			settings.enumpct = atoi (argv[++i]);
+		}
+		// percentage of strings
+		else if ((arg == "-pt" || arg == "/pt") && hasval) {
+			settings.stringpct = atoi (argv[++i]);
+		}
+		// percentage of opc properties
+		else if ((arg == "-po" || arg == "/po") && hasval) {
+			settings.opcpct = atoi (argv[++i]);
+		}
+		// percentage of gaps
+		else if ((arg == "-pg" || arg == "/pg") && hasval) {
+			settings.gappct = atoi (argv[++i]);
+		}
+		// maximum gap
+		else if ((arg == "-g" || arg == "/g") && hasval) {
+			settings.gapmax = atoi (argv[++i]);
+		}
+		// exponential gap distribution
+		else if (arg == "-ge" || arg == "/ge") {
+			settings.gapexp = true;
+		}
+		// random seed
+		else if ((arg == "-s" || arg == "/s") && hasval) {
+			settings.seed = (unsigned int)strtoul (argv[++i], NULL, 10);
+		}
+		// ads net id and port
+		else if ((arg == "-t" || arg == "/t") && hasval) {
+			settings.netid = argv[++i];
+			const size_t pos = settings.netid.find (':');
+			if (pos != string::npos) {
+				settings.port = atoi (settings.netid.c_str() + pos + 1);
+				settings.netid.erase (pos);
+			}
+		}
+		// memory image
+		else if ((arg == "-m" || arg == "/m") && hasval) {
+			imgfilename = argv[++i];
+		}
+		// verify
+		else if (arg == "-v" || arg == "/v") {
+			verify = true;
+		}
+		// ask for help
+		else if (arg == "-h" || arg == "/h" ) {
+			help = 1;
+		}
+		// output file
+		else if (tpyfilename.empty() && !arg.empty() && (arg[0] != '-') && (arg[0] != '/')) {
+			tpyfilename = argv[i];
+		}
+		else {
+			help = 2;
+		}
+	}
+	if (help || tpyfilename.empty() || (settings.values <= 0) ||
+		(settings.depth < 0) || (settings.depth > 16) || (settings.arraysize <= 0)) {
+		printf ("Usage: tpygen ['options'] 'output.tpy'\n"
+			"       Generates a synthetic tpy file and a matching PLC memory image.\n"
+			"       All symbols are published and located in index group %i.\n"
+			"       -n 'num' number of atomic values (default 10000)\n"
+			"       -d 'num' nesting depth of structures (default 3, maximum 16)\n"
+			"       -a 'num' average number of array elements (default 10)\n"
+			"       -ps 'pct' percentage of structures (default 40)\n"
+			"       -pa 'pct' percentage of arrays (default 15)\n"
+			"       -pe 'pct' percentage of enums (default 10)\n"
+			"       -pt 'pct' percentage of strings (default 2)\n"
+			"       -po 'pct' percentage of symbols with opc properties (default 20)\n"
+			"       -g 'num' maximum address gap in bytes after a symbol (default 0)\n"
+			"       -pg 'pct' percentage of symbols followed by a gap (default 10)\n"
+			"       -ge exponential instead of uniform gap distribution\n"
+			"       -s 'num' random seed (default 1)\n"
+			"       -t 'netid:port' ADS address (default 127.0.0.1.1.1:851)\n"
+			"       -m 'file' writes the memory image of the index group\n"
+			"       -v parses the generated tpy file and checks the addresses\n",
+			gen_igroup);
+		return (help == 2) ? 1 : 0;
+	}
+
+	// generate
+	auto t0 = chrono::steady_clock::now();
+	tpy_generator gen (settings);
+	gen.generate();
+	auto t1 = chrono::steady_clock::now();
+
+	// write tpy file
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, tpyfilename.c_str(), "w") || !fp) {
+		fprintf (stderr, "Failed to open %s.\n", tpyfilename.c_str());
+		return 1;
+	}
+	const bool tpyok = gen.write_tpy (fp);
+	fclose (fp);
+	if (!tpyok) {
+		fprintf (stderr, "Failed to write %s.\n", tpyfilename.c_str());
+		return 1;
+	}
+	// write memory image
+	if (!imgfilename.empty()) {
+		fp = nullptr;
+		if (fopen_s (&fp, imgfilename.c_str(), "wb") || !fp) {
+			fprintf (stderr, "Failed to open %s.\n", imgfilename.c_str());
+			return 1;
+		}
+		const bool imgok = gen.write_image (fp);
+		fclose (fp);
+		if (!imgok) {
+			fprintf (stderr, "Failed to write %s.\n", imgfilename.c_str());
+			return 1;
+		}
+	}
+	auto t2 = chrono::steady_clock::now();
+
+	printf ("Atomic values:     %i\n", gen.get_values());
+	printf ("Symbols:           %i\n", gen.get_symbol_num());
+	printf ("Data types:        %i\n", gen.get_type_num());
+	printf ("Image size:        %i bytes\n", gen.get_image_size());
+	printf ("Generate:          %10.1f ms\n", chrono::duration<double, milli>(t1 - t0).count());
+	printf ("Write:             %10.1f ms\n", chrono::duration<double, milli>(t2 - t1).count());
+	if (!verify) {
+		return 0;
+	}
+
+	// parse the generated file
+	if (fopen_s (&fp, tpyfilename.c_str(), "r") || !fp) {
+		fprintf (stderr, "Failed to open %s.\n", tpyfilename.c_str());
+		return 1;
+	}
+	tpy_file tpyfile;
+	const bool parseok = tpyfile.parse (fp);
+	fclose (fp);
+	if (!parseok) {
+		fprintf (stderr, "Unable to parse %s\n", tpyfilename.c_str());
+		return 1;
+	}
+	verify_processing check (gen.get_image_size());
+	tpyfile.set_process_tags (process_tag_enum::atomic);
+	tpyfile.process_symbols (check);
+	auto t3 = chrono::steady_clock::now();
+	printf ("Parse and process: %10.1f ms\n", chrono::duration<double, milli>(t3 - t2).count());
+	printf ("Parsed values:     %i\n", check.num);
+	printf ("Outside of image:  %i\n", check.outside);
+	return ((check.num != gen.get_values()) || check.outside) ? 1 : 0;
+}
@@ -5,6 +5,11 @@
 #include "TpyToEpicsConst.h"
 #include "TpyToEpics.h"
 #include <filesystem>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <cstdarg>
 
 #pragma warning (disable : 4996)
 
@@ -90,12 +95,6 @@ int epics_conversion::getopt (int argc, const char* const argv[], bool argp[])
 			++num;
 		} 
 		// Check if a prefix has been specified
-		else if ((arg == "-p" || arg == "/p") && i + 1 < argc) {
-			set_prefix (i + 1 < argc && argv[i+1] ? argv[i+1] : "");
-			i += 1;
-			++num;
-		}
-		// Check if a prefix has been specified
 		else if ((arg == "-p" || arg == "/p") && i + 1 < argc) {
 			set_prefix (i + 1 < argc && argv[i + 1] ? argv[i + 1] : "");
 			if (argp) argp[i] = true;
@@ -140,21 +139,72 @@ int epics_conversion::getopt (int argc, const char* const argv[], bool argp[])
 	return num;
 }
 
+/* Compile conversion settings
+ ************************************************************************/
+void epics_conversion::compile() noexcept
+{
+	// eliminate leading dot
+	strip_leading = no_leading_dot || (conv_rule == tc_epics_conv::ligo_std) || 
+		(conv_rule == tc_epics_conv::ligo_vac);
+	// case conversion
+	for (int c = 0; c < 256; ++c) {
+		switch (case_epics_names) {
+		case case_type::upper:
+			charmap[c] = (char)toupper (c);
+			break;
+		case case_type::lower:
+			charmap[c] = (char)tolower (c);
+			break;
+		default:
+			charmap[c] = (char)c;
+			break;
+		}
+	}
+	// conversion rules
+	switch (conv_rule) {
+		// ligo standard: first dot to colon, second to dash, others to underscore
+	case tc_epics_conv::ligo_std:
+		separator = '.';
+		charmap['.'] = '_';
+		break;
+		// ligo vacuum: first underscore to colon, second to dash, dots to underscore
+	case tc_epics_conv::ligo_vac:
+		separator = '_';
+		charmap['.'] = '_';
+		break;
+		// replace all dots with underscores
+	case tc_epics_conv::no_dot:
+		separator = 0;
+		charmap['.'] = '_';
+		break;
+		// do nothing
+	case tc_epics_conv::no_conversion:
+	default:
+		separator = 0;
+		break;
+	}
+	// replace array brackets with underscore
+	if (no_array_index) {
+		charmap['['] = '_';
+		charmap[']'] = 0;
+	}
+}
+
 /* Obtain EPICS name from OPC name
  ************************************************************************/
 string epics_conversion::to_epics (const stringcase& name, bool published,
 	const ParseUtil::substitution** subst) const
 {
-	stringcase n (name);
-	stringcase::size_type pos = 0;
+	// reused buffer for substitutions and replacement rules
+	thread_local stringcase n;
+	n = name;
 
 	if (subst != nullptr) *subst = nullptr;
 	
 	// apply replacement list if required
 	if (!query_substitution(n, published, subst)) {
 		// ignore this name
-		n.clear();
-		return string(n.c_str());
+		return string();
 	}
 
 	// apply replacement rules
@@ -163,84 +213,393 @@ string epics_conversion::to_epics (const stringcase& name, bool published,
 	}
 
 	// eliminate leading dot
-	if (no_leading_dot || (conv_rule == tc_epics_conv::ligo_std) || (conv_rule == tc_epics_conv::ligo_vac)) {
-		std::stringcase::size_type pos2 = 0;
-		if (!n.empty() && (n[0] == '.')) {
-			n.erase (0, 1);
+	const char* const p = n.c_str();
+	const size_t len = n.size();
+	size_t start = 0;
+	if (strip_leading && (len > 0)) {
+		if (p[0] == '.') {
+			start = 1;
 		}
 		// TwinCAT 3 doesn't use an empty name for globals
-		else if ((pos2 = n.find ('.')) != std::stringcase::npos) {
-			n.erase (0, pos2 + 1);
+		else {
+			const stringcase::size_type pos = n.find ('.');
+			if (pos != stringcase::npos) start = pos + 1;
 		}
 	}
 
-	// apply conversion rules
-	switch (conv_rule) {
-		// ligo standard
-	case tc_epics_conv::ligo_std:
-		// replace first dot with colon
-		pos = n.find ('.');
-		if (pos != stringcase::npos) {
-			n[pos] = ':';
-		}
-		// replace second dot with dash
-		pos = n.find ('.');
-		if (pos != stringcase::npos) {
-			n[pos] = '-';
-		}
-		// replace remaining dots with underscore
-		while ((pos = n.find ('.')) != stringcase::npos) {
-			n[pos] = '_';
+	// add prefix, then convert the name in a single pass
+	string epicsname;
+	epicsname.reserve (prefix.size() + len - start);
+	epicsname.append (prefix.c_str(), prefix.size());
+	int seps = 0;
+	for (size_t i = start; i < len; ++i) {
+		if (separator && (p[i] == separator) && (seps < 2)) {
+			epicsname.push_back ((seps++ == 0) ? ':' : '-');
 		}
-		break;
-		// ligo standard
-	case tc_epics_conv::ligo_vac:
-		// replace first underscore with colon
-		pos = n.find ('_');
-		if (pos != stringcase::npos) {
-			n[pos] = ':';
+		else if (const char c = charmap[(unsigned char)p[i]]) {
+			epicsname.push_back (c);
 		}
-		// replace second underscore with dash
-		pos = n.find ('_');
-		if (pos != stringcase::npos) {
-			n[pos] = '-';
+	}
+	return epicsname;
+}
+
+
+/** State of an output file shared between the producer and the 
+	background writer thread. Except for pending, the members are only
+	accessed by the writer thread once the file has been opened.
+	@brief Output file state
+************************************************************************/
+struct output_file_state {
+	/// Filename (empty for console)
+	std::string			filename;
+	/// Existing file which is compared against the new content
+	FILE*				orig = nullptr;
+	/// File the new content is written to
+	FILE*				out = nullptr;
+	/// Name of the temporary file, if the existing file is replaced
+	std::string			tmpname;
+	/// Number of characters identical to the existing file
+	size_t				same = 0;
+	/// Number of buffers waiting to be written (guarded by the writer)
+	int					pending = 0;
+
+	/// Destructor
+	~output_file_state() {
+		if (orig) fclose (orig);
+		if (out) fclose (out); }
+};
+
+/** Background thread writing output file buffers. The thread is started
+	on demand and terminates when there is nothing left to write.
+	@brief Output file writer
+************************************************************************/
+class output_writer {
+public:
+	/// Get the writer
+	static output_writer& get() { static output_writer writer; return writer; }
+	/// Queue a buffer for writing, blocks if the queue is full
+	/// @param st File state
+	/// @param data Buffer content
+	/// @param last Indicates the end of the file
+	void push (const std::shared_ptr<output_file_state>& st, 
+		std::string&& data, bool last);
+	/// Wait until all buffers of a file (or of all files) have been written
+	/// @param st File state, or nullptr for all files
+	void wait (const output_file_state* st = nullptr);
+
+protected:
+	/// Queued buffer
+	struct job {
+		/// File state
+		std::shared_ptr<output_file_state> state;
+		/// Buffer content
+		std::string		data;
+		/// End of file
+		bool			last;
+	};
+
+	/// Constructor
+	output_writer() = default;
+	/// Destructor
+	~output_writer();
+	/// Thread function
+	void run();
+	/// Write a buffer
+	static void write (output_file_state& st, const std::string& data);
+	/// Finish writing a file
+	static void finish (output_file_state& st);
+	/// Switch from comparing to writing
+	static bool start_writing (output_file_state& st);
+
+	/// Mutex guarding the queue
+	std::mutex				mux;
+	/// Signals a new buffer in the queue
+	std::condition_variable	queued;
+	/// Signals a written buffer
+	std::condition_variable	written;
+	/// Queue of buffers to be written
+	std::deque<job>			queue;
+	/// Writer thread is running
+	bool					running = false;
+	/// Writer thread
+	std::thread				thread;
+};
+
+/* Destructor
+   output_writer::~output_writer
+************************************************************************/
+output_writer::~output_writer()
+{
+	wait();
+	if (thread.joinable()) thread.join();
+}
+
+/* Queue a buffer
+   output_writer::push
+************************************************************************/
+void output_writer::push (const std::shared_ptr<output_file_state>& st,
+						  std::string&& data, bool last)
+{
+	std::unique_lock<std::mutex> lock (mux);
+	written.wait (lock, [this]() { 
+		return queue.size() < output_file::queue_depth; });
+	queue.push_back (job{st, std::move (data), last});
+	++st->pending;
+	if (!running) {
+		if (thread.joinable()) thread.join();
+		running = true;
+		thread = std::thread (&output_writer::run, this);
+	}
+	else {
+		queued.notify_one();
+	}
+}
+
+/* Wait for completion
+   output_writer::wait
+************************************************************************/
+void output_writer::wait (const output_file_state* st)
+{
+	std::unique_lock<std::mutex> lock (mux);
+	written.wait (lock, [this, st]() { 
+		return st ? (st->pending == 0) : !running; });
+}
+
+/* Thread function
+   output_writer::run
+************************************************************************/
+void output_writer::run()
+{
+	std::unique_lock<std::mutex> lock (mux);
+	while (!queue.empty()) {
+		job j = std::move (queue.front());
+		queue.pop_front();
+		lock.unlock();
+		try {
+			write (*j.state, j.data);
+			if (j.last) finish (*j.state);
+		}
+		catch (...) {
+			;
+		}
+		j.data.clear();
+		lock.lock();
+		--j.state->pending;
+		j.state.reset();
+		written.notify_all();
+		// give the producer a chance to fill the queue before exiting
+		if (queue.empty()) {
+			queued.wait_for (lock, std::chrono::milliseconds (50));
 		}
-		// replace dots with underscore
-		while ((pos = n.find ('.')) != stringcase::npos) {
-			n[pos] = '_';
+	}
+	running = false;
+	written.notify_all();
+}
+
+/* Switch from comparing to writing
+   output_writer::start_writing
+************************************************************************/
+bool output_writer::start_writing (output_file_state& st)
+{
+	// write into a temporary file and copy the identical part
+	st.tmpname = st.filename + ".tmp";
+	if (fopen_s (&st.out, st.tmpname.c_str(), "w")) {
+		fprintf (stderr, "Failed to open output %s.\n", st.tmpname.c_str());
+		st.out = nullptr;
+		return false;
+	}
+	fseek (st.orig, 0L, SEEK_SET);
+	std::vector<char> buf (output_file::buffer_size);
+	size_t left = st.same;
+	while (left > 0) {
+		const size_t n = fread (buf.data(), 1, std::min (left, buf.size()), st.orig);
+		if (n == 0) break;
+		fwrite (buf.data(), 1, n, st.out);
+		left -= n;
+	}
+	return true;
+}
+
+/* Write a buffer
+   output_writer::write
+************************************************************************/
+void output_writer::write (output_file_state& st, const std::string& data)
+{
+	if (data.empty()) {
+		return;
+	}
+	// console
+	if (st.filename.empty()) {
+		fwrite (data.data(), 1, data.size(), stdout);
+		fflush (stdout);
+		return;
+	}
+	// still identical to the existing file?
+	if (st.orig && !st.out) {
+		std::string old (data.size(), 0);
+		const size_t n = fread (&old[0], 1, data.size(), st.orig);
+		if ((n == data.size()) && (old == data)) {
+			st.same += n;
+			return;
 		}
-		break;
-		// replace all dots with underscores
-	case tc_epics_conv::no_dot:
-		while ((pos = n.find ('.')) != stringcase::npos) {
-			n[pos] = '_';
+		if (!start_writing (st)) {
+			return;
 		}
-		break;
-		// do nothing
-	case tc_epics_conv::no_conversion:
-	default:
-		break;
 	}
-	// force case if necessary
-	if (case_epics_names != case_type::preserve) {
-		for (pos = 0; pos < n.size(); ++pos) {
-			n[pos] = (case_epics_names == case_type::upper) ? toupper (n[pos]) : tolower (n[pos]);
-		}
+	if (st.out) {
+		fwrite (data.data(), 1, data.size(), st.out);
+		fflush (st.out);
 	}
-	// replace array brackets with underscore if necessary
-	if (no_array_index) {
-		while ((pos = n.find ('[')) != stringcase::npos) {
-			n[pos] = '_';
+}
+
+/* Finish writing a file
+   output_writer::finish
+************************************************************************/
+void output_writer::finish (output_file_state& st)
+{
+	if (st.filename.empty()) {
+		return;
+	}
+	// existing file is longer than the new content
+	if (st.orig && !st.out && (fgetc (st.orig) != EOF)) {
+		start_writing (st);
+	}
+	if (st.orig) fclose (st.orig);
+	st.orig = nullptr;
+	if (st.out) fclose (st.out);
+	st.out = nullptr;
+	// replace the existing file
+	if (!st.tmpname.empty()) {
+		std::error_code ec;
+		rename (path (st.tmpname), path (st.filename), ec);
+		if (ec) {
+			fprintf (stderr, "Failed to write output %s.\n", st.filename.c_str());
 		}
-		while ((pos = n.find (']')) != stringcase::npos) {
-			n.erase (pos, 1);
+	}
+}
+
+/* Open a file
+   output_file::open
+************************************************************************/
+bool output_file::open (const std::stringcase& fname)
+{
+	close();
+	auto st = std::make_shared<output_file_state>();
+	st->filename = fname.c_str();
+	// compare with the existing file, otherwise write directly
+	if (!fname.empty() && 
+		(fopen_s (&st->orig, fname.c_str(), "r") || !st->orig)) {
+		st->orig = nullptr;
+		if (fopen_s (&st->out, fname.c_str(), "w") || !st->out) {
+			return false;
 		}
 	}
-	
-	// add prefix after replacement list
-	n = get_prefix() + n;
+	filename = fname;
+	state = st;
+	buffer.reserve (buffer_size);
+	return true;
+}
+
+/* Close a file
+   output_file::close
+************************************************************************/
+void output_file::close (bool wait) noexcept
+{
+	if (!state) {
+		return;
+	}
+	try {
+		submit (true);
+		if (wait) output_writer::get().wait (state.get());
+	}
+	catch (...) {
+		;
+	}
+	state.reset();
+	filename.clear();
+}
+
+/* Flush a file
+   output_file::flush
+************************************************************************/
+void output_file::flush() noexcept
+{
+	if (!state) {
+		return;
+	}
+	try {
+		submit (false);
+		output_writer::get().wait (state.get());
+	}
+	catch (...) {
+		;
+	}
+}
 
-	return string (n.c_str());
+/* Wait for all files
+   output_file::sync
+************************************************************************/
+void output_file::sync() noexcept
+{
+	try {
+		output_writer::get().wait();
+	}
+	catch (...) {
+		;
+	}
+}
+
+/* Pass the buffer on to the writer
+   output_file::submit
+************************************************************************/
+void output_file::submit (bool last)
+{
+	if (buffer.empty() && !last) {
+		return;
+	}
+	std::string data;
+	data.swap (buffer);
+	output_writer::get().push (state, std::move (data), last);
+	if (!last) buffer.reserve (buffer_size);
+}
+
+/* Formatted output
+   output_file::printf
+************************************************************************/
+int output_file::printf (const char* format, ...)
+{
+	char buf[1024];
+	va_list ap;
+	va_start (ap, format);
+	int n = vsnprintf (buf, sizeof (buf), format, ap);
+	va_end (ap);
+	if (n < 0) {
+		return n;
+	}
+	if (n < (int)sizeof (buf)) {
+		write (buf, n);
+		return n;
+	}
+	std::string s (n + 1, 0);
+	va_start (ap, format);
+	n = vsnprintf (&s[0], s.size(), format, ap);
+	va_end (ap);
+	if (n >= 0) write (s.data(), n);
+	return n;
+}
+
+/* Write a string
+   output_file::write
+************************************************************************/
+void output_file::write (const char* data, size_t len)
+{
+	if (!state) {
+		return;
+	}
+	buffer.append (data, len);
+	if (buffer.size() >= buffer_size) {
+		submit (false);
+	}
 }
 
 
@@ -256,8 +615,8 @@ split_io_support::~split_io_support()
 split_io_support::~split_io_support
 ************************************************************************/
 split_io_support::split_io_support (const split_io_support& iosup)
-	: error(true), split_io(false), split_n(0), outf(0), 
-	outf_in(nullptr), outf_io(nullptr), rec_num(0), rec_num_in(0), 
+	: error(true), split_io(false), split_n(0), outf(nullptr), 
+	rec_num(0), rec_num_in(0), 
 	rec_num_io(0), file_num_in(1), file_num_io(1)
 {
 	*this = iosup;
@@ -271,6 +630,7 @@ split_io_support& split_io_support::operator= (const split_io_support& iosup)
 	close();
 	error = iosup.error;
 	outfilename = iosup.outfilename;
+	outfilenames = iosup.outfilenames;
 	split_io = iosup.split_io;
 	split_n = iosup.split_n;
 	rec_num = iosup.rec_num;
@@ -283,11 +643,9 @@ split_io_support& split_io_support::operator= (const split_io_support& iosup)
 	file_in_s = iosup.file_in_s;
 	file_io_s = iosup.file_io_s;
 	outf = iosup.outf;
-	outf_in = iosup.outf_in;
-	outf_io = iosup.outf_io;
+	outf_in = std::move (iosup.outf_in);
+	outf_io = std::move (iosup.outf_io);
 	iosup.outf = nullptr;
-	iosup.outf_in = nullptr;
-	iosup.outf_io = nullptr;
 	return *this;
 }
 
@@ -343,6 +701,7 @@ void split_io_support::set_filename (const stringcase& fn)
 {
 	close();
 	outfilename = fn;
+	outfilenames.clear();
 	// check for non-empty (no stdout) filename
 	if (!outfilename.empty()) {
 		if (split_io || (split_n > 0)) {
@@ -361,28 +720,34 @@ void split_io_support::set_filename (const stringcase& fn)
 				file_io_s = ".io";
 			}
 			stringcase fname (outfilename + file_io_s + file_num_io_s + ".db");
-			if (fopen_s(&outf_io, fname.c_str(), "w")) {
+			outf_io = std::make_unique<output_file>();
+			if (!outf_io->open (fname)) {
 				fprintf (stderr, "Failed to open output %s.\n", fname.c_str());
 				error = true;
 				return;
 			}
-			outf = outf_io;
+			outf = outf_io.get();
+			outfilenames.push_back (fname);
 			if (split_io) {
 				fname = outfilename + file_in_s + file_num_in_s + ".db";
-				if (fopen_s(&outf_in, fname.c_str(), "w")) {
+				outf_in = std::make_unique<output_file>();
+				if (!outf_in->open (fname)) {
 					fprintf (stderr, "Failed to open output %s.\n", fname.c_str());
 					error = true;
 					return;
 				}
+				outfilenames.push_back (fname);
 			}
 		}
 		else {
-			if (fopen_s(&outf_io, outfilename.c_str(), "w")) {
+			outf_io = std::make_unique<output_file>();
+			if (!outf_io->open (outfilename)) {
 				fprintf (stderr, "Failed to open output %s.\n", outfilename.c_str());
 				error = true;
 				return;
 			}
-			outf = outf_io;
+			outf = outf_io.get();
+			outfilenames.push_back (outfilename);
 		}
 	}
 
@@ -393,8 +758,23 @@ void split_io_support::set_filename (const stringcase& fn)
 			error = true;
 			return;
 		}
-		outf = stdout;
+		outf = nullptr;
+	}
+}
+
+/* Get the output file
+   split_io_support::get_file
+************************************************************************/
+output_file* split_io_support::get_file() const
+{
+	// console
+	if (!outf) {
+		if (!outf_io) {
+			outf_io = std::make_unique<output_file>(std::stringcase());
+		}
+		outf = outf_io.get();
 	}
+	return outf;
 }
 
 /* Flush file content
@@ -402,8 +782,8 @@ void split_io_support::set_filename (const stringcase& fn)
 ************************************************************************/
 void split_io_support::flush() noexcept
 {
-	if (outf_io) fflush (outf_io);
-	if (outf_in) fflush (outf_in);
+	if (outf_io) outf_io->flush();
+	if (outf_in) outf_in->flush();
 }
 
 /* Closes files
@@ -411,10 +791,11 @@ void split_io_support::flush() noexcept
 ************************************************************************/
 void split_io_support::close() noexcept
 {
-	if (outf_io) fclose (outf_io);
-	outf_io = nullptr;
-	if (outf_in) fclose (outf_in);
-	outf_in = nullptr;
+	if (outf_io) outf_io->close (true);
+	outf_io.reset();
+	if (outf_in) outf_in->close (true);
+	outf_in.reset();
+	outf = nullptr;
 }
 
 /* Increment record  number
@@ -431,12 +812,14 @@ bool split_io_support::increment (bool readonly)
 					char buf[20];
 					sprintf_s (buf, sizeof(buf), ".%03i", file_num_in);
 					file_num_in_s = buf;
-					fclose (outf_in);
 					stringcase fname = outfilename + file_in_s + file_num_in_s + ".db";
-					if (fopen_s(&outf_in, fname.c_str(), "w")) {
+					if (!outf_in->open (fname)) {
 						fprintf (stderr, "Failed to open output %s.\n", fname.c_str());
 						error = true;
 					}
+					else {
+						outfilenames.push_back (fname);
+					}
 				}
 			}
 			else {
@@ -445,12 +828,14 @@ bool split_io_support::increment (bool readonly)
 					char buf[20];
 					sprintf_s (buf, sizeof(buf), ".%03i", file_num_io);
 					file_num_io_s = buf;
-					fclose (outf_io);
 					stringcase fname (outfilename + file_io_s + file_num_io_s + ".db");
-					if (fopen_s(&outf_io, fname.c_str(), "w")) {
+					if (!outf_io->open (fname)) {
 						fprintf (stderr, "Failed to open output %s.\n", fname.c_str());
 						error = true;
 					}
+					else {
+						outfilenames.push_back (fname);
+					}
 				}
 			}
 		}
@@ -461,20 +846,22 @@ bool split_io_support::increment (bool readonly)
 				char buf[20];
 				snprintf (buf, sizeof (buf), ".%03i", file_num_io);
 				file_num_io_s = buf;
-				fclose (outf_io);
 				stringcase fname (outfilename + file_io_s + file_num_io_s + ".db");
-				if (fopen_s(&outf_io, fname.c_str(), "w")) {
+				if (!outf_io->open (fname)) {
 					fprintf (stderr, "Failed to open output %s.\n", fname.c_str());
 					error = true;
 				}
+				else {
+					outfilenames.push_back (fname);
+				}
 			}
 		}
 	}
 	// set up output file
-	if (split_io && readonly) outf = outf_in;
-	else if (!outfilename.empty()) outf = outf_io;
-	if (!outf) {
-		outf = stdout;
+	if (split_io && readonly) outf = outf_in.get();
+	else if (!outfilename.empty()) outf = outf_io.get();
+	if (!outf || !outf->is_open()) {
+		outf = nullptr;
 		error = true;
 	}
 	// increase record number
@@ -514,7 +901,9 @@ bool multi_io_support::open (const std::stringcase& fname,
 	path newfile ((filestat == io_filestat::read ? indirname : outdirname).c_str());
 	newfile /= fname.c_str();
 	FILE* fio = nullptr;
-	if (fopen_s(&fio, newfile.string().c_str(), io.c_str())) {
+	if ((filestat == io_filestat::read) ? 
+		(fopen_s(&fio, newfile.string().c_str(), io.c_str()) != 0) :
+		!outfile.open (newfile.string().c_str())) {
 		filestat = io_filestat::closed;
 		if (!superrmsg) {
 			fprintf (stderr, "Failed to open %s.\n", newfile.string().c_str());
@@ -542,9 +931,27 @@ void multi_io_support::close() noexcept
 {
 	if (filehandle) fclose (filehandle);
 	filehandle = 0;
+	outfile.close();
 	filestat = io_filestat::closed;
 }
 
+/* Copy assignment
+   multi_io_support::operator=
+************************************************************************/
+multi_io_support& multi_io_support::operator= (const multi_io_support& iosup)
+{
+	if (this == &iosup) {
+		return *this;
+	}
+	close();
+	outdirname = iosup.outdirname;
+	indirname = iosup.indirname;
+	filename.clear();
+	file_num_in = iosup.file_num_in;
+	file_num_out = iosup.file_num_out;
+	return *this;
+}
+
 /* Set input directory name
    multi_io_support::set_indirname
 ************************************************************************/
@@ -573,6 +980,185 @@ void multi_io_support::set_outdirname (const std::stringcase& dname)
 }
 
 
+/* File extension of manifests
+   generation_manifest::extension
+************************************************************************/
+const char* const generation_manifest::extension = ".manifest";
+
+/* Read a manifest
+   generation_manifest::read
+************************************************************************/
+bool generation_manifest::read (const std::stringcase& fname)
+{
+	filename = fname;
+	outputs.clear();
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, fname.c_str(), "r") || !fp) {
+		return false;
+	}
+	// lines are "output <key> <name>" followed by "file <hash> <name>"
+	char line[4096];
+	output_entry* entry = nullptr;
+	while (fgets (line, sizeof (line), fp)) {
+		std::stringcase l (line);
+		while (!l.empty() && isspace ((unsigned char)l.back())) l.pop_back();
+		const auto p1 = l.find (' ');
+		const auto p2 = (p1 == stringcase::npos) ? p1 : l.find (' ', p1 + 1);
+		if (p2 == stringcase::npos) {
+			continue;
+		}
+		const stringcase tag = l.substr (0, p1);
+		const hash_type h = strtoull (l.substr (p1 + 1, p2 - p1 - 1).c_str(), nullptr, 16);
+		const stringcase name = l.substr (p2 + 1);
+		if (tag == "output") {
+			entry = &outputs[name];
+			entry->key = h;
+			entry->files.clear();
+		}
+		else if ((tag == "file") && entry) {
+			entry->files.push_back (std::make_pair (name, h));
+		}
+	}
+	fclose (fp);
+	return true;
+}
+
+/* Write a manifest
+   generation_manifest::write
+************************************************************************/
+bool generation_manifest::write() const
+{
+	FILE* fp = nullptr;
+	if (filename.empty() || fopen_s (&fp, filename.c_str(), "w") || !fp) {
+		return false;
+	}
+	for (const auto& o : outputs) {
+		if (!o.second.used) continue;
+		fprintf (fp, "output %016llx %s\n", o.second.key, o.first.c_str());
+		for (const auto& f : o.second.files) {
+			fprintf (fp, "file %016llx %s\n", f.second, f.first.c_str());
+		}
+	}
+	const bool succ = (ferror (fp) == 0);
+	fclose (fp);
+	return succ;
+}
+
+/* Check an output
+   generation_manifest::is_current
+************************************************************************/
+bool generation_manifest::is_current (const std::stringcase& name, hash_type key)
+{
+	auto o = outputs.find (name);
+	if ((o == outputs.end()) || (o->second.key != key)) {
+		return false;
+	}
+	for (const auto& f : o->second.files) {
+		if (hash_file (f.first) != f.second) {
+			return false;
+		}
+	}
+	o->second.used = true;
+	return true;
+}
+
+/* Record an output
+   generation_manifest::set_output
+************************************************************************/
+void generation_manifest::set_output (const std::stringcase& name, hash_type key,
+									  const std::vector<std::stringcase>& files)
+{
+	output_entry& entry = outputs[name];
+	entry.key = key;
+	entry.used = true;
+	entry.files.clear();
+	for (const auto& f : files) {
+		entry.files.push_back (std::make_pair (f, hash_file (f)));
+	}
+}
+
+/* Hash memory
+   generation_manifest::hash_bytes
+************************************************************************/
+generation_manifest::hash_type generation_manifest::hash_bytes (
+	const void* data, size_t len, hash_type h) noexcept
+{
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < len; ++i) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/* Hash a file
+   generation_manifest::hash_file
+************************************************************************/
+generation_manifest::hash_type generation_manifest::hash_file (
+	const std::stringcase& fname, hash_type h)
+{
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, fname.c_str(), "rb") || !fp) {
+		return 0;
+	}
+	std::vector<char> buf (output_file::buffer_size);
+	size_t n = 0;
+	while ((n = fread (buf.data(), 1, buf.size(), fp)) > 0) {
+		h = hash_bytes (buf.data(), n, h);
+	}
+	fclose (fp);
+	return h ? h : 1;
+}
+
+/* Hash replacement rules
+   generation_manifest::hash_rules
+************************************************************************/
+generation_manifest::hash_type generation_manifest::hash_rules (
+	const ParseUtil::replacement_rules& rules, hash_type h)
+{
+	for (const auto& r : rules.get_rule_table()) {
+		h = hash (r.second, hash (r.first, h));
+	}
+	const char rec = rules.is_recursive() ? 1 : 0;
+	return hash_bytes (&rec, 1, h);
+}
+
+/* Hash the generator version
+   generation_manifest::hash_version
+************************************************************************/
+generation_manifest::hash_type generation_manifest::hash_version (hash_type h) noexcept
+{
+	h = hash_bytes (&svn_revision, sizeof (svn_revision), h);
+	return hash_bytes (svn_time_now, strlen (svn_time_now), h);
+}
+
+/* List output files
+   generation_manifest::list_files
+************************************************************************/
+std::vector<std::stringcase> generation_manifest::list_files (const std::stringcase& name)
+{
+	std::vector<std::stringcase> files;
+	std::error_code ec;
+	const path p (name.c_str());
+	if (is_directory (p, ec)) {
+		for (const auto& e : directory_iterator (p, ec)) {
+			if (!e.is_regular_file (ec)) continue;
+			const std::stringcase f (e.path().string().c_str());
+			if ((f.size() >= strlen (extension)) && 
+				(f.compare (f.size() - strlen (extension), stringcase::npos, extension) == 0)) {
+				continue;
+			}
+			files.push_back (f);
+		}
+		std::sort (files.begin(), files.end());
+	}
+	else if (exists (p, ec)) {
+		files.push_back (name);
+	}
+	return files;
+}
+
+
 /* Option processing
    epics_list_processing::epics_list_processing
 ************************************************************************/
@@ -652,6 +1238,11 @@ bool epics_list_processing::operator() (const process_arg& arg)
 	if (!arg.is_atomic() && (listing != listing_type::standard)) {
 		return false;
 	}
+	// the DAQ does not support arrays
+	if ((listing == listing_type::daqini) && 
+		(arg.get_process_type() == process_type_enum::pt_array)) {
+		return false;
+	}
 
 	// write record information to output file
 	// produce a listing
@@ -668,7 +1259,7 @@ bool epics_list_processing::operator() (const process_arg& arg)
 	// autoburt
 	if (listing == listing_type::autoburt) {
 		stringcase ro = opc->is_readonly() ? "RO " : "";
-		fprintf (get_file(), "%s%s", ro.c_str(), epicsname.c_str());
+		get_file()->printf ("%s%s", ro.c_str(), epicsname.c_str());
 	}
 	// LIGO DAQ ini listing
 	else if (listing == listing_type::daqini) {
@@ -717,13 +1308,13 @@ bool epics_list_processing::operator() (const process_arg& arg)
 		}
 		// write header 
 		if (get_processed_total() == 1) {
-			fprintf(get_file(), LIGODAQ_INI_HEADER, LIGODAQ_DATATYPE_DEFAULT, LIGODAQ_UNIT_DEFAULT);
-			fprintf(get_file(), "\n\n");
+			get_file()->printf (LIGODAQ_INI_HEADER, LIGODAQ_DATATYPE_DEFAULT, LIGODAQ_UNIT_DEFAULT);
+			get_file()->printf ("\n\n");
 		}
 		// write entry for channel
-		fprintf(get_file(), "[%s]", epicsname.c_str());
+		get_file()->printf ("[%s]", epicsname.c_str());
 		if (datatype != LIGODAQ_DATATYPE_DEFAULT) {
-			fprintf(get_file(), "\n%s=%i", LIGODAQ_DATATYPE_NAME, datatype);
+			get_file()->printf ("\n%s=%i", LIGODAQ_DATATYPE_NAME, datatype);
 		}
 		s = unit;
 		unit = "";
@@ -734,26 +1325,26 @@ bool epics_list_processing::operator() (const process_arg& arg)
 			}
 		}
 		if (unit != LIGODAQ_UNIT_DEFAULT) {
-			fprintf(get_file(), "\n%s=%s", LIGODAQ_UNIT_NAME, unit.c_str());
+			get_file()->printf ("\n%s=%s", LIGODAQ_UNIT_NAME, unit.c_str());
 		}
 	}
 	// standard listing
 	else {
-		fprintf (get_file(), "%s", epicsname.c_str());
+		get_file()->printf ("%s", epicsname.c_str());
 	}
 
 	// long listing?
 	if (verbose && (listing != listing_type::autoburt) && (listing != listing_type::daqini)) {
-		fprintf (get_file(), " (%s", arg.get_process_string().c_str());
-		fprintf (get_file(), ", opc %c", opc->is_published() ? '1' : '0');
+		get_file()->printf (" (%s", arg.get_process_string().c_str());
+		get_file()->printf (", opc %c", opc->is_published() ? '1' : '0');
 		for (const auto& i : opc->get_properties()) {
 				stringcase s = i.second;
 				trim_space (s);
-				fprintf (get_file(), ", prop[%i]=\"%s\"", i.first, s.c_str());
+				get_file()->printf (", prop[%i]=\"%s\"", i.first, s.c_str());
 		}
-		fprintf (get_file(), ")");
+		get_file()->printf (")");
 	}
-	fprintf (get_file(), "\n");
+	get_file()->printf ("\n");
 	return true;
 }
 
@@ -781,6 +1372,7 @@ void epics_macrofiles_processing::flush() noexcept
 			process_record(procstack.top());
 			procstack.pop();
 		}
+		output_file::sync();
 		fflush(stderr);
 	}
 	catch (...) {
@@ -972,6 +1564,95 @@ const std::regex epics_macrofiles_processing::errormatchregex31 (
 	"[^:]*:\\s*ErrorMessagesArray\\s*:=\\s*\\[\\s*([^\\]]*)\\]\\s*;[^;]*", 
 	std::regex_constants::icase);
 
+/* Error list files
+   epics_macrofiles_processing::get_errorlist_files()
+************************************************************************/
+std::vector<std::stringcase> epics_macrofiles_processing::get_errorlist_files () const
+{
+	std::vector<std::stringcase> files;
+	for (const auto& e : errorlists) {
+		path fpath (get_indirname().c_str());
+		fpath /= e.first.c_str();
+		files.push_back (fpath.string().c_str());
+	}
+	std::sort (files.begin(), files.end());
+	return files;
+}
+
+/* Read a list of error messages
+   epics_macrofiles_processing::read_error_list()
+************************************************************************/
+std::shared_ptr<const error_list> 
+epics_macrofiles_processing::read_error_list (const std::stringcase& fname)
+{
+	// unescape patterns for error messages
+	static const std::regex ctrlregex ("\\$([LlNnPpRr]|\\d\\d?)");
+	static const std::regex escregex ("\\$([\\$'])");
+	static const std::regex tabregex ("\\$([tT])");
+
+	// check the modification time against the cached list
+	path fpath (get_indirname().c_str());
+	fpath /= fname.c_str();
+	std::error_code ec;
+	const file_time_type mtime = last_write_time (fpath, ec);
+	if (ec) {
+		return nullptr;
+	}
+	const auto cached = errorlists.find (fname);
+	if ((cached != errorlists.end()) && (cached->second.mtime == mtime)) {
+		return cached->second.messages;
+	}
+	if (!open (fname, "r", true)) {
+		return nullptr;
+	}
+
+	// read file with list of error messages
+	auto errlist = std::make_shared<error_list>();
+	FILE* fp = get_input();
+	fseek (fp, 0L, SEEK_END);
+	size_t sz = ftell (fp);
+	fseek (fp, 0L, SEEK_SET);
+	if (sz > 1000000) sz = 1000000; // let's not get too crazy
+	std::unique_ptr<unsigned char[]> buf = std::make_unique<unsigned char[]>(sz + 1);
+	sz = fread (buf.get(), sizeof (char), sz, fp);
+	buf[sz] = 0;
+	for (size_t i = 0; i < sz; ++i) {
+		if (isspace (buf[i])) buf[i] = ' '; // get rid of LF/CR
+	}
+	// check if it is formatted correctly
+	std::cmatch match;
+	if (std::regex_match ((const char*)buf.get(), (const char*)buf.get()+sz, match, 
+		isTwinCAT3 ? errormatchregex31 : errormatchregex2)) {
+		for (auto i = ++match.begin(); i != match.end(); ++i) {
+			std::string found = i->str();
+			// search and iterate over single quote strings
+			std::regex_iterator<std::string::iterator> rit 
+				(found.begin(), found.end(), errorsearchregex);
+			std::regex_iterator<std::string::iterator> rend;
+			while (rit != rend) {
+				// found one
+				std::stringcase msg = rit->str().c_str();
+				// trim single quotes
+				msg.erase (0, 1);
+				msg.erase (msg.length()-1, 1);
+				// trim control characters
+				msg = std::regex_replace (msg, ctrlregex, "");
+				// unescape $' and $$
+				msg = std::regex_replace (msg, escregex, "$1");
+				// unesacpe $t
+				msg = std::regex_replace (msg, tabregex, " ");
+				//printf ("found an error message `%s`\n", msg.c_str());
+				errlist->push_back (msg);
+				++rit;
+			}
+		}
+	}
+	close();
+
+	errorlists[fname] = error_list_entry{ mtime, errlist };
+	return errlist;
+}
+
 /* Process a record
    epics_macrofiles_processing::process_record()
 ************************************************************************/
@@ -989,11 +1670,10 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 
 	// Check if we need to read a _Errors.exp file containing a list of 
 	// error messages
-	std::vector<std::stringcase> errlist;
+	std::shared_ptr<const error_list> errlist;
 	if (mrec.haserror && 
 		((get_macrofile_type() == macrofile_type::all) ||
 		(get_macrofile_type() == macrofile_type::errors))) {
-		bool succ = false;
 		std::stringcase fname;
 		if (isTwinCAT3) {
 			fname = "";
@@ -1004,81 +1684,27 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 			else {
 				fname += mrec.record.type_n.substr(pos+1) + errorlistext31;
 			}
-			succ = open (fname, "r", true);
-			// check if we have a field name
-			if (!succ && !get_plcname().empty() &&
-				mrec.record.name.rfind (get_plcname()) == 
-				mrec.record.name.length() - get_plcname().length()) {
-				const std::stringcase::size_type pos2 = fname.rfind ("Struct");
-				if (pos2 != stringcase::npos) {
-					fname.insert (pos2, get_plcname(), 0, 1);
-				}
-				succ = open (fname, "r", true);
-			}
 		}
 		else {
 			fname = mrec.record.type_n + errorlistext2;
-			succ = open (fname, "r", true);
-			// check if we have a field name
-			if (!succ && !get_plcname().empty() &&
-				mrec.record.name.rfind (get_plcname()) == 
-					mrec.record.name.length() - get_plcname().length()) {
-				const std::stringcase::size_type pos2 = fname.rfind ("Struct");
-				if (pos2 != stringcase::npos) {
-					fname.insert (pos2, get_plcname(), 0, 1);
-				}
-				succ = open (fname, "r", true);
+		}
+		errlist = read_error_list (fname);
+		// check if we have a field name
+		if (!errlist && !get_plcname().empty() &&
+			mrec.record.name.rfind (get_plcname()) == 
+			mrec.record.name.length() - get_plcname().length()) {
+			const std::stringcase::size_type pos2 = fname.rfind ("Struct");
+			if (pos2 != stringcase::npos) {
+				fname.insert (pos2, get_plcname(), 0, 1);
 			}
+			errlist = read_error_list (fname);
 		}
-		if (!succ) {
+		if (!errlist) {
 			if (missing.find (fname) == missing.end()) {
 				missing.insert (fname);
 				fprintf (stderr, "Cannot open %s\n", fname.c_str());
 			}
 		}
-		else {
-			// read file with list of error messages
-			FILE* fp = get_file();
-			fseek (fp, 0L, SEEK_END);
-			size_t sz = ftell (fp);
-			fseek (fp, 0L, SEEK_SET);
-			if (sz > 1000000) sz = 1000000; // let's not get too crazy
-			std::unique_ptr<unsigned char[]> buf = std::make_unique<unsigned char[]>(sz + 1);
-			sz = fread (buf.get(), sizeof (char), sz, fp);
-			buf[sz] = 0;
-			for (size_t i = 0; i < sz; ++i) {
-				if (isspace (buf[i])) buf[i] = ' '; // get rid of LF/CR
-			}
-			// check if it is formatted correctly
-			std::cmatch match;
-			if (std::regex_match ((const char*)buf.get(), (const char*)buf.get()+sz, match, 
-				isTwinCAT3 ? errormatchregex31 : errormatchregex2)) {
-				for (auto i = ++match.begin(); i != match.end(); ++i) {
-					std::string found = i->str();
-					// search and iterate over single quote strings
-					std::regex_iterator<std::string::iterator> rit 
-						(found.begin(), found.end(), errorsearchregex);
-					std::regex_iterator<std::string::iterator> rend;
-					while (rit != rend) {
-						// found one
-						std::stringcase msg = rit->str().c_str();
-						// trim single quotes
-						msg.erase (0, 1);
-						msg.erase (msg.length()-1, 1);
-						// trim control characters
-						msg = std::regex_replace (msg, std::regex ("\\$([LlNnPpRr]|\\d\\d?)"), "");
-						// unescape $' and $$
-						msg = std::regex_replace (msg, std::regex ("\\$([\\$'])"), "$1");
-						// unesacpe $t
-						msg = std::regex_replace (msg, std::regex ("\\$([tT])"), " ");
-						//printf ("found an error message `%s`\n", msg.c_str());
-						errlist.push_back (msg);
-						++rit;
-					}
-				}
-			}
-			close();
-		}
 	}
 
 	// open output file
@@ -1088,14 +1714,14 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 	}
 
 	// write output file
-	FILE* fp = get_file();
+	output_file* fp = get_file();
 	if (get_plcname().empty()) {
-		fprintf (fp, "PLC=Unknown\n");
+		fp->printf ("PLC=Unknown\n");
 	}
 	else {
-		fprintf (fp, "PLC=%s,\n", get_plcname().c_str());
+		fp->printf ("PLC=%s,\n", get_plcname().c_str());
 	}
-	fprintf (fp, "CHN=%s,\n", mrec.record.name.c_str());
+	fp->printf ("CHN=%s,\n", mrec.record.name.c_str());
 
 	// get ifo
 	const auto colon = mrec.record.name.find (':');
@@ -1133,34 +1759,36 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 			sys = "";
 		}
 	}
-	fprintf (fp, "IFO=%s,\n", ifo.c_str());
+	fp->printf ("IFO=%s,\n", ifo.c_str());
 	std::stringcase lifo = ifo;
 	for (unsigned int i = 0; i < lifo.length(); ++i) lifo[i] = tolower (lifo[i]);
-	fprintf (fp, "ifo=%s,\n", lifo.c_str());
-	fprintf (fp, "SYS=%s,\n", sys.c_str());
-	fprintf (fp, "SUB=%s,\n", sub.c_str());
-	fprintf (fp, "LVL=%i,\n", level);
+	fp->printf ("ifo=%s,\n", lifo.c_str());
+	fp->printf ("SYS=%s,\n", sys.c_str());
+	fp->printf ("SUB=%s,\n", sub.c_str());
+	fp->printf ("LVL=%i,\n", level);
 
 	// screen names
-	fprintf (fp, "itself=%s,\n", to_filename (mrec.record.name).c_str());
-	fprintf (fp, "related=%s,\n", to_filename (mrec.record.name).c_str());
-	fprintf (fp, "back=%s,\n", to_filename (mrec.back.name).c_str());
+	fp->printf ("itself=%s,\n", to_filename (mrec.record.name).c_str());
+	fp->printf ("related=%s,\n", to_filename (mrec.record.name).c_str());
+	fp->printf ("back=%s,\n", to_filename (mrec.back.name).c_str());
 	// write has errors
-	fprintf (fp, "haserrors=%i,\n", mrec.haserror ? 1 : 0);
+	fp->printf ("haserrors=%i,\n", mrec.haserror ? 1 : 0);
 	if (mrec.haserror && (mrec.erroridx >= 0) && (mrec.erroridx < std::ssize(mrec.fields))) {
-		fprintf (fp, "errfld=%s,\n", mrec.fields[mrec.erroridx].name.c_str());
+		fp->printf ("errfld=%s,\n", mrec.fields[mrec.erroridx].name.c_str());
 	}
 	else {
-		fprintf (fp, "errfld=,\n");
+		fp->printf ("errfld=,\n");
 	}
 
 	// Error messages
 	if ((get_macrofile_type() == macrofile_type::all) || 
 		(get_macrofile_type() == macrofile_type::errors)) {
 		int num = 0;
-		for (auto i = errlist.begin(); (i != errlist.end()) && (num < 32); ++i, ++num) {
+		const error_list empty;
+		const error_list& msgs = errlist ? *errlist : empty;
+		for (auto i = msgs.begin(); (i != msgs.end()) && (num < 32); ++i, ++num) {
 			// write error message
-			fprintf (fp, "err%i=\"%s\",\n", num, i->c_str());
+			fp->printf ("err%i=\"%s\",\n", num, i->c_str());
 			// check if we have a field name
 			if (!get_plcname().empty() &&
 				mrec.record.name.rfind (get_plcname()) == 
@@ -1177,7 +1805,7 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 					}
 				}
 				if (issuberr) {
-					fprintf (fp, "nxt%i=%s,\n", num, suberr.c_str());
+					fp->printf ("nxt%i=%s,\n", num, suberr.c_str());
 				}
 			}
 			else {
@@ -1199,12 +1827,12 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 					//}
 				}
 				if (pinfo) {
-					fprintf (fp, "nxt%i=%s,\n", num, to_filename (pinfo->name).c_str());
+					fp->printf ("nxt%i=%s,\n", num, to_filename (pinfo->name).c_str());
 				}
 			}
 		}
 		// write list length
-		fprintf (fp, "errors=%i,\n", num);
+		fp->printf ("errors=%i,\n", num);
 	}
 
 	// Fields
@@ -1218,22 +1846,25 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 			// set field type
 			switch (i.ptype) {
 			case process_type_enum::pt_bool:
-				fprintf (fp, "fio%i=%s,\n", num, i.readonly ? "bi" : "bo");
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "bi" : "bo");
 				break;
 			case process_type_enum::pt_enum:
-				fprintf (fp, "fio%i=%s,\n", num, i.readonly ? "mbbi" : "mbbo");
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "mbbi" : "mbbo");
 				break;
 			case process_type_enum::pt_int:
-				fprintf (fp, "fio%i=%s,\n", num, i.readonly ? "longin" : "longout");
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "longin" : "longout");
 				break;
 			case process_type_enum::pt_real:
-				fprintf (fp, "fio%i=%s,\n", num, i.readonly ? "ai" : "ao");
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "ai" : "ao");
 				break;
 			case process_type_enum::pt_string:
-				fprintf (fp, "fio%i=%s,\n", num, i.readonly ? "stringin" : "stringout");
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "stringin" : "stringout");
 				break;
 			case process_type_enum::pt_binary:
-				fprintf (fp, "fio%i=%s,\n", num, "link");
+				fp->printf ("fio%i=%s,\n", num, "link");
+				break;
+			case process_type_enum::pt_array:
+				fp->printf ("fio%i=%s,\n", num, i.readonly ? "waveform" : "aao");
 				break;
 			case process_type_enum::pt_invalid:
 			default:
@@ -1241,14 +1872,14 @@ bool epics_macrofiles_processing::process_record (const macro_record& mrec,
 			}
 			// set field name
 			if (i.ptype == process_type_enum::pt_binary) {
-				fprintf (fp, "fld%i=%s,\n", num, to_filename (i.name).c_str());
+				fp->printf ("fld%i=%s,\n", num, to_filename (i.name).c_str());
 			}
 			else {
-				fprintf (fp, "fld%i=%s,\n", num, i.name.c_str());
+				fp->printf ("fld%i=%s,\n", num, i.name.c_str());
 			}
 			++num;
 		}
-		fprintf (fp, "fields=%i,\n", num);
+		fp->printf ("fields=%i,\n", num);
 	}
 
 	close();
@@ -1338,13 +1969,106 @@ int epics_db_processing::mygetopt (int argc, const char* const argv[],
 	return num;
 }
 
+/** Returns the EPICS field type (FTVL) of an array element
+    @param type_name Name of the PLC element type
+    @return FTVL menu string
+    @brief Array element field type
+ ************************************************************************/
+static const char* get_array_ftvl (const stringcase& type_name) noexcept
+{
+	if ((type_name == "BOOL") || (type_name == "USINT") || (type_name == "BYTE")) {
+		return "UCHAR";
+	}
+	else if (type_name == "SINT") {
+		return "CHAR";
+	}
+	else if (type_name == "INT") {
+		return "SHORT";
+	}
+	else if ((type_name == "UINT") || (type_name == "WORD")) {
+		return "USHORT";
+	}
+	else if (type_name == "DINT") {
+		return "LONG";
+	}
+#if EPICS_VERSION >= 7
+	else if (type_name == "LINT") {
+		return "INT64";
+	}
+	else if ((type_name == "ULINT") || (type_name == "LWORD") || (type_name == "LTIME")) {
+		return "UINT64";
+	}
+#else
+	else if ((type_name == "LINT") || (type_name == "ULINT") || 
+			 (type_name == "LWORD") || (type_name == "LTIME")) {
+		return "DOUBLE";
+	}
+#endif
+	else if (type_name == "REAL") {
+		return "FLOAT";
+	}
+	else if (type_name == "LREAL") {
+		return "DOUBLE";
+	}
+	// DWORD, UDINT, TIME, TOD, DATE, DT
+	else {
+		return "ULONG";
+	}
+}
+
+/* epics_db_processing::set_binary_pattern
+************************************************************************/
+bool epics_db_processing::set_binary_pattern (const std::string& pattern) noexcept
+{
+	binary_enabled = false;
+	if (pattern.empty()) {
+		return true;
+	}
+	try {
+		binary_pattern = std::regex (pattern, std::regex::icase);
+		binary_enabled = true;
+		return true;
+	}
+	catch (...) {
+		return false;
+	}
+}
+
+/** Byte size of a structure, only known for TwinCAT variables
+	@param arg Process argument
+	@return Size in bytes, or 0 if unknown
+	@brief Binary structure size
+************************************************************************/
+static int get_binary_size (const process_arg& arg) noexcept
+{
+	const process_arg_tc* targ = dynamic_cast<const process_arg_tc*>(&arg);
+	return targ ? targ->get_bytesize() : 0;
+}
+
+/* epics_db_processing::is_binary_struct
+************************************************************************/
+bool epics_db_processing::is_binary_struct (const process_arg& arg) const noexcept
+{
+	if (!binary_enabled || (arg.get_process_type() != process_type_enum::pt_binary) ||
+		(get_binary_size (arg) <= 0)) {
+		return false;
+	}
+	try {
+		return std::regex_match (arg.get_name().c_str(), binary_pattern);
+	}
+	catch (...) {
+		return false;
+	}
+}
+
 /* Process a channel
    epics_db_processing::operator()
 ************************************************************************/
 bool epics_db_processing::operator() (const process_arg& arg) noexcept
 {
-	// quit if not atomic
-	if (!arg.is_atomic()) {
+	// quit if not atomic, unless it is a structure exported as a whole
+	const bool isbinary = is_binary_struct (arg);
+	if (!arg.is_atomic() && !isbinary) {
 		return false;
 	}
 
@@ -1370,8 +2094,8 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 			return false;
 		}
 
-		// readonly?
-		const bool readonly = opc->is_readonly();
+		// readonly? binary structures are only read
+		const bool readonly = opc->is_readonly() || isbinary;
 		increment(readonly);
 
 		// default process type conversion
@@ -1410,6 +2134,12 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 		case process_type_enum::pt_enum:
 			tname = readonly ? "mbbi" : "mbbo";
 			break;
+		case process_type_enum::pt_array:
+			tname = readonly ? "waveform" : "aao";
+			break;
+		case process_type_enum::pt_binary:
+			tname = "waveform";
+			break;
 		default:
 			fprintf(stderr, "Unknown type %s for %s\n",
 				arg.get_type_name().c_str(), arg.get_name().c_str());
@@ -1421,7 +2151,7 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 			tname = s;
 		}
 
-		fprintf(get_file(), "record(%s,\"%s\") {\n", tname.c_str(), epicsname.c_str());
+		get_file()->printf ("record(%s,\"%s\") {\n", tname.c_str(), epicsname.c_str());
 
 		// string size for lsi/lso
 		if ((tname == "lsi") || (tname == "lso")) {
@@ -1429,6 +2159,17 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 			if (len > MAX_EPICS_LONGSTRING) len = MAX_EPICS_LONGSTRING;
 			process_field_numeric(EPICS_DB_SIZV, len);
 		}
+		// element type and number for waveform/aai/aao
+		const bool isarray = (arg.get_process_type() == process_type_enum::pt_array);
+		if (isarray) {
+			process_field_string(EPICS_DB_FTVL, get_array_ftvl(arg.get_type_name()));
+			process_field_numeric(EPICS_DB_NELM, arg.get_elements());
+		}
+		// binary structures are a byte array
+		else if (isbinary) {
+			process_field_string(EPICS_DB_FTVL, "UCHAR");
+			process_field_numeric(EPICS_DB_NELM, get_binary_size (arg));
+		}
 
 		// check OPC_PROP_DESC
 		if (opc->get_property(OPC_PROP_DESC, s)) {
@@ -1498,12 +2239,15 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 				process_field_numeric(EPICS_DB_LOPR, f.second);
 				break;
 			case OPC_PROP_HIRANGE:
+				if (isarray) break;
 				process_field_numeric(EPICS_DB_DRVH, f.second);
 				break;
 			case OPC_PROP_LORANGE:
+				if (isarray) break;
 				process_field_numeric(EPICS_DB_DRVL, f.second);
 				break;
 			case OPC_PROP_CLOSE:
+				if (isarray) break;
 				if (std::ssize(f.second) > MAX_EPICS_ENUM) {
 					fprintf(stderr, "Warning: field ONAM for %s too long by %i\n",
 						arg.get_name().c_str(), (int)std::ssize(f.second) - MAX_EPICS_ENUM);
@@ -1511,6 +2255,7 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 				process_field_string(EPICS_DB_ONAM, f.second, MAX_EPICS_ENUM);
 				break;
 			case OPC_PROP_OPEN:
+				if (isarray) break;
 				if (std::ssize(f.second) > MAX_EPICS_ENUM) {
 					fprintf(stderr, "Warning: field ZNAM for %s too long by %i\n",
 						arg.get_name().c_str(), (int)std::ssize(f.second) - MAX_EPICS_ENUM);
@@ -1547,6 +2292,7 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 				break;
 			case OPC_PROP_RECTYPE:
 			case OPC_PROP_INOUT:
+			case OPC_PROP_ARRAY:
 			case OPC_PROP_TSE:
 			case OPC_PROP_PINI:
 			case OPC_PROP_DTYP:
@@ -1681,7 +2427,7 @@ bool epics_db_processing::operator() (const process_arg& arg) noexcept
 			}
 		}
 		// end with closing bracket
-		fprintf(get_file(), "}\n");
+		get_file()->printf ("}\n");
 		return true;
 	}
 	catch (...) {
@@ -1695,7 +2441,7 @@ epics_db_processing::process_field_string
 bool epics_db_processing::process_field_string (stringcase name, 
 	stringcase val, int maxlen) noexcept
 {
-	fprintf (get_file(), "\tfield(%s,\"%.*s\")\n", name.c_str(), maxlen, val.c_str());
+	get_file()->printf ("\tfield(%s,\"%.*s\")\n", name.c_str(), maxlen, val.c_str());
 	return true;
 }
 
@@ -1743,7 +2489,7 @@ bool epics_db_processing::process_field_alarm (stringcase name,
 {
 	if ((severity == EPICS_DB_NOALARM) || (severity == EPICS_DB_MINOR) || 
 		(severity == EPICS_DB_MAJOR)) {
-		fprintf (get_file(), "\tfield(%s,\"%s\")\n", name.c_str(), severity.c_str());
+		get_file()->printf ("\tfield(%s,\"%s\")\n", name.c_str(), severity.c_str());
 		return true;
 	}
 	else {
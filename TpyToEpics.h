@@ -1,6 +1,7 @@
 #pragma once
 #include "stdafx.h"
 #include "ParseTpy.h"
+#include <filesystem>
 
 /** @file TpyToEpics.h
 	Header which includes classes to convert a parsed TwinCAT tpy into
@@ -60,12 +61,12 @@ class epics_conversion : public ParseUtil::replacement_rules,
 					     public ParseUtil::substitution_list {
 public:
 	/// Default constructor
-	epics_conversion() noexcept = default;
+	epics_conversion() noexcept { compile(); }
 	/// Constructor
 	/// @param caseconv Case conversion specification
 	/// @param noindex Eliminate array indices '[n]' with '_n'
 	epics_conversion (case_type caseconv, bool noindex) noexcept
-		: case_epics_names (caseconv), no_array_index (noindex) {}
+		: case_epics_names (caseconv), no_array_index (noindex) { compile(); }
 	/// Constructor
 	/// @param epics_conv Epics conversion rule
 	/// @param caseconv Case conversion specification
@@ -74,7 +75,7 @@ public:
 	epics_conversion (tc_epics_conv epics_conv, case_type caseconv, 
 		bool noldot, bool noindex) noexcept
 		: conv_rule (epics_conv), case_epics_names (caseconv), 
-		no_leading_dot (noldot), no_array_index (noindex) {}
+		no_leading_dot (noldot), no_array_index (noindex) { compile(); }
 	/// Constructor
 	/// Command line arguments will override default parameters when specified
 	/// The format is the same as the arguments passed to the main program
@@ -83,7 +84,7 @@ public:
 	/// @param argv List of command line arguments, same format as in main()
 	/// @param argp Excluded/processed arguments (in/out), array length must be argc
 	epics_conversion (int argc, const char* const argv[], bool argp[] = 0)
-		{ getopt (argc, argv ,argp);}
+		{ compile(); getopt (argc, argv ,argp);}
 	/// Destructor
 	virtual ~epics_conversion() = default;
 
@@ -128,24 +129,24 @@ public:
 	tc_epics_conv get_conversion_rule () const noexcept { return conv_rule; }
 	/// Set the conversion rule
 	void set_conversion_rule (tc_epics_conv epics_conv) noexcept {
-		conv_rule = epics_conv; }
+		conv_rule = epics_conv; compile(); }
 	/// Get the conversion rule
 	case_type get_case_rule () const noexcept { return case_epics_names; }
 	/// Set the conversion rule
 	void set_case_rule (case_type epics_conv) noexcept {
-		case_epics_names = epics_conv; }
+		case_epics_names = epics_conv; compile(); }
 	/// Get the leadin dot rule
 	bool get_dot_rule () const noexcept { return no_leading_dot; }
 	/// Set the leading dot rule
 	void set_dot_rule (bool noldot) noexcept {
-		no_leading_dot = noldot; }
+		no_leading_dot = noldot; compile(); }
 	/// Get the array index rule
 	bool get_array_rule () const noexcept { return no_array_index; }
 	/// Set the array conversion rule
 	void set_array_rule (bool noindex) noexcept {
-		no_array_index = noindex; }
+		no_array_index = noindex; compile(); }
 	/// Get the channel prefix
-	std::stringcase get_prefix() const { return prefix; }
+	const std::stringcase& get_prefix() const noexcept { return prefix; }
 	/// Set the channel prefix
 	void set_prefix(const std::stringcase& pvPrefix) {
 		prefix = pvPrefix;
@@ -169,6 +170,96 @@ protected:
 	bool			no_array_index = true;
 	/// Prefix to apply to all EPICS names
 	std::stringcase		prefix; 
+
+	/// Compiles the conversion settings into a character map
+	void compile() noexcept;
+	/// Character map: case conversion, dot and bracket replacement;
+	/// a zero entry erases the character
+	char			charmap[256] = {};
+	/// Separator whose first and second occurence are replaced by ':' 
+	/// and '-', respectively (zero if none)
+	char			separator = 0;
+	/// Strip the leading dot or everything up to the first dot
+	bool			strip_leading = false;
+};
+
+struct output_file_state;
+
+/** Buffered output file
+    Output is collected in large memory buffers which are handed over
+	to a background writer thread. The number of buffers waiting to be
+	written is bounded, so that a fast producer will block rather than
+	accumulate unlimited memory. If the file already exists, the new 
+	content is compared with the old one and the file is only replaced, 
+	if it changed. An empty filename denotes the console.
+	@brief Buffered output file
+************************************************************************/
+class output_file {
+public:
+	/// Size of a memory buffer which is written in a single call
+	static const size_t buffer_size = 1024 * 1024;
+	/// Maximum number of buffers waiting to be written
+	static const size_t queue_depth = 16;
+
+	/// Default constructor
+	output_file() noexcept = default;
+	/// Constructor
+	/// @param fname Filename (empty for console)
+	explicit output_file (const std::stringcase& fname) { open (fname); }
+	/// Destructor
+	~output_file() { close (true); }
+	/// Disable copy constructor
+	output_file (const output_file&) = delete;
+	/// Disable move constructor
+	output_file (output_file&&) = delete;
+	/// Disable copy assignment
+	output_file& operator= (const output_file&) = delete;
+	/// Disable move assignment
+	output_file& operator= (output_file&&) = delete;
+
+	/// Open a file for writing
+	/// @param fname Filename (empty for console)
+	/// @return True if successful
+	bool open (const std::stringcase& fname);
+	/// Close the file
+	/// @param wait Wait until the content has been written
+	void close (bool wait = false) noexcept;
+	/// Hand over the buffered content to the writer thread and wait 
+	/// until it has been written
+	void flush() noexcept;
+	/// Waits until all pending output of all files has been written
+	static void sync() noexcept;
+
+	/// Is open?
+	bool is_open() const noexcept { return state != nullptr; }
+	/// Is console?
+	bool is_stdout() const noexcept { return is_open() && filename.empty(); }
+	/// Get filename
+	const std::stringcase& get_filename() const noexcept { return filename; }
+
+	/// Formatted output, same as fprintf
+	/// @param format Format string
+	/// @return Number of written characters, or negative on error
+	int printf (const char* format, ...);
+	/// Write a string
+	/// @param data Pointer to data
+	/// @param len Length of data
+	void write (const char* data, size_t len);
+	/// Write a string
+	/// @param s Null terminated string
+	void puts (const char* s) { write (s, strlen (s)); }
+
+protected:
+	/// Pass the buffer on to the writer thread
+	/// @param last Indicates the end of the file
+	void submit (bool last);
+
+	/// Filename
+	std::stringcase		filename;
+	/// Content not yet passed on to the writer
+	std::string			buffer;
+	/// State shared with the writer thread
+	std::shared_ptr<output_file_state>	state;
 };
 
 /** Split file IO support
@@ -220,12 +311,17 @@ public:
 	bool increment (bool readonly);
 	/// Flush contents of output files
 	virtual void flush() noexcept;
+	/// Close files and wait until they have been written
+	virtual void close() noexcept;
 
-	/// Get output file
-	FILE* get_file () const noexcept {return outf; }
+	/// Get output file (console, if no output file is open)
+	output_file* get_file () const;
 	/// Get output filename
 	const std::stringcase& get_filename () const noexcept
 	{ return outfilename; }
+	/// Get the names of all opened output files
+	const std::vector<std::stringcase>& get_filenames () const noexcept
+	{ return outfilenames; }
 	/// Is output split?
 	bool is_split() const noexcept { return split_io; }
 	/// Maximum of channels per file
@@ -241,8 +337,6 @@ public:
 protected:
 	/// Set output filename
 	virtual void set_filename (const std::stringcase& fname);
-	/// Close files
-	virtual void close() noexcept;
 	/// set split
 	void set_split (bool split) noexcept { split_io = split; }
 	/// Set maximum of channels per file
@@ -275,16 +369,18 @@ protected:
 	
 	/// Output filename
 	std::stringcase		outfilename;
+	/// Names of all opened output files
+	std::vector<std::stringcase>	outfilenames;
 	/// Split output into read only channels and input/output channels
 	bool			split_io = false;
 	/// Maximum number of channels per file; 0 indicates no limit
 	int				split_n = 0;
 	/// Output file
-	mutable FILE*	outf = stdout;
+	mutable output_file*	outf = nullptr;
 	/// Output file for read only channels
-	mutable FILE*	outf_in = nullptr;
+	mutable std::unique_ptr<output_file>	outf_in;
 	/// Output file for input/output channels
-	mutable FILE*	outf_io = nullptr;
+	mutable std::unique_ptr<output_file>	outf_io;
 
 	/// Current number of processed channels (records)
 	int				rec_num = 0;
@@ -342,7 +438,13 @@ public:
 		int argc, const char* const argv[], bool argp[] = 0)
 		{ getopt (argc, argv, argp); set_outdirname (dname); set_indirname (dname); }
 	/// Destructor
-	virtual ~multi_io_support () {close(); }
+	virtual ~multi_io_support () { close(); output_file::sync(); }
+	/// Copy constructor
+	/// Open files are not copied.
+	multi_io_support (const multi_io_support& iosup) { *this = iosup; }
+	/// Copy assignment
+	/// Open files are not copied.
+	multi_io_support& operator= (const multi_io_support& iosup);
 
 	/// Return error
 	bool operator! () const;
@@ -350,9 +452,13 @@ public:
 	virtual bool open (const std::stringcase& fname, const std::stringcase& io = "w",
 			bool superrmsg = false);
 	/// Close file
+	/// Written files are passed on to the background writer and 
+	/// output_file::sync() has to be called to wait for completion.
 	virtual void close() noexcept;
-	/// Get file handle
-	FILE* get_file () const noexcept {return filehandle; }
+	/// Get handle of file opened for reading
+	FILE* get_input () const noexcept {return filehandle; }
+	/// Get file opened for writing
+	output_file* get_file () const noexcept {return &outfile; }
 
 	/// Set output directory name
 	void set_outdirname (const std::stringcase& dname);
@@ -403,8 +509,10 @@ protected:
 	std::stringcase	filename;
 	/// reading or writing?
 	io_filestat		filestat = io_filestat::closed;
-	/// Output file
+	/// Input file
 	mutable FILE*	filehandle = nullptr;
+	/// Output file
+	mutable output_file	outfile;
 
 	/// Current file number of processed read only channels (records)
 	int				file_num_in = 0;
@@ -412,6 +520,104 @@ protected:
 	int				file_num_out = 0;
 };
 
+/** Generation manifest
+    Records a key for each generated output together with the content
+	hashes of the files it produced. The key is a hash over everything
+	which goes into the generation, like the input file, the options and 
+	the replacement rules. An output is up to date, if its key is 
+	unchanged and its files were not modified since. The manifest is 
+	stored as a text file.
+	@brief Generation manifest
+************************************************************************/
+class generation_manifest {
+public:
+	/// Hash type
+	using hash_type = unsigned long long;
+	/// Initial hash value
+	static const hash_type hash_seed = 14695981039346656037ULL;
+	/// File extension of manifests
+	static const char* const extension;
+
+	/// Default constructor
+	generation_manifest() = default;
+	/// Constructor
+	/// @param fname Manifest filename
+	explicit generation_manifest (const std::stringcase& fname) { read (fname); }
+
+	/// Read a manifest. A missing file yields an empty manifest.
+	/// @param fname Manifest filename
+	/// @return True if read
+	bool read (const std::stringcase& fname);
+	/// Write the manifest to the file it was read from. Only outputs 
+	/// which were checked or set since reading are written.
+	/// @return True if successful
+	bool write() const;
+
+	/// Checks if an output is up to date
+	/// @param name Output name
+	/// @param key Hash over the generation inputs
+	/// @return True if up to date
+	bool is_current (const std::stringcase& name, hash_type key);
+	/// Record a generated output
+	/// @param name Output name
+	/// @param key Hash over the generation inputs
+	/// @param files List of files which were produced or read
+	void set_output (const std::stringcase& name, hash_type key,
+		const std::vector<std::stringcase>& files);
+
+	/// Hash a block of memory (FNV-1a)
+	/// @param data Pointer to data
+	/// @param len Length of data
+	/// @param h Hash to continue
+	/// @return Hash
+	static hash_type hash_bytes (const void* data, size_t len, 
+		hash_type h = hash_seed) noexcept;
+	/// Hash a string
+	/// @param s String
+	/// @param h Hash to continue
+	/// @return Hash
+	static hash_type hash (const std::stringcase& s, 
+		hash_type h = hash_seed) noexcept {
+		return hash_bytes (s.c_str(), s.size() + 1, h); }
+	/// Hash the content of a file
+	/// @param fname Filename
+	/// @param h Hash to continue
+	/// @return Hash, or 0 if the file cannot be read
+	static hash_type hash_file (const std::stringcase& fname, 
+		hash_type h = hash_seed);
+	/// Hash a set of replacement rules
+	/// @param rules Replacement rules
+	/// @param h Hash to continue
+	/// @return Hash
+	static hash_type hash_rules (const ParseUtil::replacement_rules& rules, 
+		hash_type h = hash_seed);
+	/// Hash the version of the generator
+	/// @param h Hash to continue
+	/// @return Hash
+	static hash_type hash_version (hash_type h = hash_seed) noexcept;
+	/// List the files of an output. This is the file itself, or all 
+	/// files of a directory excluding manifests.
+	/// @param name Output file or directory name
+	/// @return List of files
+	static std::vector<std::stringcase> list_files (const std::stringcase& name);
+
+protected:
+	/// Output entry
+	struct output_entry {
+		/// Hash over the generation inputs
+		hash_type		key = 0;
+		/// Files and their content hashes
+		std::vector<std::pair<std::stringcase, hash_type>> files;
+		/// Checked or set since reading
+		bool			used = false;
+	};
+
+	/// Manifest filename
+	std::stringcase		filename;
+	/// Outputs by name
+	std::map<std::stringcase, output_entry>	outputs;
+};
+
 
 /** This enum describes the type of listing to produce
      @brief Listing type enum
@@ -563,6 +769,27 @@ using macro_stack = std::stack<macro_record>;
  ************************************************************************/
 using filename_set = std::unordered_set<std::stringcase>;
 
+/** Parsed list of error messages
+	@brief Error message list
+************************************************************************/
+using error_list = std::vector<std::stringcase>;
+
+/** Cached error message list together with the modification time of 
+	the file it was read from
+	@brief Cached error message list
+************************************************************************/
+struct error_list_entry {
+	/// Modification time of the error list file
+	std::filesystem::file_time_type	mtime;
+	/// Parsed error messages
+	std::shared_ptr<const error_list>	messages;
+};
+
+/** Cache of error message lists by file name
+	@brief Error list cache
+************************************************************************/
+using error_list_cache = std::unordered_map<std::stringcase, error_list_entry>;
+
 /** Class for generatig macro files to be used by medm
 	@brief Macro file processing
 ************************************************************************/
@@ -641,6 +868,9 @@ public:
 	/// @return True if successfully processed
 	virtual bool operator() (const ParseUtil::process_arg& arg);
 
+	/// Get the full names of all error list files which have been read
+	std::vector<std::stringcase> get_errorlist_files () const;
+
 	/// Get listing type
 	macrofile_type get_macrofile_type () const noexcept { return macros; }
 	/// Set listing
@@ -667,6 +897,11 @@ public:
 protected:
 	/// Process top of stack
 	bool process_record (const macro_record& mrec, int level = 0);
+	/// Read a list of error messages. The parsed list is cached and only
+	/// read again, if the file modification time changes.
+	/// @param fname Name of error list file (relative to input directory)
+	/// @return Error messages, or nullptr if the file cannot be read
+	std::shared_ptr<const error_list> read_error_list (const std::stringcase& fname);
 
 	/// Listing type
 	macrofile_type	macros = macrofile_type::all;
@@ -680,6 +915,8 @@ protected:
 	int				rec_num = 0;
 	/// set of missing input files
 	filename_set	missing;
+	/// Parsed error lists by file name
+	error_list_cache	errorlists;
 };
 
 /** This enum describes the type of device support to use
@@ -796,6 +1033,17 @@ public:
 	void set_int_support(int_support_type intsup) noexcept {
 		int_support = intsup; }
 
+	/// Set the pattern of structures which are exported as a whole
+	/// Matching structures become a single read-only UCHAR waveform 
+	/// holding the binary image of the structure.
+	/// @param pattern Regular expression matched against the TwinCAT name
+	/// @return True if the pattern is valid (an empty pattern disables it)
+	bool set_binary_pattern (const std::string& pattern) noexcept;
+	/// Checks if a variable is a structure which is exported as a whole
+	/// @param arg Process argument describing the variable and type
+	/// @return True if binary structure record
+	bool is_binary_struct (const ParseUtil::process_arg& arg) const noexcept;
+
 	/// Process a variable
 	/// @param arg Process argument describign the variable and type
 	/// @return True if successfully processed
@@ -838,6 +1086,10 @@ protected:
 	string_support_type string_support = string_support_type::vary_string;
 	/// Integer support field conversion rule
 	int_support_type int_support = int_support_type::int_auto;
+	/// Pattern of structures exported as binary records
+	std::regex			binary_pattern;
+	/// Binary structure records enabled
+	bool				binary_enabled = false;
 };
 
 
@@ -44,6 +44,8 @@ const char* const EPICS_DB_TSE=		"TSE";	/**< time stamp */
 const char* const EPICS_DB_PINI=	"PINI";	/**< initialization */
 const char* const EPICS_DB_DTYP=	"DTYP";	/**< data type */
 const char* const EPICS_DB_SIZV=    "SIZV";	/**< string size for long strings */
+const char* const EPICS_DB_NELM=    "NELM";	/**< number of array elements */
+const char* const EPICS_DB_FTVL=    "FTVL";	/**< field type of array elements */
 
 const char* const EPICS_DB_OSV=		"OSV";	/**< one severity */
 const char* const EPICS_DB_ZSV=		"ZSV";	/**< zero severity */
@@ -16,6 +16,7 @@
 #include "callback.h"
 #endif
 #include <iostream>
+#include <optional>
 #if defined(_MSC_VER) && (EPICS_VERSION < 7)
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 #include <windows.h>
@@ -125,6 +126,15 @@ bool register_devsup::linkRecord (const std::stringcase& inpout,
 					printf("PLC not found %s.\n", pEpicsRecord->name);
 					return false;
 				}
+				// Profile as part of the PLC's startup
+				std::optional<ParseUtil::startup_profiler::plc_scope> profplc;
+				if (ParseUtil::startup_profiler::get().is_enabled()) {
+					const TcComms::TcPLC* const tcplc = 
+						dynamic_cast<const TcComms::TcPLC*>(plcMatch.get());
+					profplc.emplace (tcplc ? 
+						std::stringcase (tcplc->get_tpyfilename().c_str()) : plcMatch->get_name());
+				}
+				ParseUtil::startup_profiler::phase prof ("init_record", false);
 				// Link record object to EPICS record
 				pRecord = plcMatch->find(inpout);
 				if (!pRecord.get()) {
@@ -161,6 +171,355 @@ void complete_io_scan (EpicsInterface* epics, IOSCANPVT ioscan, int prio) noexce
 	epics->ioscan_reset(prio);
 }
 
+/** Returns the size of a PLC array element
+	@param etype Element type
+	@return Size in bytes, or 0 if unknown
+	@brief Element size
+ ************************************************************************/
+static size_t element_size (data_type_enum etype) noexcept
+{
+	switch (etype) {
+	case data_type_enum::dtBool:
+	case data_type_enum::dtInt8:
+	case data_type_enum::dtUInt8:
+		return 1;
+	case data_type_enum::dtInt16:
+	case data_type_enum::dtUInt16:
+		return 2;
+	case data_type_enum::dtInt32:
+	case data_type_enum::dtUInt32:
+	case data_type_enum::dtFloat:
+		return 4;
+	case data_type_enum::dtInt64:
+	case data_type_enum::dtUInt64:
+	case data_type_enum::dtDouble:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/** Returns the size of an EPICS array element
+	@param ftvl Field type (menuFtype)
+	@return Size in bytes, or 0 if not supported
+	@brief Field type size
+ ************************************************************************/
+static size_t ftvl_size (epicsEnum16 ftvl) noexcept
+{
+	switch (ftvl) {
+	case menuFtypeCHAR:
+	case menuFtypeUCHAR:
+		return 1;
+	case menuFtypeSHORT:
+	case menuFtypeUSHORT:
+		return 2;
+	case menuFtypeLONG:
+	case menuFtypeULONG:
+	case menuFtypeFLOAT:
+		return 4;
+#if EPICS_VERSION >= 7
+	case menuFtypeINT64:
+	case menuFtypeUINT64:
+#endif
+	case menuFtypeDOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/** Checks if a PLC element type and an EPICS field type share the same
+	memory layout and can be copied without conversion
+	@param etype Element type
+	@param ftvl Field type (menuFtype)
+	@return True if identical
+	@brief Element type matches field type
+ ************************************************************************/
+static bool element_matches (data_type_enum etype, epicsEnum16 ftvl) noexcept
+{
+	switch (etype) {
+	case data_type_enum::dtBool:
+	case data_type_enum::dtUInt8:
+		return ftvl == menuFtypeUCHAR;
+	case data_type_enum::dtInt8:
+		return ftvl == menuFtypeCHAR;
+	case data_type_enum::dtInt16:
+		return ftvl == menuFtypeSHORT;
+	case data_type_enum::dtUInt16:
+		return ftvl == menuFtypeUSHORT;
+	case data_type_enum::dtInt32:
+		return ftvl == menuFtypeLONG;
+	case data_type_enum::dtUInt32:
+		return ftvl == menuFtypeULONG;
+#if EPICS_VERSION >= 7
+	case data_type_enum::dtInt64:
+		return ftvl == menuFtypeINT64;
+	case data_type_enum::dtUInt64:
+		return ftvl == menuFtypeUINT64;
+#endif
+	case data_type_enum::dtFloat:
+		return ftvl == menuFtypeFLOAT;
+	case data_type_enum::dtDouble:
+		return ftvl == menuFtypeDOUBLE;
+	default:
+		return false;
+	}
+}
+
+/** Converts PLC array elements into an EPICS array
+	@param dest EPICS buffer
+	@param src PLC buffer
+	@param etype Element type of PLC array
+	@param num Number of elements
+	@brief Convert array to EPICS
+ ************************************************************************/
+template <typename T>
+static void convert_to_epics (T* dest, const char* src, data_type_enum etype, size_t num) noexcept
+{
+	for (size_t i = 0; i < num; ++i) {
+		switch (etype) {
+		case data_type_enum::dtBool:
+			dest[i] = (T)(((const epicsUInt8*)src)[i] != 0);
+			break;
+		case data_type_enum::dtInt8:
+			dest[i] = (T)((const epicsInt8*)src)[i];
+			break;
+		case data_type_enum::dtUInt8:
+			dest[i] = (T)((const epicsUInt8*)src)[i];
+			break;
+		case data_type_enum::dtInt16:
+			dest[i] = (T)((const epicsInt16*)src)[i];
+			break;
+		case data_type_enum::dtUInt16:
+			dest[i] = (T)((const epicsUInt16*)src)[i];
+			break;
+		case data_type_enum::dtInt32:
+			dest[i] = (T)((const epicsInt32*)src)[i];
+			break;
+		case data_type_enum::dtUInt32:
+			dest[i] = (T)((const epicsUInt32*)src)[i];
+			break;
+		case data_type_enum::dtInt64:
+			dest[i] = (T)((const long long*)src)[i];
+			break;
+		case data_type_enum::dtUInt64:
+			dest[i] = (T)((const unsigned long long*)src)[i];
+			break;
+		case data_type_enum::dtFloat:
+			dest[i] = (T)((const epicsFloat32*)src)[i];
+			break;
+		case data_type_enum::dtDouble:
+			dest[i] = (T)((const epicsFloat64*)src)[i];
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+/** Converts EPICS array elements into a PLC array
+	@param dest PLC buffer
+	@param src EPICS buffer
+	@param etype Element type of PLC array
+	@param num Number of elements
+	@brief Convert array from EPICS
+ ************************************************************************/
+template <typename T>
+static void convert_from_epics (char* dest, const T* src, data_type_enum etype, size_t num) noexcept
+{
+	for (size_t i = 0; i < num; ++i) {
+		switch (etype) {
+		case data_type_enum::dtBool:
+			((epicsUInt8*)dest)[i] = (src[i] != 0) ? 1 : 0;
+			break;
+		case data_type_enum::dtInt8:
+			((epicsInt8*)dest)[i] = (epicsInt8)src[i];
+			break;
+		case data_type_enum::dtUInt8:
+			((epicsUInt8*)dest)[i] = (epicsUInt8)src[i];
+			break;
+		case data_type_enum::dtInt16:
+			((epicsInt16*)dest)[i] = (epicsInt16)src[i];
+			break;
+		case data_type_enum::dtUInt16:
+			((epicsUInt16*)dest)[i] = (epicsUInt16)src[i];
+			break;
+		case data_type_enum::dtInt32:
+			((epicsInt32*)dest)[i] = (epicsInt32)src[i];
+			break;
+		case data_type_enum::dtUInt32:
+			((epicsUInt32*)dest)[i] = (epicsUInt32)src[i];
+			break;
+		case data_type_enum::dtInt64:
+			((long long*)dest)[i] = (long long)src[i];
+			break;
+		case data_type_enum::dtUInt64:
+			((unsigned long long*)dest)[i] = (unsigned long long)src[i];
+			break;
+		case data_type_enum::dtFloat:
+			((epicsFloat32*)dest)[i] = (epicsFloat32)src[i];
+			break;
+		case data_type_enum::dtDouble:
+			((epicsFloat64*)dest)[i] = (epicsFloat64)src[i];
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+/** Converts between a PLC array and an EPICS array of field type ftvl
+	@param toepics True to convert to EPICS, false to convert to PLC
+	@param epicsbuf EPICS buffer
+	@param plcbuf PLC buffer
+	@param etype Element type of PLC array
+	@param ftvl Field type (menuFtype)
+	@param num Number of elements
+	@return True if the field type is supported
+	@brief Convert array
+ ************************************************************************/
+static bool convert_array (bool toepics, void* epicsbuf, char* plcbuf,
+						   data_type_enum etype, epicsEnum16 ftvl, size_t num) noexcept
+{
+	switch (ftvl) {
+	case menuFtypeCHAR:
+		toepics ? convert_to_epics ((epicsInt8*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsInt8*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeUCHAR:
+		toepics ? convert_to_epics ((epicsUInt8*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsUInt8*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeSHORT:
+		toepics ? convert_to_epics ((epicsInt16*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsInt16*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeUSHORT:
+		toepics ? convert_to_epics ((epicsUInt16*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsUInt16*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeLONG:
+		toepics ? convert_to_epics ((epicsInt32*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsInt32*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeULONG:
+		toepics ? convert_to_epics ((epicsUInt32*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsUInt32*)epicsbuf, etype, num);
+		return true;
+#if EPICS_VERSION >= 7
+	case menuFtypeINT64:
+		toepics ? convert_to_epics ((epicsInt64*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsInt64*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeUINT64:
+		toepics ? convert_to_epics ((epicsUInt64*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsUInt64*)epicsbuf, etype, num);
+		return true;
+#endif
+	case menuFtypeFLOAT:
+		toepics ? convert_to_epics ((epicsFloat32*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsFloat32*)epicsbuf, etype, num);
+		return true;
+	case menuFtypeDOUBLE:
+		toepics ? convert_to_epics ((epicsFloat64*)epicsbuf, plcbuf, etype, num) :
+			convert_from_epics (plcbuf, (const epicsFloat64*)epicsbuf, etype, num);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* read_array
+ ************************************************************************/
+bool read_array (plc::BaseRecord* baserec, void* bptr, epicsEnum16 ftvl,
+				 epicsUInt32 nelm, epicsUInt32& nord) noexcept
+{
+	if (!baserec || !bptr) {
+		return false;
+	}
+	const Interface* iface = baserec->get_plcInterface();
+	const data_type_enum etype = iface ? iface->get_element_type() : data_type_enum::dtInvalid;
+	const size_t size = baserec->get_data().get_size();
+	const size_t fsize = ftvl_size (ftvl);
+	const size_t esize = element_size (etype);
+	if ((size == 0) || (fsize == 0)) {
+		return false;
+	}
+	// identical layout (or unknown element type): copy raw bytes
+	const bool raw = (esize == 0) || element_matches (etype, ftvl);
+	if (raw && (size <= (size_t)nelm * fsize)) {
+		if (baserec->UserReadBinary (bptr, size) != size) {
+			return false;
+		}
+		nord = (epicsUInt32)(size / fsize);
+		return true;
+	}
+	// need a temporary buffer for truncation or conversion
+	try {
+		thread_local std::vector<char> buf;
+		buf.resize (size);
+		if (baserec->UserReadBinary (buf.data(), size) != size) {
+			return false;
+		}
+		if (raw) {
+			memcpy (bptr, buf.data(), (size_t)nelm * fsize);
+			nord = nelm;
+			return true;
+		}
+		const size_t num = min (size / esize, (size_t)nelm);
+		if (!convert_array (true, bptr, buf.data(), etype, ftvl, num)) {
+			return false;
+		}
+		nord = (epicsUInt32)num;
+		return true;
+	}
+	catch (...) {
+		return false;
+	}
+}
+
+/* write_array
+ ************************************************************************/
+bool write_array (plc::BaseRecord* baserec, const void* bptr, epicsEnum16 ftvl,
+				  epicsUInt32 nord) noexcept
+{
+	if (!baserec || !bptr) {
+		return false;
+	}
+	const Interface* iface = baserec->get_plcInterface();
+	const data_type_enum etype = iface ? iface->get_element_type() : data_type_enum::dtInvalid;
+	const size_t size = baserec->get_data().get_size();
+	const size_t fsize = ftvl_size (ftvl);
+	const size_t esize = element_size (etype);
+	if ((size == 0) || (fsize == 0)) {
+		return false;
+	}
+	// identical layout (or unknown element type) and complete: copy raw bytes
+	const bool raw = (esize == 0) || element_matches (etype, ftvl);
+	if (raw && ((size_t)nord * fsize == size)) {
+		return baserec->UserWriteBinary (const_cast<void*>(bptr), size) == size;
+	}
+	// need a temporary buffer for partial writes or conversion
+	try {
+		thread_local std::vector<char> buf;
+		buf.resize (size);
+		// start from the current value, but don't touch the dirty flag
+		DataValueTypeDef::atomic_bool dummy (false);
+		baserec->get_data().ReadBinary (dummy, buf.data(), size);
+		if (raw) {
+			memcpy (buf.data(), bptr, min ((size_t)nord * fsize, size));
+		}
+		else if (!convert_array (false, const_cast<void*>(bptr), buf.data(), etype, ftvl, 
+								 min (size / esize, (size_t)nord))) {
+			return false;
+		}
+		return baserec->UserWriteBinary (buf.data(), size) == size;
+	}
+	catch (...) {
+		return false;
+	}
+}
+
 /* EpicsInterface::ioscan_reset
  ************************************************************************/
 void EpicsInterface::ioscan_reset (int bitnum) noexcept
@@ -485,7 +844,7 @@ static devTcDefIn<epics_record_enum::stringinval> stringinval_record_tc_dset;
 static devTcDefIn<epics_record_enum::lsival> lsival_record_tc_dset;
 
 // waveform record
-static devTcDefWaveformIn<epics_record_enum::waveformval> waveformval_record_tc_dset;
+static devTcDefIn<epics_record_enum::waveformval> waveformval_record_tc_dset;
 
 
 // ao record
@@ -107,6 +107,9 @@ public:
 	/// Set pEpicsRecord
 	void set_pEpicsRecord(dbCommon* pEpRecord) noexcept {
 		pEpicsRecord = pEpRecord;};
+	/// Get pEpicsRecord
+	dbCommon* get_pEpicsRecord() const noexcept {
+		return pEpicsRecord; };
 	/// Get callbackRequestPending
 	bool get_callbackRequestPending() const noexcept;
 
@@ -425,29 +428,35 @@ public:
 	static long write (rec_type_ptr precord) noexcept;
 };
 
-/** Deviced Support Record for TwinCAT/ADS waveform input
-    This structure defines the callback functions for the TC device support.
-	This is a base class for both read and write records.
-    @brief device support waveform record.
- ************************************************************************/
-template <epics_record_enum RecType>
-struct devTcDefWaveformIn : public devTcDefIo<RecType>
-{
-public:
-	/// Record type: aiRecord, etc.
-	using rec_type = devTcDefIo<RecType>::rec_type;
-	/// Pointer to record type
-	using rec_type_ptr = devTcDefIo<RecType>::rec_type_ptr;
-
-	/// Constructor
-	devTcDefWaveformIn() noexcept : devTcDefIo<RecType>::devTcDefIo(init_read_waveform_record, read_waveform) {}
-	/// init callback for read records
-	static long init_read_waveform_record (rec_type_ptr prec) noexcept;
-	/// read callback
-	static long read_waveform (rec_type_ptr precord) noexcept;
-};
-
 void complete_io_scan(EpicsInterface* epics, IOSCANPVT ioscan, int prio) noexcept;
 
+/** Reads an array from a base record into the buffer of an aai, aao or 
+	waveform record. The elements are converted from the PLC element type 
+	to the field type of the EPICS record.
+	@param baserec Base record holding the array data
+	@param bptr Buffer of EPICS record
+	@param ftvl Field type of EPICS record (menuFtype)
+	@param nelm Maximum number of elements of EPICS record
+	@param nord Number of elements read (return)
+	@return True if successful
+	@brief Read array
+ ************************************************************************/
+bool read_array (plc::BaseRecord* baserec, void* bptr, epicsEnum16 ftvl,
+				 epicsUInt32 nelm, epicsUInt32& nord) noexcept;
+
+/** Writes the buffer of an aao record into a base record. The elements are
+	converted from the field type of the EPICS record to the PLC element 
+	type. If fewer elements than the PLC array holds are written, the 
+	remaining elements keep their current value.
+	@param baserec Base record holding the array data
+	@param bptr Buffer of EPICS record
+	@param ftvl Field type of EPICS record (menuFtype)
+	@param nord Number of elements to write
+	@return True if successful
+	@brief Write array
+ ************************************************************************/
+bool write_array (plc::BaseRecord* baserec, const void* bptr, epicsEnum16 ftvl,
+				  epicsUInt32 nord) noexcept;
+
 }
 #include "devTcTemplate.h"
\ No newline at end of file
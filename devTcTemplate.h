@@ -42,13 +42,11 @@ struct epics_record_traits<epics_record_enum::aaival>
     static const int value_conversion = 0;
 	static const bool input_record = true;
 	static const bool raw_record = false;
-	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->val; }
+	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->bptr; }
 	static bool read (traits_type* epicsrec, plc::BaseRecord* baserec) noexcept {
-		const auto size = baserec->get_data().get_size();
-		return baserec->UserReadBinary(*val (epicsrec), size) == size; }
+		return read_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nelm, epicsrec->nord); }
 	static bool write (plc::BaseRecord* baserec, traits_type* epicsrec) noexcept {
-		const auto size = baserec->get_data().get_size();
-		return baserec->UserWriteBinary(*val (epicsrec), size) == size; }
+		return write_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nord); }
 };
 
 /// Epics traits class specialization for aao record
@@ -61,13 +59,11 @@ struct epics_record_traits<epics_record_enum::aaoval>
     static const int value_conversion = 0;
 	static const bool input_record = false;
 	static const bool raw_record = false;
-	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->val; }
+	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->bptr; }
 	static bool read (traits_type* epicsrec, plc::BaseRecord* baserec) noexcept {
-		const auto size = baserec->get_data().get_size();
-		return baserec->UserReadBinary(*val (epicsrec), size) == size; }
+		return read_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nelm, epicsrec->nord); }
 	static bool write (plc::BaseRecord* baserec, traits_type* epicsrec) noexcept {
-		const auto size = baserec->get_data().get_size();
-		return baserec->UserWriteBinary(*val (epicsrec), size) == size; }
+		return write_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nord); }
 };
 
 /// Epics traits class specialization for ai record
@@ -502,7 +498,11 @@ struct epics_record_traits<epics_record_enum::waveformval>
     static const int value_conversion = 0;
 	static const bool input_record = true;
 	static const bool raw_record = false;
-	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->val; }
+	static value_type* val (traits_type* prec) noexcept { return (value_type*) &prec->bptr; }
+	static bool read (traits_type* epicsrec, plc::BaseRecord* baserec) noexcept {
+		return read_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nelm, epicsrec->nord); }
+	static bool write (plc::BaseRecord* baserec, traits_type* epicsrec) noexcept {
+		return write_array (baserec, *val (epicsrec), epicsrec->ftvl, epicsrec->nord); }
 };
 
 /// Epics traits class specialization for event record
@@ -679,65 +679,6 @@ long devTcDefOut<RecType>::init_write_record (rec_type_ptr prec) noexcept
 	return 0;
 }
 
-/* devTcDefWaveformIn<>::init_read_waveform_record
- ************************************************************************/
-template <epics_record_enum RecType>
-long devTcDefWaveformIn<RecType>::
-	init_read_waveform_record (rec_type_ptr precord) noexcept
-{
-    constexpr int iInit = 0;
-    if(!precord) {
-        recGblRecordError(S_db_notFound, precord,
-            "Fatal error: init_record record has NULL-pointer");
-		std::ignore = getchar();
-        exit(S_db_notFound);
-    }
-    if( precord->inp.type == 0 ) {
-        recGblRecordError(S_db_badField, (void*)precord,
-            "Fatal error: init_record INP field not initialized (It has value 0!!!)");
-        precord->pact = TRUE;     // disable this record
-		std::ignore = getchar();
-        exit(S_db_badField);
-    }
-    if( precord->inp.type != INST_IO ) {
-        recGblRecordError(S_db_badField, (void*)precord,
-            "init_record Illegal INP field (INST_IO expected: "
-            "check following in your db-file: field(DTYP,\"tcat\");field(IN,\"@tc://...\")");
-        precord->pact = TRUE;     // disable this record
-        return S_db_badField;
-    }
-    if( precord->scan <  SCAN_IO_EVENT  ) {
-        recGblRecordError(S_db_badField, (void*)precord, "init_record Illegal SCAN field");
-        precord->pact = TRUE;     // disable this record
-        return S_db_badField;
-    }
-    //opcItemName = precord->inp.value.instio.string;
-    //iInit = opcInitItem(opcItemName,(dbCommon*)precord,&pOpc2Epics);
-    //if(!pOpc2Epics) {
-    //    recGblRecordError(S_db_noMemory,precord,"OPC-item interface has not been not initialized!");
-    //    return S_db_noMemory;
-    //}
-    //pOpc2Epics->pRecVal=precord->bptr;
-    //pOpc2Epics->recType=waveformval;
-    //pOpc2Epics->nelm = precord->nelm;
-    //pOpc2Epics->nord = & precord->nord;
-    //precord->dpvt = (void*)pOpc2Epics;
-    if(precord->scan == SCAN_IO_EVENT) {
-        //scanIoInit(&(pOpc2Epics->ioscanpvt));
-        //pOpc2Epics->isCallback = 1;
-    } else {
-        //pOpc2Epics->isCallback = 0;
-        //pOpc2Epics->ioscanpvt  = 0;
-    }
-    if(!iInit) {
-        precord->pact = TRUE;     // disable this record
-        return S_dev_Conflict;
-    }
-    return 0;
-}
-
-
-
 /* devTcDefIn<>::read
  ************************************************************************/
 template <epics_record_enum RecType>
@@ -779,13 +720,7 @@ long devTcDefIn<RecType>::read(rec_type_ptr precord) noexcept
 	// Grab data value into EPICS 
 	epics_record_traits<RecType>::read (precord, pBaseRecord);
 	// set time stamp
-	const plc::BaseRecord::time_type timestamp = pBaseRecord->get_timestamp();
-	try {
-		precord->time = epicsTime(*((_FILETIME*)&timestamp));
-	}
-	catch(...) {
-		precord->time = epicsTime();
-	};
+	pBaseRecord->get_timestamp_epics (precord->time.secPastEpoch, precord->time.nsec);
 
 	precord->udf = udf;
 	precord->pact = FALSE;
@@ -840,13 +775,7 @@ long devTcDefOut<RecType>::write (rec_type_ptr precord) noexcept
 		// Read data value
 		epics_record_traits<RecType>::read (precord, pBaseRecord);
 		// set time stamp
-		const plc::BaseRecord::time_type timestamp = pBaseRecord->get_timestamp();
-		try {
-			precord->time = epicsTime(*((_FILETIME*)&timestamp));
-		}
-		catch (...) {
-			precord->time = epicsTime();
-		};
+		pBaseRecord->get_timestamp_epics (precord->time.secPastEpoch, precord->time.nsec);
 	}
 	else {
 		// Write data value
@@ -865,30 +794,6 @@ long devTcDefOut<RecType>::write (rec_type_ptr precord) noexcept
     return 0;
 }
 
-/* devTcDefIn<>::read_waveform
- ************************************************************************/
-template <epics_record_enum RecType>
-long devTcDefWaveformIn<RecType>::read_waveform (rec_type_ptr precord) noexcept
-{
-	constexpr long ret = epics_record_traits<RecType>::value_conversion;
-    //long ret = recPropStruct::prop[record_type].ret;
-    //OpcToEpics* pOpc2Epics = (OpcToEpics*)precord->dpvt;
-    //long ret = recProp[pOpc2Epics->recType].ret;
-    //if(!pOpc2Epics) {
-    //    recGblRecordError(S_dev_noDeviceFound, (void *)precord, "unable to get device");
-    //    precord->pact = TRUE;     // disable this record
-    //    return ret;
-    //}
-    if(precord->pact) {
-        return ret;
-	}
-    //if(opcGetScalar(pOpc2Epics)) {
-    //    return ret;
-	//}
-    precord->pact = FALSE;
-    precord->udf  = FALSE;
-    return ret;
-}
 /** @} */
 
 }
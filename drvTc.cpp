@@ -15,7 +15,14 @@
 #include "waveformRecord.h"
 #include "initHooks.h"
 #include "tcComms.h"
+#include "tcSim.h"
+#include "tcBench.h"
 #include "epicsExit.h"
+#include "dbCommon.h"
+#include <chrono>
+#include <optional>
+#define epicsExportSharedSymbols
+#include "tcLocation.h"
 
 /** @file drvTc.cpp
 	This contains functions for driver support for EPICS. These routines 
@@ -42,33 +49,70 @@ static const iocshArg tcLoadRecordsArg0	            = {"'tpy' Filename", iocshAr
 static const iocshArg tcLoadRecordsArg1	            = {"Conversion rules", iocshArgString};
 static const iocshArg tcSetScanRateArg0	            = {"TC scan rate in ms", iocshArgString};
 static const iocshArg tcSetScanRateArg1	            = {"EPICS scan rate in multiples of the TC scan rate", iocshArgString};
+static const iocshArg tcScatterArg0				= {"Number of scatter threads per PLC (0 = off)", iocshArgString};
+static const iocshArg tcNotifyArg0					= {"Regular expression of TwinCAT names", iocshArgString};
+static const iocshArg tcBinaryArg0					= {"Regular expression of TwinCAT structure names", iocshArgString};
 static const iocshArg tcListArg0			        = {"'list' Filename", iocshArgString};
 static const iocshArg tcListArg1		            = {"Conversion rules", iocshArgString};
 static const iocshArg tcMacroArg0			        = {"'mdir' output directory", iocshArgString};
 static const iocshArg tcMacroArg1		            = {"Macro arguments", iocshArgString};
 static const iocshArg tcAliasArg0					= {"Alias name for PLC", iocshArgString};
 static const iocshArg tcAliasArg1					= {"Replacement rules", iocshArgString};
+static const iocshArg tcUploadArg0					= {"ADS address tc://netid:port/", iocshArgString};
 static const iocshArg tcInfoPrefixArg0				= {"Prefix for info PLC records", iocshArgString};
 static const iocshArg tcPrintValsArg0				= {"emptyarg", iocshArgString };
 static const iocshArg tcPrintValArg0				= {"Variable name (accepts wildcards)", iocshArgString};
+static const iocshArg tcPrintRequestsArg0			= {"all: print all request groups", iocshArgString};
+static const iocshArg tcDeferredLoadArg0			= {"1: queue PLCs, 0: load immediately", iocshArgString};
+static const iocshArg tcLoadAllArg0					= {"Number of threads (0 = number of cores)", iocshArgString};
+static const iocshArg tcProfileArg0					= {"'json' Filename (optional)", iocshArgString};
+static const iocshArg tcSimTargetArg0				= {"ADS address tc://netid:port/", iocshArgString};
+static const iocshArg tcSimTargetArg1				= {"Memory image file (optional)", iocshArgString};
+static const iocshArg tcSimTargetArg2				= {"Value changes per second", iocshArgString};
+static const iocshArg tcSimTargetArg3				= {"Tpy file for the symbol upload (optional)", iocshArgString};
+static const iocshArg tcSimRateArg0					= {"Value changes per second", iocshArgString};
+static const iocshArg tcBenchmarkArg0				= {"Duration in seconds", iocshArgString};
+static const iocshArg tcBenchmarkArg1				= {"'json' Filename (optional)", iocshArgString};
 
 static const iocshArg* const  tcLoadRecordsArg[2]   = {&tcLoadRecordsArg0, &tcLoadRecordsArg1};
 static const iocshArg* const  tcSetScanRateArg[2]   = {&tcSetScanRateArg0, &tcSetScanRateArg1};
+static const iocshArg* const  tcScatterArg[1]		= {&tcScatterArg0};
+static const iocshArg* const  tcNotifyArg[1]		= {&tcNotifyArg0};
+static const iocshArg* const  tcBinaryArg[1]		= {&tcBinaryArg0};
 static const iocshArg* const  tcListArg[2]		    = {&tcListArg0, &tcListArg1};
 static const iocshArg* const  tcMacroArg[2]		    = {&tcMacroArg0, &tcMacroArg1};
 static const iocshArg* const  tcAliasArg[2]			= {&tcAliasArg0, &tcAliasArg1};
+static const iocshArg* const  tcUploadArg[1]		= {&tcUploadArg0};
 static const iocshArg* const  tcInfoPrefixArg[1]	= {&tcInfoPrefixArg0};
 static const iocshArg* const  tcPrintValsArg[1]		= {&tcPrintValsArg0};
 static const iocshArg* const  tcPrintValArg[1]		= {&tcPrintValArg0};
+static const iocshArg* const  tcPrintRequestsArg[1]	= {&tcPrintRequestsArg0};
+static const iocshArg* const  tcDeferredLoadArg[1]	= {&tcDeferredLoadArg0};
+static const iocshArg* const  tcLoadAllArg[1]		= {&tcLoadAllArg0};
+static const iocshArg* const  tcProfileArg[1]		= {&tcProfileArg0};
+static const iocshArg* const  tcSimTargetArg[4]		= {&tcSimTargetArg0, &tcSimTargetArg1, &tcSimTargetArg2, &tcSimTargetArg3};
+static const iocshArg* const  tcSimRateArg[1]		= {&tcSimRateArg0};
+static const iocshArg* const  tcBenchmarkArg[2]		= {&tcBenchmarkArg0, &tcBenchmarkArg1};
 
 static const iocshFuncDef tcLoadRecordsFuncDef      = {"tcLoadRecords", 2, tcLoadRecordsArg};
 static const iocshFuncDef tcSetScanRateFuncDef	    = {"tcSetScanRate", 2, tcSetScanRateArg};
+static const iocshFuncDef tcScatterFuncDef			= {"tcSetScatterThreads", 1, tcScatterArg};
+static const iocshFuncDef tcNotifyFuncDef			= {"tcSetNotify", 1, tcNotifyArg};
+static const iocshFuncDef tcBinaryFuncDef			= {"tcSetBinary", 1, tcBinaryArg};
 static const iocshFuncDef tcListFuncDef				= {"tcGenerateList", 2, tcListArg};
 static const iocshFuncDef tcMacroFuncDef            = {"tcGenerateMacros", 2, tcMacroArg};
 static const iocshFuncDef tcAliasFuncDef            = {"tcSetAlias", 2, tcAliasArg}; 
+static const iocshFuncDef tcUploadFuncDef			= {"tcSymbolUpload", 1, tcUploadArg};
 static const iocshFuncDef tcInfoPrefixFuncDef		= {"tcInfoPrefix", 1, tcInfoPrefixArg};
 static const iocshFuncDef tcPrintValsFuncDef        = {"tcPrintVals", 1, tcPrintValsArg};
 static const iocshFuncDef tcPrintValFuncDef			= {"tcPrintVal", 1, tcPrintValArg};
+static const iocshFuncDef tcPrintRequestsFuncDef	= {"tcPrintRequests", 1, tcPrintRequestsArg};
+static const iocshFuncDef tcDeferredLoadFuncDef		= {"tcSetDeferredLoad", 1, tcDeferredLoadArg};
+static const iocshFuncDef tcLoadAllFuncDef			= {"tcLoadAll", 1, tcLoadAllArg};
+static const iocshFuncDef tcProfileFuncDef			= {"tcProfileStartup", 1, tcProfileArg};
+static const iocshFuncDef tcSimTargetFuncDef		= {"tcSimTarget", 4, tcSimTargetArg};
+static const iocshFuncDef tcSimRateFuncDef			= {"tcSimRate", 1, tcSimRateArg};
+static const iocshFuncDef tcBenchmarkFuncDef		= {"tcBenchmark", 2, tcBenchmarkArg};
 
 /// Tuple for filnemae, rule and list processing 
 using filename_rule_list_tuple = 
@@ -83,11 +127,15 @@ using tc_macro_def = std::vector<dirname_arg_macro_tuple>;
 
 static int scanrate = TcComms::default_scanrate;
 static int multiple = TcComms::default_multiple;
+static int scatterthreads = TcComms::default_scatter_threads;
 static std::stringcase tc_alias;
+static std::stringcase tc_upload;
 static ParseUtil::replacement_rules tc_replacement_rules;
 static tc_listing_def tc_lists;
 static tc_macro_def tc_macros;
 static std::stringcase tc_infoprefix;
+static std::string tc_notify;
+static std::string tc_binary;
 
 
 /** Class for generating an EPICS database and tc record 
@@ -455,6 +503,8 @@ bool epics_tc_db_processing::operator() (const ParseUtil::process_arg& arg) noex
 		rt = plc::data_type_enum::dtDouble;
 	else if (arg.get_type_name().substr(0,6) == "STRING") 
 		rt = plc::data_type_enum::dtString;
+	else if (is_binary_struct (arg)) 
+		rt = plc::data_type_enum::dtBinary;
 	else {
 		printf ("Unknown type %s for %s\n", arg.get_type_name().c_str(), arg.get_name().c_str());
 		++invnum;
@@ -462,12 +512,21 @@ bool epics_tc_db_processing::operator() (const ParseUtil::process_arg& arg) noex
 	}
 
 	try {
-		/// Make new record object
-		plc::BaseRecordPtr pRecord = plc::BaseRecordPtr(new plc::BaseRecord(arg.get_full(), rt));
-		plc::Interface* iface = nullptr;
-
 		/// Make TCat interface
 		const process_arg_tc* targ = dynamic_cast<const process_arg_tc*>(&arg);
+		const bool isArray = (arg.get_process_type() == process_type_enum::pt_array) ||
+			(rt == plc::data_type_enum::dtBinary);
+		if (isArray && !targ) {
+			++invnum;
+			return false;
+		}
+
+		/// Make new record object; arrays use a single binary buffer
+		plc::BaseRecordPtr pRecord = isArray ?
+			plc::BaseRecordPtr(new plc::BaseRecord(arg.get_full(), plc::data_type_enum::dtBinary, targ->get_bytesize())) :
+			plc::BaseRecordPtr(new plc::BaseRecord(arg.get_full(), rt));
+		plc::Interface* iface = nullptr;
+
 		if (targ) {
 			std::stringcase tcatname = arg.get_alias();
 			if (HasRules()) {
@@ -481,6 +540,9 @@ bool epics_tc_db_processing::operator() (const ParseUtil::process_arg& arg) noex
 				arg.get_type_name(),
 				arg.get_process_type() == process_type_enum::pt_binary,
 				arg.get_process_type() == process_type_enum::pt_enum);
+			if (tcat && isArray && (rt != plc::data_type_enum::dtBinary)) {
+				tcat->set_element_type (rt);
+			}
 			iface = tcat;
 		}
 
@@ -545,103 +607,239 @@ void epics_tc_db_processing::flush() noexcept
 
 /// @endcond
 
-/** Function for loading a TCat tpy file, and using it to generate 
-	internal record entries as well as the EPICs .db file
-	@brief Load TwinCAT records
-	@param args Arguments for tcLoadRecords
+/** Uploads the symbol and data type tables from the PLC and stores them
+	in the cache file. Falls back to the cache file, if the PLC is not
+	reachable.
+	@brief Upload symbols
+	@param target ADS address of PLC
+	@param cachefilename Name of cache file
+	@param tpyfile Tpy file structure to fill in (return)
+	@return True if successful
  ************************************************************************/
-void tcLoadRecords (const iocshArgBuf *args) 
+static bool tcUploadSymbols (const std::stringcase& target, 
+							 const std::stringcase& cachefilename,
+							 ParseTpy::tpy_file& tpyfile)
 {
-	// save and reset alias name, listings and macro
-	std::stringcase alias = tc_alias;
-	ParseUtil::replacement_rules rules = tc_replacement_rules;
-	tc_listing_def listings = tc_lists;
-	tc_macro_def macros = tc_macros;
-	std::stringcase infoprefix = tc_infoprefix;
-	tc_alias = "";
-	tc_replacement_rules.clear();
-	tc_lists.clear();
-	tc_macros.clear();
-	tc_infoprefix = "";
+	ParseTpy::symbol_upload symupload;
+	if (!symupload.get_target().set (target)) {
+		printf ("Invalid ADS address %s.\n", target.c_str());
+		return false;
+	}
+	FILE* fp = 0;
+	if (TcComms::upload_symbols (symupload)) {
+		printf ("Uploaded %i bytes of symbols and %i bytes of data types from %s.\n", 
+			(int)symupload.get_symbols().size(), 
+			(int)symupload.get_datatypes().size(), target.c_str());
+		if (fopen_s (&fp, cachefilename.c_str(), "wb") || !symupload.write (fp)) {
+			printf ("Failed to write symbol cache %s.\n", cachefilename.c_str());
+		}
+	}
+	else {
+		const ParseTpy::ads_routing_info addr = symupload.get_target();
+		if (fopen_s (&fp, cachefilename.c_str(), "rb") || !symupload.read (fp) ||
+			(symupload.get_target().get() != addr.get())) {
+			printf ("Unable to upload symbols from %s.\n", target.c_str());
+			if (fp) fclose (fp);
+			return false;
+		}
+		printf ("Using cached symbols from %s.\n", cachefilename.c_str());
+	}
+	if (fp) fclose (fp);
+	if (!tpyfile.parse (symupload)) {
+		printf ("Unable to parse symbols from %s.\n", target.c_str());
+		return false;
+	}
+	return true;
+}
 
-	// Check if Ioc is running
-	if (plc::System::get().is_ioc_running()) {
-        printf ("IOC is already initialized\n");
-        return;
-    }
+/** This structure holds everything needed to load a PLC. It captures
+	the settings of a tcLoadRecords call, so that the generation can 
+	run later and on a different thread.
+	@brief PLC load job
+ ************************************************************************/
+struct tc_load_job {
+	/// Name of tpy file
+	std::stringcase		filename;
+	/// Options for the db generation
+	std::stringcase		options;
+	/// Alias name of PLC
+	std::stringcase		alias;
+	/// Replacement rules
+	ParseUtil::replacement_rules rules;
+	/// Listings
+	tc_listing_def		listings;
+	/// Macros
+	tc_macro_def		macros;
+	/// Info prefix
+	std::stringcase		infoprefix;
+	/// ADS address for symbol upload
+	std::stringcase		upload;
+	/// Scan rate
+	int					scanrate = TcComms::default_scanrate;
+	/// Scan rate multiple
+	int					multiple = TcComms::default_multiple;
+	/// Number of scatter threads
+	int					scatterthreads = TcComms::default_scatter_threads;
+	/// Pattern of symbols updated by ADS notifications
+	std::string			notify;
+	/// Pattern of structures exported as binary records
+	std::string			binary;
+	/// Export all for debugging
+	bool				exportall = false;
+
+	/// Name of generated db file
+	std::stringcase		outfilename;
+	/// Name of symbol cache file
+	std::stringcase		cachefilename;
+	/// Name of manifest file
+	std::stringcase		manifestname;
+	/// PLC (adopted by the system once started)
+	TcComms::TcPLC*		tcplc = nullptr;
+	/// Set when the db file was generated successfully
+	bool				generated = false;
+
+	/// Name of the file the PLC is loaded from (tpy or symbol cache)
+	const std::stringcase& get_plcfilename() const noexcept {
+		return upload.empty() ? filename : cachefilename; }
+};
+
+/// List of queued PLC load jobs
+using tc_load_queue = std::list<tc_load_job>;
 
+static bool tc_deferred_load = false;
+static tc_load_queue tc_load_jobs;
+
+/** Parses the tpy file of a load job and generates the EPICS database, 
+	the listings and the macros. Creates the PLC and its records. This
+	function only touches the job and can run concurrently for 
+	different jobs.
+	@brief Generate PLC records
+	@param job PLC load job
+	@return True if successful
+ ************************************************************************/
+static bool tcGenerateRecords (tc_load_job& job)
+{
+	const char* const fname = job.filename.c_str();
+	startup_profiler::plc_scope profplc (job.get_plcfilename());
 	// open input file
-	if (!args || !args[0].sval || (strlen (args[0].sval) == 0)) {
-        printf("Specify a tpy filename\n");
-		return;
-	}
 	FILE* inpf = 0;
-	if (fopen_s(&inpf, args[0].sval, "r")) {
-		printf ("Failed to open input %s.\n", args[0].sval);
-		return;
-	}
-	for (dirname_arg_macro_tuple& macro : macros) {
-		std::get<const char*>(macro) = args[0].sval;
+	if (job.upload.empty() && fopen_s(&inpf, fname, "r")) {
+		printf ("Failed to open input %s.\n", fname);
+		return false;
 	}
 	
 	// check option arguments
 	optarg options;
-	if (args[1].sval) {
-		options.parse (args[1].sval);
-	}
+	options.parse (job.options.c_str());
 
 	// Timer for just tpy file parsing
-	clock_t tpybegin = 0;
-	clock_t tpyend = 0;
-
-	tpybegin = clock();
+	const auto tpybegin = std::chrono::steady_clock::now();
 
 	// parse tpy file
 	ParseTpy::tpy_file tpyfile;
 	tpyfile.getopt (options.argc(), options.argv(), options.argp());
-	if (!tpyfile.parse (inpf)) {
-		printf ("Unable to parse %s.\n", args[0].sval);
+	if (job.upload.empty()) {
+		if (!tpyfile.parse (inpf)) {
+			printf ("Unable to parse %s.\n", fname);
+			fclose (inpf);
+			return false;
+		}
 		fclose (inpf);
-		return;
+		printf ("Parsed %s: %.1f MB at %.1f MB/s.\n", fname,
+			tpyfile.get_parse_size() / 1E6, tpyfile.get_parse_rate());
 	}
-	fclose (inpf);
 
-	// generate the db filename
-	stringcase outfilename (args[0].sval);
-	stringcase::size_type pos = outfilename.rfind (".tpy");
-	if (pos == outfilename.length() - 4) {
-		outfilename.erase (pos);
+	// upload symbols from PLC
+	if (!job.upload.empty()) {
+		startup_profiler::phase prof ("symbol upload");
+		if (!tcUploadSymbols (job.upload, job.cachefilename, tpyfile)) {
+			return false;
+		}
+	}
+
+	// skip listings and macros which are up to date
+	tc_listing_def& listings = job.listings;
+	tc_macro_def& macros = job.macros;
+	generation_manifest manifest (job.manifestname);
+	generation_manifest::hash_type key = generation_manifest::hash_file (
+		job.upload.empty() ? job.filename : job.cachefilename, 
+		generation_manifest::hash_version());
+	key = generation_manifest::hash (job.options, key);
+	key = generation_manifest::hash (job.alias, key);
+	key = generation_manifest::hash (job.infoprefix, key);
+	key = generation_manifest::hash_rules (job.rules, key);
+	auto list_key = [key](const filename_rule_list_tuple& list) {
+		return generation_manifest::hash (std::get<1>(list), 
+			generation_manifest::hash (std::get<0>(list), 
+			generation_manifest::hash ("list", key))); };
+	auto macro_key = [key](const dirname_arg_macro_tuple& macro) {
+		return generation_manifest::hash (std::get<1>(macro), 
+			generation_manifest::hash (std::get<0>(macro), 
+			generation_manifest::hash ("macros", key))); };
+	std::map<stringcase, std::vector<stringcase>> errorlist_files;
+	for (auto list = listings.begin(); list != listings.end(); ) {
+		if (manifest.is_current (std::get<0>(*list), list_key (*list))) {
+			printf ("Listing %s is up to date.\n", std::get<0>(*list).c_str());
+			list = listings.erase (list);
+		}
+		else {
+			++list;
+		}
+	}
+	for (auto macro = macros.begin(); macro != macros.end(); ) {
+		if (manifest.is_current (std::get<0>(*macro), macro_key (*macro))) {
+			printf ("Macros in %s are up to date.\n", std::get<0>(*macro).c_str());
+			macro = macros.erase (macro);
+		}
+		else {
+			++macro;
+		}
 	}
-	outfilename.append (".db");
 
 	// get ADS parameters
 	stringcase netid = tpyfile.get_project_info().get_netid();
 	const int port = tpyfile.get_project_info().get_port();
 
 	// get plc
-	TcComms::TcPLC* tcplc = new (std::nothrow) TcComms::TcPLC(args[0].sval);
+	if (!job.tcplc) {
+		job.tcplc = new (std::nothrow) TcComms::TcPLC(job.get_plcfilename().c_str());
+	}
+	TcComms::TcPLC* const tcplc = job.tcplc;
 	if (!tcplc) {
-		printf ("Failed to allocate PLC %s.\n", outfilename.c_str());
-		return;
+		printf ("Failed to allocate PLC %s.\n", job.outfilename.c_str());
+		return false;
 	}
 	// set plc parameters
 	tcplc->set_addr(netid, port);
-	tcplc->set_read_scanner_period (scanrate);
-	tcplc->set_write_scanner_period (scanrate);
-	tcplc->set_update_scanner_period (scanrate);
-	tcplc->set_read_scanner_multiple (multiple);
-	tcplc->set_alias (alias);
+	tcplc->set_read_scanner_period (job.scanrate);
+	tcplc->set_write_scanner_period (job.scanrate);
+	tcplc->set_update_scanner_period (job.scanrate);
+	tcplc->set_read_scanner_multiple (job.multiple);
+	tcplc->set_scatter_threads (job.scatterthreads);
+	try {
+		tcplc->set_notify_pattern (job.notify);
+	}
+	catch (...) {
+		printf ("Invalid notification pattern %s\n", job.notify.c_str());
+	}
+	tcplc->set_alias (job.alias);
+	tcplc->set_reload_info (job.options, job.rules);
 	
 	// Set up output db generator
 	try {
-		epics_tc_db_processing dbproc(*tcplc, rules, &listings, &macros);
+		// ends after the output files are closed
+		std::optional<startup_profiler::phase> profwrite;
+		epics_tc_db_processing dbproc(*tcplc, job.rules, &listings, &macros);
 		// option processing
 		dbproc.getopt(options.argc(), options.argv(), options.argp());
+		if (!dbproc.set_binary_pattern (job.binary)) {
+			printf ("Invalid binary structure pattern %s\n", job.binary.c_str());
+		}
 		// force single file
-		split_io_support iosupp(outfilename, false, 0);
+		split_io_support iosupp(job.outfilename, false, 0);
 		if (!iosupp) {
-			printf("Failed to open output %s.\n", outfilename.c_str());
-			return;
+			printf("Failed to open output %s.\n", job.outfilename.c_str());
+			return false;
 		}
 		(split_io_support&)(dbproc) = iosupp;
 		// setup macro processing
@@ -656,78 +854,331 @@ void tcLoadRecords (const iocshArgBuf *args)
 		}
 
 		// generate db file from tc records
-		if (dbg) tpyfile.set_export_all(TRUE);
-		int num = tpyfile.process_symbols(dbproc);
-
-		// generate db file from info records
-		if (!infoprefix.empty()) {
-			dbproc.flush();
-			const bool save_ignore = dbproc.get_ignore();
-			dbproc.set_ignore_all(true);
-			num += InfoPlc::InfoInterface::get_infodb(infoprefix,
-				tpyfile.get_project_info().get(), dbproc);
-			dbproc.set_ignore_all(save_ignore);
+		if (job.exportall) tpyfile.set_export_all(TRUE);
+		int num = 0;
+		{
+			startup_profiler::phase prof ("symbol processing");
+			num = tpyfile.process_symbols(dbproc);
+
+			// generate db file from info records
+			if (!job.infoprefix.empty()) {
+				dbproc.flush();
+				const bool save_ignore = dbproc.get_ignore();
+				dbproc.set_ignore_all(true);
+				num += InfoPlc::InfoInterface::get_infodb(job.infoprefix,
+					tpyfile.get_project_info().get(), dbproc);
+				dbproc.set_ignore_all(save_ignore);
+			}
 		}
 
 		// make sure all file contents is written to file
+		profwrite.emplace ("output writing");
 		dbproc.flush();
+		for (dirname_arg_macro_tuple& macro : macros) {
+			if (std::get<epics_macrofiles_processing*>(macro)) {
+				errorlist_files[std::get<0>(macro)] = 
+					std::get<epics_macrofiles_processing*>(macro)->get_errorlist_files();
+			}
+		}
 
 		// check unused entries in the substitution list
 		dbproc.check_unused_subsititions();
 		// write statistics
 		if (dbproc.get_invalid_records() == 0) {
-			printf("Loaded %i records from %s.\n", num, args[0].sval);
+			printf("Loaded %i records from %s.\n", num, fname);
 		}
 		else {
 			printf("Loaded %i valid and %i invaid records from %s.\n",
-				num, dbproc.get_invalid_records(), args[0].sval);
+				num, dbproc.get_invalid_records(), fname);
 		}
 	}
 	catch (...) {
-		printf("Failed to generate database file %s.\n", outfilename.c_str());
-		return;
+		printf("Failed to generate database file %s.\n", job.outfilename.c_str());
+		return false;
+	}
+
+	// remember the generated listings and macros
+	for (const filename_rule_list_tuple& list : listings) {
+		manifest.set_output (std::get<0>(list), list_key (list),
+			generation_manifest::list_files (std::get<0>(list)));
+	}
+	for (const dirname_arg_macro_tuple& macro : macros) {
+		std::vector<stringcase> files = 
+			generation_manifest::list_files (std::get<0>(macro));
+		const std::vector<stringcase>& errfiles = errorlist_files[std::get<0>(macro)];
+		files.insert (files.end(), errfiles.begin(), errfiles.end());
+		manifest.set_output (std::get<0>(macro), macro_key (macro), files);
+	}
+	if (!manifest.write()) {
+		printf ("Failed to write manifest %s.\n", job.manifestname.c_str());
 	}
 
 	// end timer
-	tpyend = clock();
-	printf("Tpy parsing took %f seconds.\n",((float)(tpyend - tpybegin)/CLOCKS_PER_SEC));
+	printf("Tpy parsing of %s took %f seconds.\n", fname, std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - tpybegin).count());
 
-	//Start scanner
+	// optimize request groups
+	startup_profiler::phase prof ("optimize requests");
 	if (!tcplc->optimizeRequests()) {
 		printf ("Failed to optimize request groups\n");
-		return;
+		return false;
 	}
+	job.generated = true;
+	return true;
+}
 
-	if (!tcplc->start ()) {
-		printf ("Failed to start\n");
+/** Starts the PLC of a generated load job, adds it to the system and 
+	loads its EPICS database. This function must be called from the 
+	IOC shell thread in the order the PLCs were specified.
+	@brief Start PLC and load database
+	@param job PLC load job
+	@return True if successful
+ ************************************************************************/
+static bool tcStartRecords (tc_load_job& job)
+{
+	if (!job.generated || !job.tcplc) {
+		return false;
+	}
+	startup_profiler::plc_scope profplc (job.get_plcfilename());
+	//Start scanner
+	{
+		startup_profiler::phase prof ("ads connect");
+		if (!job.tcplc->start ()) {
+			printf ("Failed to start\n");
 #ifdef DEBUG
-		return;
+			return false;
 #endif
+		}
 	}
 
-	plc::System::get().add(plc::BasePLCPtr(tcplc)); // adopted by TSystem
+	plc::System::get().add(plc::BasePLCPtr(job.tcplc)); // adopted by TSystem
 
 	// load epics database
-	//pos = outfilename.rfind ('\\');
-	//stringcase path;
-	//stringcase fname;
-	//if (pos == stringcase::npos) {
-	//	fname = outfilename;
-	//}
-	//else {
-	//	fname = outfilename.substr (pos + 1);
-	//	path  = outfilename.substr (0, pos);
-	//}
-
-	printf ("Loading record database %s.\n", outfilename.c_str());
-	if (dbLoadRecords (outfilename.c_str(), 0)) {
-		printf ("\nUnable to load record database for %s.\n", outfilename.c_str());
-		return;
-	}
-	printf ("Loaded record database %s.\n", outfilename.c_str());
+	printf ("Loading record database %s.\n", job.outfilename.c_str());
+	startup_profiler::phase prof ("dbLoadRecords");
+	if (dbLoadRecords (job.outfilename.c_str(), 0)) {
+		printf ("\nUnable to load record database for %s.\n", job.outfilename.c_str());
+		return false;
+	}
+	printf ("Loaded record database %s.\n", job.outfilename.c_str());
 	// success!
+	return true;
+}
 
-	return;
+/** Generates and loads all queued PLCs. The records are generated in 
+	parallel, one PLC per thread. The PLCs are then started and their 
+	databases loaded in the order of the tcLoadRecords calls.
+	@brief Load queued PLCs
+	@param threads Maximum number of threads (0 = number of cores)
+	@return Number of loaded PLCs
+ ************************************************************************/
+static int tcLoadQueued (int threads)
+{
+	tc_load_queue jobs;
+	jobs.swap (tc_load_jobs);
+	if (jobs.empty()) {
+		return 0;
+	}
+	const auto begin = std::chrono::steady_clock::now();
+
+	// create the PLCs in order, so that the PLC ids stay the same
+	std::vector<tc_load_job*> todo;
+	for (tc_load_job& job : jobs) {
+		job.tcplc = new (std::nothrow) TcComms::TcPLC(job.get_plcfilename().c_str());
+		todo.push_back (&job);
+	}
+
+	// generate records in parallel
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	if (threads > (int)todo.size()) {
+		threads = (int)todo.size();
+	}
+	std::atomic<size_t> next (0);
+	auto worker = [&todo, &next]() {
+		for (size_t i = next++; i < todo.size(); i = next++) {
+			try {
+				tcGenerateRecords (*todo[i]);
+			}
+			catch (...) {
+				printf ("Failed to generate records for %s.\n", 
+					todo[i]->filename.c_str());
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int i = 1; i < threads; ++i) {
+		try {
+			pool.emplace_back (worker);
+		}
+		catch (...) {
+			break;
+		}
+	}
+	worker();
+	for (std::thread& t : pool) {
+		t.join();
+	}
+
+	// start PLCs and load databases in order
+	int num = 0;
+	for (tc_load_job& job : jobs) {
+		if (tcStartRecords (job)) {
+			++num;
+		}
+	}
+	printf ("Loaded %i of %i PLCs in %f seconds.\n", num, (int)jobs.size(),
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+	return num;
+}
+
+/** Function for loading a TCat tpy file, and using it to generate 
+	internal record entries as well as the EPICs .db file. In deferred
+	mode the PLC is only queued and loaded by tcLoadAll.
+	@brief Load TwinCAT records
+	@param args Arguments for tcLoadRecords
+ ************************************************************************/
+void tcLoadRecords (const iocshArgBuf *args) 
+{
+	// save and reset alias name, listings and macro
+	tc_load_job job;
+	job.alias = tc_alias;
+	job.rules = tc_replacement_rules;
+	job.listings = tc_lists;
+	job.macros = tc_macros;
+	job.infoprefix = tc_infoprefix;
+	job.upload = tc_upload;
+	job.scanrate = scanrate;
+	job.multiple = multiple;
+	job.scatterthreads = scatterthreads;
+	job.notify = tc_notify;
+	job.binary = tc_binary;
+	job.exportall = dbg;
+	tc_alias = "";
+	tc_upload = "";
+	tc_replacement_rules.clear();
+	tc_lists.clear();
+	tc_macros.clear();
+	tc_infoprefix = "";
+	tc_notify.clear();
+	tc_binary.clear();
+
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+        printf ("IOC is already initialized\n");
+        return;
+    }
+
+	// check input file
+	if (!args || !args[0].sval || (strlen (args[0].sval) == 0)) {
+        printf("Specify a tpy filename\n");
+		return;
+	}
+	job.filename = args[0].sval;
+	job.options = args[1].sval ? args[1].sval : "";
+
+	// generate the db filename
+	stringcase outfilename (job.filename);
+	stringcase::size_type pos = outfilename.rfind (".tpy");
+	if (pos == outfilename.length() - 4) {
+		outfilename.erase (pos);
+	}
+	job.cachefilename = outfilename + ".sym";
+	job.manifestname = outfilename + generation_manifest::extension;
+	job.outfilename = outfilename + ".db";
+
+	// queue the PLC
+	if (tc_deferred_load) {
+		if (job.upload.empty() && !std::filesystem::exists (job.filename.c_str())) {
+			printf ("Failed to open input %s.\n", job.filename.c_str());
+			return;
+		}
+		tc_load_jobs.push_back (std::move (job));
+		tc_load_job& queued = tc_load_jobs.back();
+		for (dirname_arg_macro_tuple& macro : queued.macros) {
+			std::get<const char*>(macro) = queued.filename.c_str();
+		}
+		printf ("Queued %s for loading.\n", queued.filename.c_str());
+		return;
+	}
+
+	// or load it right away
+	for (dirname_arg_macro_tuple& macro : job.macros) {
+		std::get<const char*>(macro) = job.filename.c_str();
+	}
+	if (tcGenerateRecords (job)) {
+		tcStartRecords (job);
+	}
+}
+
+/** Switches deferred loading on or off. In deferred mode tcLoadRecords
+	only queues a PLC. The queued PLCs are loaded concurrently by 
+	tcLoadAll, which must be called before iocInit.
+	@brief Set deferred loading
+	@param args Arguments for tcSetDeferredLoad
+ ************************************************************************/
+void tcSetDeferredLoad (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf ("IOC is already initialized\n");
+		return;
+	}
+	const char* p1 = args ? args[0].sval : nullptr;
+	tc_deferred_load = !p1 || (strtol (p1, nullptr, 10) != 0);
+	if (tc_deferred_load) {
+		printf ("tcLoadRecords queues PLCs until tcLoadAll.\n");
+	}
+	else {
+		printf ("tcLoadRecords loads PLCs immediately.\n");
+	}
+}
+
+/** Loads all PLCs queued by tcLoadRecords in deferred mode
+	@brief Load all queued PLCs
+	@param args Arguments for tcLoadAll
+ ************************************************************************/
+void tcLoadAll (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf ("IOC is already initialized\n");
+		return;
+	}
+	int threads = 0;
+	const char* p1 = args ? args[0].sval : nullptr;
+	if (p1) {
+		char* pp;
+		threads = strtol (p1, &pp, 10);
+		if (*pp) {
+			printf("Number of threads must be an integer %s\n", p1);
+			return;
+		}
+	}
+	if (tc_load_jobs.empty()) {
+		printf ("No PLCs are queued for loading.\n");
+		return;
+	}
+	tcLoadQueued (threads);
+}
+
+/** Enables the startup profiler. The time and memory of each startup 
+	phase are recorded per PLC. A summary is printed once the IOC is 
+	running, and written to a JSON file if a filename is given.
+	@brief Profile the startup
+	@param args Arguments for tcProfileStartup
+ ************************************************************************/
+void tcProfileStartup (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf ("IOC is already initialized\n");
+		return;
+	}
+	const char* p1 = args ? args[0].sval : nullptr;
+	startup_profiler::get().enable (p1 ? p1 : "");
+	printf ("Profiling the startup.\n");
 }
 
 /** Set scan rate of the read scanner
@@ -787,6 +1238,109 @@ void tcSetScanRate (const iocshArgBuf *args) noexcept
     return;
 }
 
+/** Set the number of worker threads which distribute the read data
+	to the records. This only pays off for PLCs with a very large number 
+	of records. Applies to all subsequently loaded PLCs.
+	@brief Set the number of scatter threads
+ 	@param args Arguments for tcSetScatterThreads
+************************************************************************/
+void tcSetScatterThreads (const iocshArgBuf *args) noexcept
+{
+	// Check if Ioc is running
+    if (plc::System::get().is_ioc_running()) {
+        printf ("IOC is already initialized\n");
+        return;
+    }
+
+	// Check arguments
+	const char* p1 = args ? args[0].sval : nullptr;
+	if (!p1) {
+        printf("Specify the number of scatter threads\n");
+		return;
+	}
+	// Convert to number
+	char* pp;
+	const int num = strtol (p1, &pp, 10);
+	if (*pp) {
+        printf("Number of scatter threads must be an integer %s\n", p1);
+		return;
+	}
+	scatterthreads = num;
+	if (scatterthreads < 0) {
+		scatterthreads = 0;
+	}
+	if (scatterthreads > TcComms::maximum_scatter_threads) {
+		scatterthreads = TcComms::maximum_scatter_threads;
+        printf("Number of scatter threads set to maximum %i\n", scatterthreads);
+	}
+
+	if (scatterthreads > 0) {
+		printf ("Read data is distributed by %i scatter threads.\n", scatterthreads);
+	}
+	else {
+		printf ("Read data is distributed by the read scanner.\n");
+	}
+    return;
+}
+
+/** Selects the symbols of the next PLC which are updated by ADS 
+	notifications instead of polling. Their records are time stamped with 
+	the sample time of the PLC. Applies to the next tcLoadRecords.
+	@brief Set the notification mode symbols
+ 	@param args Arguments for tcSetNotify
+************************************************************************/
+void tcSetNotify (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf("IOC is already initialized\n");
+		return;
+	}
+	// Check arguments
+	const char* p1 = args ? args[0].sval : nullptr;
+	if (!p1) {
+		printf("Specify a regular expression of TwinCAT names\n");
+		return;
+	}
+	try {
+		std::regex test (p1);
+	}
+	catch (...) {
+		printf("Invalid regular expression %s\n", p1);
+		return;
+	}
+	tc_notify = p1;
+}
+
+/** Selects the structures of the next PLC which are exported as a single
+	binary waveform record in addition to their elements. Applies to the 
+	next tcLoadRecords.
+	@brief Set the binary structure records
+ 	@param args Arguments for tcSetBinary
+************************************************************************/
+void tcSetBinary (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf("IOC is already initialized\n");
+		return;
+	}
+	// Check arguments
+	const char* p1 = args ? args[0].sval : nullptr;
+	if (!p1) {
+		printf("Specify a regular expression of TwinCAT structure names\n");
+		return;
+	}
+	try {
+		std::regex test (p1);
+	}
+	catch (...) {
+		printf("Invalid regular expression %s\n", p1);
+		return;
+	}
+	tc_binary = p1;
+}
+
 /** List function to generate separate listings
     @brief Generate channel lists
 	@param args Arguments for tcList
@@ -871,6 +1425,149 @@ void tcAlias (const iocshArgBuf *args)
 }
 
 
+/** Uploads the symbols from the PLC for the next tcLoadRecords, 
+	instead of parsing the tpy file
+	@brief Use ADS symbol upload
+ 	@param args Arguments for tcSymbolUpload
+************************************************************************/
+void tcSymbolUpload (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf("IOC is already initialized\n");
+		return;
+	}
+	// Check arguments
+	if (!args || !args[0].sval) {
+		printf("Specify an ADS address of the form tc://netid:port/\n");
+		return;
+	}
+	ParseTpy::ads_routing_info addr;
+	if (!addr.set (args[0].sval)) {
+		printf("Invalid ADS address %s\n", args[0].sval);
+		return;
+	}
+	tc_upload = addr.get();
+}
+
+/** Serves an ADS address by a simulated target instead of the ADS 
+	router. The memory is loaded from an optional image file and the 
+	values of the attached records are changed at the given rate. The
+	symbol upload is served from an optional tpy file.
+	@brief Simulate an ADS target
+ 	@param args Arguments for tcSimTarget
+************************************************************************/
+void tcSimAddTarget (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (plc::System::get().is_ioc_running()) {
+		printf("IOC is already initialized\n");
+		return;
+	}
+	// Check arguments
+	if (!args || !args[0].sval) {
+		printf("Specify an ADS address of the form tc://netid:port/\n");
+		return;
+	}
+	ParseTpy::ads_routing_info ads;
+	AmsAddr addr = {};
+	if (!ads.set (args[0].sval) || !ads.get (addr.netId.b[0], addr.netId.b[1], 
+		addr.netId.b[2], addr.netId.b[3], addr.netId.b[4], addr.netId.b[5])) {
+		printf("Invalid ADS address %s\n", args[0].sval);
+		return;
+	}
+	addr.port = ads.get_port();
+	double rate = 0;
+	if (args[2].sval) {
+		char* pp;
+		rate = strtod (args[2].sval, &pp);
+		if (*pp || (rate < 0)) {
+			printf("Invalid rate %s\n", args[2].sval);
+			return;
+		}
+	}
+	TcComms::tcSimTarget* const sim = TcComms::tcSimulation::get().add (addr);
+	if (!sim) {
+		printf("Failed to add simulated target %s\n", args[0].sval);
+		return;
+	}
+	if (args[1].sval && *args[1].sval && !sim->load_image (args[1].sval)) {
+		printf("Failed to load memory image %s\n", args[1].sval);
+	}
+	if (args[3].sval && *args[3].sval && !sim->load_symbols (args[3].sval)) {
+		printf("Failed to load symbols from %s\n", args[3].sval);
+	}
+	sim->set_rate (rate);
+	printf("Simulating ADS target %s at %g changes/s\n", ads.get().c_str(), rate);
+}
+
+/** Sets the number of value changes per second of all simulated targets
+	@brief Set the simulation rate
+ 	@param args Arguments for tcSimRate
+************************************************************************/
+void tcSimRate (const iocshArgBuf *args)
+{
+	const char* p1 = args ? args[0].sval : nullptr;
+	if (!p1) {
+		printf("Specify the number of value changes per second\n");
+		return;
+	}
+	char* pp;
+	const double rate = strtod (p1, &pp);
+	if (*pp || (rate < 0)) {
+		printf("Invalid rate %s\n", p1);
+		return;
+	}
+	if (!TcComms::tcSimulation::get().is_active()) {
+		printf("No simulated ADS target\n");
+		return;
+	}
+	TcComms::tcSimulation::get().set_rate (rate);
+}
+
+/** Runs the throughput benchmark against the simulated targets. Prints
+	the results and writes them to a JSON file if a filename is given.
+	Blocks for the duration of the benchmark.
+	@brief Run the IOC benchmark
+ 	@param args Arguments for tcBenchmark
+************************************************************************/
+void tcRunBenchmark (const iocshArgBuf *args)
+{
+	// Check if Ioc is running
+	if (!plc::System::get().is_ioc_running()) {
+		printf("IOC is not initialized\n");
+		return;
+	}
+	double seconds = 10;
+	if (args && args[0].sval) {
+		char* pp;
+		seconds = strtod (args[0].sval, &pp);
+		if (*pp || (seconds <= 0)) {
+			printf("Invalid duration %s\n", args[0].sval);
+			return;
+		}
+	}
+	try {
+		DevTc::tcBenchmark bench;
+		if (!bench.run (seconds)) {
+			printf("Benchmark failed\n");
+			return;
+		}
+		bench.print (stdout);
+		if (args && args[1].sval && *args[1].sval) {
+			if (bench.write_json (args[1].sval)) {
+				printf("Benchmark results written to %s\n", args[1].sval);
+			}
+			else {
+				printf("Failed to write %s\n", args[1].sval);
+			}
+		}
+	}
+	catch (...) {
+		printf("Benchmark failed\n");
+	}
+}
+
 /** Sets the channel prefix for info PLC records
 	@brief Sets the info prefix
  	@param args Arguments for tcInfoPrefix
@@ -930,19 +1627,62 @@ void tcPrintVal (const iocshArgBuf *args)
 	return;
 }
 
+/** Debugging function that prints the read request groups of the PLCs.
+	By default only request groups which were split due to read errors
+	are listed together with their quarantined records.
+	@brief Print read requests
+	@param args Arguments for tcPrintRequests
+ ************************************************************************/
+void tcPrintRequests (const iocshArgBuf *args)
+{
+	const bool all = args && args[0].sval && (std::stringcase (args[0].sval) == "all");
+	plc::System::get().for_each (
+		[all] (plc::BasePLC* plc) {
+			TcComms::TcPLC* tcplc = dynamic_cast<TcComms::TcPLC*>(plc);
+			if (tcplc) tcplc->printRequests (all);
+		});
+	return;
+}
+
 /*  Process hook
     @brief piniProcessHook
  ************************************************************************/
 
+/// Start of iocInit for the startup profiler
+static std::chrono::steady_clock::time_point iocinit_start;
+/// The iocInit phase has been profiled (iocRun after iocPause runs the hook again)
+static bool iocinit_profiled = false;
+
 #pragma warning (disable : 26812)
 static void piniProcessHook (initHookState state) noexcept
 {
     switch (state) {
+	case initHookAtBeginning:
+		// databases cannot be loaded once iocInit has started
+		if (!tc_load_jobs.empty()) {
+			printf ("ERROR: %i PLCs are still queued and not loaded, call tcLoadAll before iocInit\n",
+				(int)tc_load_jobs.size());
+			tc_load_jobs.clear();
+		}
+		iocinit_start = std::chrono::steady_clock::now();
+		break;
+
     case initHookAtIocRun:
         break;
 
     case initHookAfterIocRunning:
 		plc::System::get().set_ioc_state (true);
+		if (startup_profiler::get().is_enabled() && !iocinit_profiled) {
+			iocinit_profiled = true;
+			try {
+				startup_profiler::get().add ("", "iocInit", 
+					std::chrono::duration<double>(
+					std::chrono::steady_clock::now() - iocinit_start).count(), 0);
+				startup_profiler::get().report();
+			}
+			catch (...) {
+			}
+		}
         break;
 
     case initHookAtIocPause:
@@ -969,12 +1709,23 @@ tcRegisterToIocShell::tcRegisterToIocShell () noexcept
 {
     iocshRegister(&tcLoadRecordsFuncDef, tcLoadRecords);
     iocshRegister(&tcSetScanRateFuncDef, tcSetScanRate);
+    iocshRegister(&tcScatterFuncDef, tcSetScatterThreads);
+    iocshRegister(&tcNotifyFuncDef, tcSetNotify);
+    iocshRegister(&tcBinaryFuncDef, tcSetBinary);
     iocshRegister(&tcAliasFuncDef, tcAlias);
     iocshRegister(&tcListFuncDef, tcList);
     iocshRegister(&tcMacroFuncDef, tcMacro);
+	iocshRegister(&tcUploadFuncDef, tcSymbolUpload);
 	iocshRegister(&tcInfoPrefixFuncDef, tcInfoPrefix);
 	iocshRegister(&tcPrintValsFuncDef, tcPrintVals);
 	iocshRegister(&tcPrintValFuncDef, tcPrintVal);
+	iocshRegister(&tcPrintRequestsFuncDef, tcPrintRequests);
+	iocshRegister(&tcDeferredLoadFuncDef, tcSetDeferredLoad);
+	iocshRegister(&tcLoadAllFuncDef, tcLoadAll);
+	iocshRegister(&tcProfileFuncDef, tcProfileStartup);
+	iocshRegister(&tcSimTargetFuncDef, tcSimAddTarget);
+	iocshRegister(&tcSimRateFuncDef, tcSimRate);
+	iocshRegister(&tcBenchmarkFuncDef, tcRunBenchmark);
 	initHookRegister(piniProcessHook);
 }
 
@@ -985,3 +1736,34 @@ tcRegisterToIocShell tcRegisterToIocShell::gtcRegisterToIocShell;
 
 /** @} */
 
+/* tcGetRecordLocation
+ ************************************************************************/
+int tcGetRecordLocation (const char* recname, unsigned long* group,
+	unsigned long* offset, unsigned long* size, unsigned long* reloads)
+{
+	if (!recname || !group || !offset || !size || !reloads || !pdbbase) {
+		return -1;
+	}
+	// only the tcat device support points dpvt at a base record
+	dbCommon* prec = nullptr;
+	DBENTRY entry;
+	dbInitEntry (pdbbase, &entry);
+	if (!dbFindRecord (&entry, recname) && !dbFindField (&entry, "DTYP")) {
+		const char* const dtyp = dbGetString (&entry);
+		if (dtyp && (strcmp (dtyp, "tcat") == 0) && entry.precnode) {
+			prec = static_cast<dbCommon*>(entry.precnode->precord);
+		}
+	}
+	dbFinishEntry (&entry);
+	if (!prec || !prec->dpvt) {
+		return -1;
+	}
+	const plc::BaseRecord* const rec = static_cast<const plc::BaseRecord*>(prec->dpvt);
+	const TcComms::TCatInterface* const tcat = 
+		dynamic_cast<const TcComms::TCatInterface*>(rec->get_plcInterface());
+	const TcComms::TcPLC* const plc = tcat ? tcat->get_parent() : nullptr;
+	if (!plc || !plc->get_location (*tcat, *group, *offset, *size, *reloads)) {
+		return -1;
+	}
+	return 0;
+}
@@ -746,11 +746,198 @@ void InfoInterface::printVal (FILE* fp)
 	fprintf(fp, "\n");
 }
 
+constexpr time_t WINDOWS_TICK = 10'000'000;
+constexpr time_t SEC_TO_UNIX_EPOCH = 11'644'473'600LL;
+static constexpr time_t FileTimeToUnixSeconds(time_t windowsTicks) noexcept
+{
+	return (time_t)(windowsTicks / WINDOWS_TICK - SEC_TO_UNIX_EPOCH);
+}
+static errno_t GetFileTimeUnix (tm& utc, time_t ftime) noexcept
+{
+	if (ftime < 1000'000'000'000LL) {
+		if (gmtime_s(&utc, &ftime) == 0) {
+			return 0;
+		}
+	}
+	else {
+		const time_t unixt = FileTimeToUnixSeconds(ftime);
+		if (gmtime_s(&utc, &unixt) == 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/// Sets a value and marks it as changed, if it differs from the old one
+template <typename T>
+static void set_info_value (info_values& v, info_field f, T& dest, 
+	const T& src, int pri = 0) noexcept
+{
+	if (dest != src) {
+		dest = src;
+		v.changed |= info_values::mask (f, pri);
+	}
+}
+
+/// Sets a string value and marks it as changed, if it differs from the old one
+template <std::size_t N>
+static void set_info_string (info_values& v, info_field f, char (&dest)[N], 
+	const char* src) noexcept
+{
+	if (strncmp (dest, src, N) != 0) {
+		strncpy (dest, src, N - 1);
+		dest[N - 1] = 0;
+		v.changed |= info_values::mask (f);
+	}
+}
+
+/// Sets the broken down time fields and marks the changed ones
+static void set_info_time (info_values& v, tm& dest, const tm& src, 
+	info_field year) noexcept
+{
+	const int y = (int)year;
+	set_info_value (v, info_field (y), dest.tm_year, src.tm_year);
+	set_info_value (v, info_field (y + 1), dest.tm_mon, src.tm_mon);
+	set_info_value (v, info_field (y + 2), dest.tm_mday, src.tm_mday);
+	set_info_value (v, info_field (y + 3), dest.tm_hour, src.tm_hour);
+	set_info_value (v, info_field (y + 4), dest.tm_min, src.tm_min);
+	set_info_value (v, info_field (y + 5), dest.tm_sec, src.tm_sec);
+}
+
+/* info_snapshot::update
+ ************************************************************************/
+void info_snapshot::update (const TcComms::TcPLC& tc) noexcept
+{
+	try {
+		// only the read scanner updates, so the inactive buffer is ours
+		const int cur = active.load (std::memory_order_relaxed);
+		info_values& v = values[1 - cur];
+		const bool first = !values[cur].valid;
+		v = values[cur];
+		v.changed = first ? ~std::uint64_t(0) : 0;
+		v.valid = true;
+
+		// ADS state
+		set_info_value (v, info_field::ads_state, v.ads_state, (int)tc.get_ads_state());
+
+		// PLC time stamp: only broken down when it changes
+		const time_t tstamp = tc.get_timestamp_unix();
+		if (first || (tstamp != v.timestamp)) {
+			v.timestamp = tstamp;
+			tm utc{};
+			char buf[100]{};
+			if (gmtime_s (&utc, &tstamp) == 0) {
+				set_info_time (v, v.timestamp_utc, utc, info_field::timestamp_year);
+				strftime (buf, sizeof (buf), "%F %T", &utc);
+				buf[99] = 0;
+				set_info_string (v, info_field::timestamp_str, v.timestamp_str, buf);
+			}
+			tm local{};
+			if (localtime_s (&local, &tstamp) == 0) {
+				strftime (buf, sizeof (buf), "%c", &local);
+				buf[99] = 0;
+				set_info_string (v, info_field::timestamp_local, v.timestamp_local, buf);
+			}
+		}
+
+		// scanner rates and records
+		set_info_value (v, info_field::rate_read, v.rate_read, 
+			tc.get_read_scanner_period() * tc.get_read_scanner_multiple());
+		set_info_value (v, info_field::rate_write, v.rate_write, tc.get_write_scanner_period());
+		set_info_value (v, info_field::rate_update, v.rate_update, tc.get_update_scanner_period());
+		set_info_value (v, info_field::records_num, v.records_num, tc.count());
+
+		// tpy file
+		if (first || (v.tpy_path != tc.get_tpyfilename())) {
+			v.tpy_path = tc.get_tpyfilename();
+			string tpyfname = v.tpy_path;
+			string::size_type pos = 0;
+			while ((tpyfname.size() >= 40) &&
+				((pos = tpyfname.find('\\')) != string::npos)) {
+				tpyfname.erase(0, pos + 1);
+			}
+			if (tpyfname.size() >= 40) {
+				tpyfname.erase(39, string::npos);
+			}
+			set_info_value (v, info_field::tpy_filename, v.tpy_filename, tpyfname);
+		}
+		set_info_value (v, info_field::tpy_valid, v.tpy_valid, tc.is_tpyfile_valid());
+		const time_t ftime = tc.get_tpyfile_time();
+		if (first || (ftime != v.tpy_time)) {
+			v.tpy_time = ftime;
+			tm utc{};
+			char buf[100]{};
+			if (GetFileTimeUnix (utc, ftime) == 0) {
+				set_info_time (v, v.tpy_time_utc, utc, info_field::tpy_time_year);
+				strftime (buf, sizeof (buf), "%F %T", &utc);
+				buf[99] = 0;
+				set_info_string (v, info_field::tpy_time_str, v.tpy_time_str, buf);
+			}
+		}
+
+		// ADS address
+		const AmsAddr addr = tc.get_addr();
+		set_info_value (v, info_field::ads_port, v.ads_port, (int)addr.port);
+		if (first || (memcmp (v.ads_netid, addr.netId.b, sizeof (v.ads_netid)) != 0)) {
+			memcpy (v.ads_netid, addr.netId.b, sizeof (v.ads_netid));
+			char buf[40]{};
+			snprintf(buf, sizeof(buf), "%u.%u.%u.%u.%u.%u",
+				addr.netId.b[0], addr.netId.b[1], addr.netId.b[2],
+				addr.netId.b[3], addr.netId.b[4], addr.netId.b[5]);
+			set_info_string (v, info_field::ads_netid, v.ads_netid_str, buf);
+		}
+
+		// callback queues
+		for (int pri = 0; pri < callback_queue_num; ++pri) {
+			info_queue_stats& q = v.callback_queue[pri];
+			const int size = get_callback_queue_size (pri);
+			const int used = get_callback_queue_used (pri);
+			const int max = get_callback_queue_highwatermark (pri);
+			set_info_value (v, info_field::callback_queue_size, q.size, size, pri);
+			set_info_value (v, info_field::callback_queue_used, q.used, used, pri);
+			set_info_value (v, info_field::callback_queue_max, q.max, max, pri);
+			set_info_value (v, info_field::callback_queue_overflow, q.overflow, 
+				get_callback_queue_overflow (pri), pri);
+			set_info_value (v, info_field::callback_queue_free, q.free, 
+				get_callback_queue_free (pri), pri);
+			const double sz = (double)size;
+			set_info_value (v, info_field::callback_queue_percent, q.percent, 
+				((sz > 1.0) && (used > 1)) ? (double)used / sz : -1.0, pri);
+			set_info_value (v, info_field::callback_queue_max_prcnt, q.max_prcnt, 
+				((sz > 1.0) && (max > 1)) ? (double)max / sz : -1.0, pri);
+		}
+
+		// publish
+		active.store (1 - cur, std::memory_order_release);
+	}
+	catch (...) {
+	}
+}
+
+/* InfoInterface::get_tcplc
+ ************************************************************************/
+const TcComms::TcPLC* InfoInterface::get_tcplc() noexcept
+{
+	if (!tcplc) {
+		tcplc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
+	}
+	return tcplc;
+}
+
+/* InfoInterface::get_values
+ ************************************************************************/
+const info_values* InfoInterface::get_values() noexcept
+{
+	const TcComms::TcPLC* const tc = get_tcplc();
+	if (!tc) return nullptr;
+	return &tc->get_info_snapshot().get();
+}
+
 /* InfoInterface::info_update_name
  ************************************************************************/
 bool InfoInterface::info_update_name () noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
+	const TcComms::TcPLC* const tc = get_tcplc();
 	if (!tc) return false;
 	return record.PlcWrite(tc->get_name().c_str(), tc->get_name().size());
 }
@@ -759,7 +946,7 @@ bool InfoInterface::info_update_name () noexcept
  ************************************************************************/
 bool InfoInterface::info_update_alias() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
+	const TcComms::TcPLC* const tc = get_tcplc();
 	if (!tc) return false;
 	return record.PlcWrite(tc->get_alias().c_str(), tc->get_alias().size());
 }
@@ -768,20 +955,19 @@ bool InfoInterface::info_update_alias() noexcept
  ************************************************************************/
 bool InfoInterface::info_update_active() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const bool active = (tc->get_ads_state() == ADSSTATE_RUN);
-	return record.PlcWrite(active);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	const bool active = (v->ads_state == ADSSTATE_RUN);
+	return write_changed (*v, info_field::ads_state, 0, active);
 }
 
 /* InfoInterface::info_update_state
  ************************************************************************/
 bool InfoInterface::info_update_state() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const int state = tc->get_ads_state();
-	return record.PlcWrite(state);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_state, 0, v->ads_state);
 }
 
 /* InfoInterface::info_update_statestr
@@ -789,9 +975,10 @@ bool InfoInterface::info_update_state() noexcept
 bool InfoInterface::info_update_statestr() noexcept
 {
 	try {
-		const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-		if (!tc) return false;
-		const int state = tc->get_ads_state();
+		const info_values* const v = get_values();
+		if (!v) return false;
+		if (written && !v->is_changed (info_field::ads_state)) return true;
+		const int state = v->ads_state;
 		string str;
 		switch (state) {
 		case 0:
@@ -852,7 +1039,8 @@ bool InfoInterface::info_update_statestr() noexcept
 			str = "UNKNOWN";
 			break;
 		}
-		return record.PlcWrite(str);
+		written = record.PlcWrite(str);
+		return written;
 	}
 	catch (...) {
 		return false;
@@ -863,313 +1051,189 @@ bool InfoInterface::info_update_statestr() noexcept
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_str() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc{};
-	char buf[100]{};
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		strftime(buf, sizeof(buf), "%F %T", &utc);
-		buf[99] = 0;
-		return record.PlcWrite(buf, sizeof (buf));
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_str, 0, v->timestamp_str, sizeof (v->timestamp_str));
 }
 
 /* InfoInterface::info_update_timestamp_local
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_local() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm local{};
-	char buf[100]{};
-	if (localtime_s(&local, &tstamp) == 0) {
-		strftime(buf, sizeof(buf), "%c", &local);
-		buf[99] = 0;
-		return record.PlcWrite(buf, sizeof(buf));
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_local, 0, v->timestamp_local, sizeof (v->timestamp_local));
 }
 
 /* InfoInterface::info_update_timestamp_year
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_year() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_year + 1900);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_year, 0, v->timestamp_utc.tm_year + 1900);
 }
 
 /* InfoInterface::info_update_timestamp_month
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_month() noexcept
 {
-	const TcComms::TcPLC* tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_mon + 1);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_month, 0, v->timestamp_utc.tm_mon + 1);
 }
 
 /* InfoInterface::info_update_timestamp_day
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_day() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_mday);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_day, 0, v->timestamp_utc.tm_mday);
 }
 
 /* InfoInterface::info_update_timestamp_hour
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_hour() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_hour);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_hour, 0, v->timestamp_utc.tm_hour);
 }
 
 /* InfoInterface::info_update_timestamp_min
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_min() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_min);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_min, 0, v->timestamp_utc.tm_min);
 }
 
 /* InfoInterface::info_update_timestamp_sec
  ************************************************************************/
 bool InfoInterface::info_update_timestamp_sec() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_timestamp_unix();
-	tm utc;
-	if (gmtime_s(&utc, &tstamp) == 0) {
-		return record.PlcWrite(utc.tm_sec);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::timestamp_sec, 0, v->timestamp_utc.tm_sec);
 }
 
 /* InfoInterface::info_update_rate_read
  ************************************************************************/
 bool InfoInterface::info_update_rate_read() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const int rate = tc->get_read_scanner_period() * tc->get_read_scanner_multiple();
-	return record.PlcWrite (rate);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::rate_read, 0, v->rate_read);
 }
 
 /* InfoInterface::info_update_rate_write
  ************************************************************************/
 bool InfoInterface::info_update_rate_write() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const int rate = tc->get_write_scanner_period();
-	return record.PlcWrite(rate);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::rate_write, 0, v->rate_write);
 }
 
 /* InfoInterface::info_update_rate_update
  ************************************************************************/
 bool InfoInterface::info_update_rate_update() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const int rate = tc->get_update_scanner_period();
-	return record.PlcWrite(rate);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::rate_update, 0, v->rate_update);
 }
 
 /* InfoInterface::info_update_records_num
  ************************************************************************/
 bool InfoInterface::info_update_records_num() noexcept
 {
-	const TcComms::TcPLC* tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const int rate = tc->count();
-	return record.PlcWrite(rate);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::records_num, 0, v->records_num);
 }
 
 /* InfoInterface::info_update_tpy_filename
  ************************************************************************/
 bool InfoInterface::info_update_tpy_filename() noexcept
 {
-	try {
-		const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-		if (!tc) return false;
-		string tpyfname = tc->get_tpyfilename();
-		string::size_type pos = 0;
-		while ((tpyfname.size() >= 40) &&
-			((pos = tpyfname.find('\\')) != string::npos)) {
-			tpyfname.erase(0, pos + 1);
-		}
-		if (tpyfname.size() >= 40) {
-			tpyfname.erase(39, string::npos);
-		}
-		return record.PlcWrite(tpyfname);
-	}
-	catch (...) {
-		return false;
-	}
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_filename, 0, v->tpy_filename);
 }
 
 /* InfoInterface::info_update_tpy_valid
  ************************************************************************/
 bool InfoInterface::info_update_tpy_valid() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const bool tpyvalid = tc->is_tpyfile_valid();
-	return record.PlcWrite(tpyvalid);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_valid, 0, v->tpy_valid);
 }
 
 /* InfoInterface::info_update_tpy_time_str
  ************************************************************************/
-constexpr time_t WINDOWS_TICK = 10'000'000;
-constexpr time_t SEC_TO_UNIX_EPOCH = 11'644'473'600LL;
-static constexpr time_t FileTimeToUnixSeconds(time_t windowsTicks) noexcept
-{
-	return (time_t)(windowsTicks / WINDOWS_TICK - SEC_TO_UNIX_EPOCH);
-}
-static errno_t GetFileTimeUnix (tm& utc, time_t ftime) noexcept
-{
-	if (ftime < 1000'000'000'000LL) {
-		if (gmtime_s(&utc, &ftime) == 0) {
-			return 0;
-		}
-	}
-	else {
-		const time_t unixt = FileTimeToUnixSeconds(ftime);
-		if (gmtime_s(&utc, &unixt) == 0) {
-			return 0;
-		}
-	}
-	return 1;
-}
 bool InfoInterface::info_update_tpy_time_str() noexcept
 {
-	const TcComms::TcPLC* tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc{};
-	char buf[100]{};
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		strftime(buf, sizeof(buf), "%F %T", &utc);
-		buf[99] = 0;
-		return record.PlcWrite(buf, sizeof(buf));
-	} 
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_str, 0, v->tpy_time_str, sizeof (v->tpy_time_str));
 }
 
 /* InfoInterface::info_update_tpy_time_year
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_year() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_year + 1900);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_year, 0, v->tpy_time_utc.tm_year + 1900);
 }
 
 /* InfoInterface::info_update_tpy_time_month
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_month() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_mon + 1);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_month, 0, v->tpy_time_utc.tm_mon + 1);
 }
 
 /* InfoInterface::info_update_tpy_time_day
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_day() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_mday);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_day, 0, v->tpy_time_utc.tm_mday);
 }
 
 /* InfoInterface::info_update_tpy_time_hour
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_hour() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_hour);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_hour, 0, v->tpy_time_utc.tm_hour);
 }
 
 /* InfoInterface::info_update_tpy_time_min
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_min() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_min);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_min, 0, v->tpy_time_utc.tm_min);
 }
 
 /* InfoInterface::info_update_tpy_time_sec
  ************************************************************************/
 bool InfoInterface::info_update_tpy_time_sec() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const time_t tstamp = tc->get_tpyfile_time();
-	tm utc;
-	if (GetFileTimeUnix(utc, tstamp) == 0) {
-		return record.PlcWrite(utc.tm_sec);
-	}
-	return false;
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::tpy_time_sec, 0, v->tpy_time_utc.tm_sec);
 }
 
 /* InfoInterface::info_update_ads_version
@@ -1200,90 +1264,72 @@ bool InfoInterface::info_update_ads_build() noexcept
  ************************************************************************/
 bool InfoInterface::info_update_ads_port() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.port);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_port, 0, v->ads_port);
 }
 
 /* InfoInterface::info_update_ads_netid_str
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_str() noexcept
 {
-	try {
-		const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-		if (!tc) return false;
-		const AmsAddr addr = tc->get_addr();
-		char buf[100]{};
-		snprintf(buf, sizeof(buf), "%u.%u.%u.%u.%u.%u",
-			addr.netId.b[0], addr.netId.b[1], addr.netId.b[2],
-			addr.netId.b[3], addr.netId.b[4], addr.netId.b[5]);
-		string netid(buf);
-		return record.PlcWrite(netid);
-	}
-	catch(...) {
-		return false;
-	}
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid_str, sizeof (v->ads_netid_str));
 }
 
 /* InfoInterface::info_update_ads_netid_b0
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b0() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[0]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[0]);
 }
 
 /* InfoInterface::info_update_ads_netid_b1
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b1() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[1]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[1]);
 }
 
 /* InfoInterface::info_update_ads_netid_b2
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b2() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[2]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[2]);
 }
 
 /* InfoInterface::info_update_ads_netid_b3
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b3() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[3]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[3]);
 }
 
 /* InfoInterface::info_update_ads_netid_b4
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b4() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[4]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[4]);
 }
 
 /* InfoInterface::info_update_ads_netid_b5
  ************************************************************************/
 bool InfoInterface::info_update_ads_netid_b5() noexcept
 {
-	const TcComms::TcPLC* const tc = dynamic_cast<const TcComms::TcPLC*>(get_parent());
-	if (!tc) return false;
-	const AmsAddr addr = tc->get_addr();
-	return record.PlcWrite(addr.netId.b[5]);
+	const info_values* const v = get_values();
+	if (!v) return false;
+	return write_changed (*v, info_field::ads_netid, 0, v->ads_netid[5]);
 }
 
 /* InfoInterface::info_update_svn_local
@@ -1317,202 +1363,180 @@ bool InfoInterface::info_update_svn_time() noexcept
 	}
 }
 
+/* InfoInterface::info_update_callback_queue
+ ************************************************************************/
+bool InfoInterface::info_update_callback_queue (int pri, info_field f) noexcept
+{
+	const info_values* const v = get_values();
+	if (!v) return false;
+	const info_queue_stats& q = v->callback_queue[pri];
+	switch (f) {
+	case info_field::callback_queue_size:
+		return write_changed (*v, f, pri, q.size);
+	case info_field::callback_queue_used:
+		return write_changed (*v, f, pri, q.used);
+	case info_field::callback_queue_max:
+		return write_changed (*v, f, pri, q.max);
+	case info_field::callback_queue_overflow:
+		return write_changed (*v, f, pri, q.overflow);
+	case info_field::callback_queue_free:
+		return write_changed (*v, f, pri, q.free);
+	case info_field::callback_queue_percent:
+		if (q.percent < 0.0) return false;
+		return write_changed (*v, f, pri, q.percent);
+	case info_field::callback_queue_max_prcnt:
+		if (q.max_prcnt < 0.0) return false;
+		return write_changed (*v, f, pri, q.max_prcnt);
+	default:
+		return false;
+	}
+}
+
 /* InfoInterface::info_update_callback_queue0_size
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_size() noexcept
 {
-	return record.PlcWrite (get_callback_queue_size(0));
+	return info_update_callback_queue (0, info_field::callback_queue_size);
 }
 
 /* InfoInterface::info_update_callback_queue0_used
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_used() noexcept
 {
-	const int val = get_callback_queue_used(0);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (0, info_field::callback_queue_used);
 }
 
 /* InfoInterface::info_update_callback_queue0_max
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_max() noexcept
 {
-	const int val = get_callback_queue_highwatermark(0);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (0, info_field::callback_queue_max);
 }
 
 /* InfoInterface::info_update_callback_queue0_overflow
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_overflow() noexcept
 {
-	const int val = get_callback_queue_overflow(0);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (0, info_field::callback_queue_overflow);
 }
 
 /* InfoInterface::info_update_callback_queue0_free
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_free() noexcept
 {
-	return record.PlcWrite(get_callback_queue_free(0));
+	return info_update_callback_queue (0, info_field::callback_queue_free);
 }
 
 /* InfoInterface::info_update_callback_queue0_percent
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_percent() noexcept
 {
-	const double sz = (double)get_callback_queue_size(0);
-	const double usd = (double)get_callback_queue_used(0);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd/sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (0, info_field::callback_queue_percent);
 }
 
 /* InfoInterface::info_update_callback_queue0_max_prcnt
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue0_max_prcnt() noexcept
 {
-	const double sz = (double)get_callback_queue_size(0);
-	const double usd = (double)get_callback_queue_highwatermark(0);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd / sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (0, info_field::callback_queue_max_prcnt);
 }
 
 /* InfoInterface::info_update_callback_queue1_size
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_size() noexcept
 {
-	return record.PlcWrite(get_callback_queue_size(1));
+	return info_update_callback_queue (1, info_field::callback_queue_size);
 }
 
 /* InfoInterface::info_update_callback_queue1_used
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_used() noexcept
 {
-	const int val = get_callback_queue_used(1);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (1, info_field::callback_queue_used);
 }
 
 /* InfoInterface::info_update_callback_queue1_max
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_max() noexcept
 {
-	const int val = get_callback_queue_highwatermark(1);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (1, info_field::callback_queue_max);
 }
 
 /* InfoInterface::info_update_callback_queue1_overflow
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_overflow() noexcept
 {
-	const int val = get_callback_queue_overflow(1);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (1, info_field::callback_queue_overflow);
 }
 
 /* InfoInterface::info_update_callback_queue1_free
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_free() noexcept
 {
-	return record.PlcWrite(get_callback_queue_free(1));
+	return info_update_callback_queue (1, info_field::callback_queue_free);
 }
 
 /* InfoInterface::info_update_callback_queue1_percent
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_percent() noexcept
 {
-	const double sz = (double)get_callback_queue_size(1);
-	const double usd = (double)get_callback_queue_used(1);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd / sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (1, info_field::callback_queue_percent);
 }
 
 /* InfoInterface::info_update_callback_queue1_max_prcnt
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue1_max_prcnt() noexcept
 {
-	const double sz = (double)get_callback_queue_size(1);
-	const double usd = (double)get_callback_queue_highwatermark(1);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd / sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (1, info_field::callback_queue_max_prcnt);
 }
 
 /* InfoInterface::info_update_callback_queue2_size
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_size() noexcept
 {
-	return record.PlcWrite(get_callback_queue_size(2));
+	return info_update_callback_queue (2, info_field::callback_queue_size);
 }
 
 /* InfoInterface::info_update_callback_queue2_used
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_used() noexcept
 {
-	const int val = get_callback_queue_used(2);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (2, info_field::callback_queue_used);
 }
 
 /* InfoInterface::info_update_callback_queue2_max
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_max() noexcept
 {
-	const int val = get_callback_queue_highwatermark(2);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (2, info_field::callback_queue_max);
 }
 
 /* InfoInterface::info_update_callback_queue2_overflow
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_overflow() noexcept
 {
-	const int val = get_callback_queue_overflow(2);
-	return record.PlcWrite(val);
+	return info_update_callback_queue (2, info_field::callback_queue_overflow);
 }
 
 /* InfoInterface::info_update_callback_queue2_free
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_free() noexcept
 {
-	return record.PlcWrite(get_callback_queue_free(2));
+	return info_update_callback_queue (2, info_field::callback_queue_free);
 }
 
 /* InfoInterface::info_update_callback_queue2_percent
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_percent() noexcept
 {
-	const double sz = (double)get_callback_queue_size(2);
-	const double usd = (double)get_callback_queue_used(2);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd / sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (2, info_field::callback_queue_percent);
 }
 
 /* InfoInterface::info_update_callback_queue2_max_prcnt
  ************************************************************************/
 bool InfoInterface::info_update_callback_queue2_max_prcnt() noexcept
 {
-	const double sz = (double)get_callback_queue_size(2);
-	const double usd = (double)get_callback_queue_highwatermark(2);
-	if ((sz > 1.0) && (usd > 1.0)) {
-		return record.PlcWrite(usd / sz);
-	}
-	else {
-		return 0.0;
-	}
+	return info_update_callback_queue (2, info_field::callback_queue_max_prcnt);
 }
 
 /* InfoInterface::info_update_callback_queue_reset_max
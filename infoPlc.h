@@ -2,6 +2,15 @@
 #include "stdafx.h"
 #include "ParseUtil.h"
 #include "plcBase.h"
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+/** Forward declaration
+ ************************************************************************/
+namespace TcComms {
+	class TcPLC;
+}
 
 /** @file infoPlc.h
 	Header which includes classes for the info PLC.
@@ -49,6 +58,189 @@ using info_dbrecord_type = std::tuple<ParseUtil::variable_name,
 using info_dbrecord_list = std::vector<info_dbrecord_type>;
 
 
+/// Info values which are tracked for changes between info cycles
+enum class info_field : int {
+	/// ADS state (active, state and state string)
+	ads_state,
+	/// PLC time stamp string
+	timestamp_str,
+	/// PLC time stamp string (local time)
+	timestamp_local,
+	/// Year of PLC time stamp
+	timestamp_year,
+	/// Month of PLC time stamp
+	timestamp_month,
+	/// Day of PLC time stamp
+	timestamp_day,
+	/// Hour of PLC time stamp
+	timestamp_hour,
+	/// Minute of PLC time stamp
+	timestamp_min,
+	/// Second of PLC time stamp
+	timestamp_sec,
+	/// Period of read scanner
+	rate_read,
+	/// Period of write scanner
+	rate_write,
+	/// Period of update scanner
+	rate_update,
+	/// Number of EPICS records
+	records_num,
+	/// Name of tpy file
+	tpy_filename,
+	/// Validity of tpy file
+	tpy_valid,
+	/// Modification time string of tpy file
+	tpy_time_str,
+	/// Year of tpy file time
+	tpy_time_year,
+	/// Month of tpy file time
+	tpy_time_month,
+	/// Day of tpy file time
+	tpy_time_day,
+	/// Hour of tpy file time
+	tpy_time_hour,
+	/// Minute of tpy file time
+	tpy_time_min,
+	/// Second of tpy file time
+	tpy_time_sec,
+	/// ADS/AMS port
+	ads_port,
+	/// ADS/AMS address
+	ads_netid,
+	/// Size of callback queue (first field of priority 0)
+	callback_queue_size,
+	/// Used entries in callback queue
+	callback_queue_used,
+	/// High watermark of callback queue
+	callback_queue_max,
+	/// Overflows in callback queue
+	callback_queue_overflow,
+	/// Free entries in callback queue
+	callback_queue_free,
+	/// Usage percentage of callback queue
+	callback_queue_percent,
+	/// Maximum percentage of callback queue
+	callback_queue_max_prcnt,
+	/// First field after the callback queues of all priorities
+	callback_queue_end = callback_queue_size + 3 * 7
+};
+
+/// Number of callback queue priorities
+constexpr int callback_queue_num = 3;
+/// Number of fields per callback queue priority
+constexpr int callback_queue_fields = 
+	(int)info_field::callback_queue_max_prcnt - (int)info_field::callback_queue_size + 1;
+static_assert((int)info_field::callback_queue_end <= 64, "Too many info fields");
+
+/** Statistics of an EPICS callback queue
+	@brief Callback queue statistics
+ ************************************************************************/
+struct info_queue_stats {
+	/// Size of queue
+	int			size = 0;
+	/// Used entries
+	int			used = 0;
+	/// High watermark
+	int			max = 0;
+	/// Number of overflows
+	int			overflow = 0;
+	/// Free entries
+	int			free = 0;
+	/// Usage percentage (negative if not available)
+	double		percent = -1.0;
+	/// Maximum percentage (negative if not available)
+	double		max_prcnt = -1.0;
+};
+
+/** Values of the info records which depend on the state of the PLC.
+	Includes a mask of the values which changed in the last info cycle.
+	@brief Info values
+ ************************************************************************/
+struct info_values {
+	/// Get the mask bit of a field
+	/// @param f Info field
+	/// @param pri Callback queue priority (only for queue fields)
+	static constexpr std::uint64_t mask (info_field f, int pri = 0) noexcept {
+		return std::uint64_t(1) << ((int)f + 
+			((f >= info_field::callback_queue_size) ? pri * callback_queue_fields : 0)); }
+	/// Has the value changed in the last info cycle?
+	/// @param f Info field
+	/// @param pri Callback queue priority (only for queue fields)
+	bool is_changed (info_field f, int pri = 0) const noexcept {
+		return (changed & mask (f, pri)) != 0; }
+
+	/// Values have been computed
+	bool			valid = false;
+	/// Mask of changed values
+	std::uint64_t	changed = ~std::uint64_t(0);
+	/// ADS state
+	int				ads_state = 0;
+	/// PLC time stamp
+	time_t			timestamp = 0;
+	/// PLC time stamp broken down into UTC
+	tm				timestamp_utc{};
+	/// PLC time stamp string
+	char			timestamp_str[100]{};
+	/// PLC time stamp string (local time)
+	char			timestamp_local[100]{};
+	/// Period of read scanner in ms
+	int				rate_read = 0;
+	/// Period of write scanner in ms
+	int				rate_write = 0;
+	/// Period of update scanner in ms
+	int				rate_update = 0;
+	/// Number of EPICS records
+	int				records_num = 0;
+	/// Full path of tpy file
+	std::string		tpy_path;
+	/// Name of tpy file (shortened to fit into a string record)
+	std::string		tpy_filename;
+	/// Validity of tpy file
+	bool			tpy_valid = false;
+	/// Modification time of tpy file
+	time_t			tpy_time = 0;
+	/// Modification time broken down into UTC
+	tm				tpy_time_utc{};
+	/// Modification time string
+	char			tpy_time_str[100]{};
+	/// ADS/AMS port
+	int				ads_port = 0;
+	/// ADS/AMS address
+	unsigned char	ads_netid[6]{};
+	/// ADS/AMS address string
+	char			ads_netid_str[40]{};
+	/// Callback queue statistics by priority
+	info_queue_stats callback_queue[callback_queue_num];
+};
+
+/** Snapshot of the PLC information shared by all info records of a PLC.
+	It is computed once per info cycle by the read scanner, so that the 
+	time stamp conversions and callback queue queries are not repeated 
+	for every record. The snapshot is double buffered: the values are 
+	computed into the inactive buffer, which is then published with an 
+	atomic index. Readers never lock.
+	@brief Info snapshot
+ ************************************************************************/
+class info_snapshot {
+public:
+	/// Constructor
+	info_snapshot() noexcept = default;
+
+	/// Recompute the snapshot from the PLC
+	/// @param tc PLC to take the snapshot of
+	void update (const TcComms::TcPLC& tc) noexcept;
+	/// Get the current values
+	const info_values& get() const noexcept { 
+		return values[active.load (std::memory_order_acquire)]; }
+
+protected:
+	/// Double buffered values
+	info_values			values[2];
+	/// Index of the published buffer
+	std::atomic<int>	active = 0;
+};
+
 /** This is a class for a Info interface
 	@brief Info interface
  ************************************************************************/
@@ -59,7 +251,8 @@ public:
 	/// @param dval BaseRecord that this interface is part of
 	explicit InfoInterface(plc::BaseRecord& dval) noexcept
 		: Interface(dval), update_freq (update_enum::done), 
-		readonly(false), info_update (nullptr) {};
+		readonly(false), info_update (nullptr), written (false), 
+		tcplc (nullptr) {};
 	/// Constructor
 	/// @param dval BaseRecord that this interface is part of
 	/// @param id Short name info symbol
@@ -104,6 +297,34 @@ protected:
 
 	/// pointer to info update method
 	info_update_method	info_update;
+	/// Value was written at least once
+	bool				written;
+	/// Parent PLC (resolved on first use)
+	const TcComms::TcPLC* tcplc;
+
+	/// Get the parent PLC
+	/// @return Pointer to TwinCAT PLC, nullptr if not a TwinCAT PLC
+	const TcComms::TcPLC* get_tcplc() noexcept;
+	/// Get the info values of the current info cycle
+	/// @return Pointer to values, nullptr if not a TwinCAT PLC
+	const info_values* get_values() noexcept;
+	/// Writes the value, unless it is unchanged since the last info cycle
+	/// @param vals Info values of the current info cycle
+	/// @param f Info field of the value
+	/// @param pri Callback queue priority
+	/// @param val Value(s) passed to PlcWrite
+	/// @return true if successful or unchanged
+	template <typename... T>
+	bool write_changed (const info_values& vals, info_field f, int pri, 
+		const T&... val) noexcept {
+		if (written && !vals.is_changed (f, pri)) return true;
+		written = record.PlcWrite (val...);
+		return written; }
+
+	/// info update: Callback queue statistics
+	/// @param pri Callback queue priority
+	/// @param f Callback queue field
+	bool info_update_callback_queue (int pri, info_field f) noexcept;
 
 	/// info update: Name of PLC
 	bool info_update_name () noexcept;
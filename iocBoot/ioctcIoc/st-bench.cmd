@@ -0,0 +1,35 @@
+#!../../bin/win32-x86/tcIoc
+
+## Throughput benchmark against a simulated PLC, no TwinCAT required.
+## Generate the tpy file and the memory image first, e.g.
+##     tpygen -n 100000 -m bench.img bench.tpy
+
+# Increase this if you get <<TRUNCATED>> or discarded messages warnings in your errlog output
+errlogInit2(65536, 256)
+
+< envPaths
+
+epicsEnvSet("BENCH_TPY", "bench.tpy")
+epicsEnvSet("BENCH_IMAGE", "bench.img")
+epicsEnvSet("BENCH_RATE", "100000")
+epicsEnvSet("BENCH_TIME", "60")
+
+cd "${TOP}"
+
+## Register all support components
+dbLoadDatabase "dbd/tcIoc.dbd"
+tcIoc_registerRecordDeviceDriver pdbbase
+
+cd ${TOP}/iocBoot/iocTcIoc
+
+## the address must match the ADS address in the tpy file
+tcSetScanRate(10, 5)
+## the symbols are uploaded from the simulated target, which serves them
+## from the tpy file
+tcSimTarget("tc://127.0.0.1.1.1:851/", "$(BENCH_IMAGE)", "$(BENCH_RATE)", "$(BENCH_TPY)")
+tcSymbolUpload("tc://127.0.0.1.1.1:851/")
+tcLoadRecords ("$(BENCH_TPY)", "-eo -devtc")
+
+iocInit()
+
+tcBenchmark("$(BENCH_TIME)", "bench.json")
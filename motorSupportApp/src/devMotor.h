@@ -1,12 +1,23 @@
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
+#include <vector>
 #include "dbAccess.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+#include "dbEvent.h"
+#include "initHooks.h"
 
 // No controller-specific parameters yet
 #define NUM_VIRTUAL_MOTOR_PARAMS 0  
 
 #define PV_BUFFER_LEN 100
 
+// Default poll periods in seconds (the fixed 5 Hz used before they were configurable)
+#define DEFAULT_MOVING_POLL_PERIOD 0.2
+#define DEFAULT_IDLE_POLL_PERIOD 0.2
+// Number of fast polls after a command
+#define FORCED_FAST_POLLS 2
+
 extern "C" {
 	int devMotorCreateAxis(const char *devMotorName, int axisNo, int versionNumber);
 }
@@ -26,6 +37,37 @@ typedef struct {
     int bDirection;
 } st_axis_status_type;
 
+/* The PVs of an axis, which are resolved to database addresses once */
+enum axisPVIndex {
+	PV_ENABLE_STATUS,
+	PV_EXECUTE,
+	PV_VELOCITY_SP,
+	PV_POSITION_SP,
+	PV_DISTANCE_SP,
+	PV_ERROR_STATUS,
+	PV_POSITION_RBV,
+	PV_VELOCITY_RBV,
+	PV_HOMED,
+	PV_MOVING,
+	PV_COMMAND,
+	PV_POSITIVE_DIR,
+	PV_NEGATIVE_DIR,
+	PV_STOP,
+	PV_LIMIT_FWD,
+	PV_LIMIT_BWD,
+	NUM_AXIS_PVS
+};
+
+/* A PV of an axis with its cached database address */
+typedef struct {
+	std::string name;
+	DBADDR addr;
+	bool bound;
+	// location of the value in the status structure, size is 0 if not in there
+	int structOffset;
+	int structSize;
+} axis_pv_type;
+
 class epicsShareClass devMotorAxis : public asynMotorAxis
 {
 public:
@@ -37,29 +79,52 @@ public:
 	asynStatus stop(double acceleration);
 	asynStatus pollAll(st_axis_status_type *pst_axis_status);
 	asynStatus poll(bool *moving);
+	void bindPVs();
 
 protected:
-	void getInteger(std::string pvSuffix, epicsInt32* pvalue, const std::string* prefix = 0);
+	void getInteger(axisPVIndex pv, epicsInt32* pvalue);
 	asynStatus sendCommand(const int command);    
-	asynStatus putDb(std::string pvSuffix, const void *value);
+	asynStatus putDb(axisPVIndex pv, const void *value);
 	
     int axisNo;
 	devMotorController *pC_;
 	std::string pvPrefix;
+	axis_pv_type pvs[NUM_AXIS_PVS];
 	
 	friend class devMotorController;
 	
 private:
-	void getPVValue(std::string& pvSuffix, DBADDR* addr, long* pbuffer, const std::string* prefix = 0);
-	void getDouble(std::string pvSuffix, epicsFloat64* pvalue);
+	DBADDR* getAddr(axisPVIndex pv);
+	void bindStatusStruct();
+	void mapStatusStruct(unsigned long group, unsigned long offset, unsigned long size);
+	void readStatusStruct();
+	bool getStructValue(axisPVIndex pv, void* pvalue, bool isDouble);
+	void subscribeMoving();
+	static void movingInitHook(initHookState state);
+	void waitForMoving(double timeout);
+	void getPVValue(axisPVIndex pv, DBADDR** paddr, long* pbuffer);
+	void getDouble(axisPVIndex pv, epicsFloat64* pvalue);
 	void getDirection(int* direction);
 	double getMotorResolution();
 	void scaleValueFromMotorRecord(double* value);
 	void scaleValueToMotorRecord(double* value);
 	
-    virtual void populateLimitStatus(st_axis_status_type *axis_status) = 0;
 	virtual asynStatus sendStop() = 0;
 		
+	DBADDR statusAddr;
+	bool statusBound;
+	bool statusValid;
+	int statusMapped;
+	unsigned long statusReloads;
+	bool statusStale;
+	epicsTimeStamp statusRemapTime;
+	std::vector<char> statusBuffer;
+	
+	epicsEventId movingEvent;
+	struct dbChannel* movingChan;
+	dbEventSubscription movingSub;
+	bool movingTried;
+	
 	std::string previousError = "";
 	bool errorToggle = false;
 
@@ -76,6 +141,12 @@ private:
 	virtual std::string COMMAND() = 0;
 	virtual std::string POSITIVE_DIR() = 0;
 	virtual std::string NEGATIVE_DIR() = 0;
+	virtual std::string STOP() { return ""; };
+	// Binary waveform of the whole status structure, empty if not available
+	virtual std::string STATUS_STRUCT() { return ""; };
+	// Full PV names of the limit switches
+	virtual std::string LIMIT_FWD() = 0;
+	virtual std::string LIMIT_BWD() = 0;
 
 	
 	virtual epicsInt32 HOME_COMMAND() = 0;
@@ -93,6 +164,7 @@ private:
 	std::string ENABLE_STATUS() { return "STSTATUS-BENABLED"; };
 	std::string EXECUTE() { return "STCONTROL-BEXECUTE"; };
 	std::string STOP() { return "STCONTROL-BSTOP"; };
+	std::string STATUS_STRUCT() { return "STSTATUS"; };
 	std::string VELOCITY_SP() { return "STCONTROL-FVELOCITY"; };
 	std::string POSITION_SP() { return "STCONTROL-FPOSITION"; };
 	std::string DISTANCE_SP() { return "STCONTROL-FPOSITION"; };
@@ -104,6 +176,8 @@ private:
 	std::string COMMAND() { return "STCONTROL-ECOMMAND"; };
 	std::string POSITIVE_DIR() { return "STSTATUS-BMOVINGFORWARD"; };
 	std::string NEGATIVE_DIR() { return "STSTATUS-BMOVINGBACKWARD"; };
+	std::string LIMIT_FWD() { return pvPrefix + "STINPUTS-BLIMITFWD"; };
+	std::string LIMIT_BWD() { return pvPrefix + "STINPUTS-BLIMITBWD"; };
 	
     epicsInt32 HOME_COMMAND() { return 10; };
 	epicsInt32 STOP_COMMAND() { return 15; };
@@ -111,7 +185,6 @@ private:
 	epicsInt32 MOVE_RELATIVE_COMMAND() { return 1; };
 	epicsInt32 MOVE_VELO_COMMAND() { return 3; };
 
-    void populateLimitStatus(st_axis_status_type *axis_status);
 	asynStatus sendStop();
 };
 
@@ -134,6 +207,8 @@ private:
 	std::string NEGATIVE_DIR() { return "BNEGATIVEDIRECTION"; };
 	std::string MOVING() { return "BMOVING"; };
 	std::string COMMAND() { return "ECOMMAND"; };
+	std::string LIMIT_FWD();
+	std::string LIMIT_BWD();
 	
 	epicsInt32 HOME_COMMAND() { return 13; };
 	epicsInt32 STOP_COMMAND() { return 15; };
@@ -141,13 +216,13 @@ private:
 	epicsInt32 MOVE_RELATIVE_COMMAND() { return 18; };
 	epicsInt32 MOVE_VELO_COMMAND() { return 21; };
 
-    void populateLimitStatus(st_axis_status_type *axis_status);
 	asynStatus sendStop();
 };
 
 class epicsShareClass devMotorController : public asynMotorController {
 public:
-	devMotorController(const char *portName, const char *devMotorPortName, int numAxes, const char *pvPrefix);
+	devMotorController(const char *portName, const char *devMotorPortName, int numAxes, const char *pvPrefix,
+		double movingPollPeriod, double idlePollPeriod);
 
 	void report(FILE *fp, int level);
 
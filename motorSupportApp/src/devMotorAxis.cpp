@@ -1,15 +1,24 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <dbAccess.h>
+#include <dbStaticLib.h>
 #include <stdexcept>
 #include <epicsThread.h>
+#include <epicsEvent.h>
+#include <epicsTime.h>
+#include <dbChannel.h>
+#include <dbEvent.h>
+#include <initHooks.h>
 #include <sstream>
+#include <vector>
 
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
 #include <errlog.h>
 #include <epicsExport.h>
+#include "tcLocation.h"
 #include "devMotor.h"
 
 #ifndef ASYN_TRACE_INFO
@@ -20,6 +29,51 @@
 #define MIN(x,y)  (((x) < (y)) ? (x) : (y))
 #endif
 
+/* Longest time to wait for the PLC to report motion after a move command */
+#define MOVING_CHECK_TIMEOUT 0.5
+
+/* Database event context shared by the MOVING subscriptions of all axes */
+static dbEventCtx movingEventCtx = 0;
+static epicsThreadOnceId movingEventOnce = EPICS_THREAD_ONCE_INIT;
+
+static void movingEventInit(void*) {
+	movingEventCtx = db_init_events();
+	if (movingEventCtx && db_start_events(movingEventCtx, "devMotorMoving", NULL, NULL, 
+		epicsThreadPriorityScanLow)) {
+		db_close_events(movingEventCtx);
+		movingEventCtx = 0;
+	}
+}
+
+/* Axes which subscribe to their MOVING PV once the IOC is running */
+static std::vector<devMotorAxis*> movingAxes;
+static bool movingHookRegistered = false;
+
+/**
+  * Init hook which subscribes the MOVING PVs of all axes.
+  *
+  * Axes are created before iocInit, when the MOVING records may not be loaded
+  * yet, so the subscriptions are made once the IOC is running.
+  */
+void devMotorAxis::movingInitHook(initHookState state) {
+	if (state != initHookAfterIocRunning) {
+		return;
+	}
+	for (size_t i = 0; i < movingAxes.size(); ++i) {
+		movingAxes[i]->subscribeMoving();
+	}
+	movingAxes.clear();
+}
+
+/**
+  * Database event callback for the MOVING PV of an axis.
+  *
+  * Wakes up a command which is waiting for the axis to start moving.
+  */
+static void movingChanged(void* user_arg, struct dbChannel* chan, int eventsRemaining, struct db_field_log* pfl) {
+	epicsEventSignal((epicsEventId)user_arg);
+}
+
 /** 
   * Creates a new devMotorAxis object.
   *
@@ -39,7 +93,296 @@ devMotorAxis::devMotorAxis(devMotorController *pC, int axisNo)
     // we aren't told if we really have an encoder by the beckhoff, but our scaling logic
     // is based just on motor resolution so explicitly set this paramemeter to 0
     setIntegerParam(pC_->motorStatusHasEncoder_, 0);
+    for (int i = 0; i < NUM_AXIS_PVS; ++i) {
+        pvs[i].bound = false;
+        pvs[i].structOffset = 0;
+        pvs[i].structSize = 0;
+    }
+    statusBound = false;
+    statusValid = false;
+    statusMapped = -1;
+    statusReloads = 0;
+    statusStale = false;
+    movingEvent = epicsEventCreate(epicsEventEmpty);
+    movingChan = 0;
+    movingSub = 0;
+    movingTried = false;
+}
 
+/**
+  * Resolves all PVs of the axis to their database addresses.
+  *
+  * This is done once after the axis is created, so that polling and commands
+  * do not need to build the PV names and look them up each time. PVs which
+  * are not found are looked up again when they are first used.
+  */
+void devMotorAxis::bindPVs() {
+	pvs[PV_ENABLE_STATUS].name = pvPrefix + ENABLE_STATUS();
+	pvs[PV_EXECUTE].name = pvPrefix + EXECUTE();
+	pvs[PV_VELOCITY_SP].name = pvPrefix + VELOCITY_SP();
+	pvs[PV_POSITION_SP].name = pvPrefix + POSITION_SP();
+	pvs[PV_DISTANCE_SP].name = pvPrefix + DISTANCE_SP();
+	pvs[PV_ERROR_STATUS].name = pvPrefix + ERROR_STATUS();
+	pvs[PV_POSITION_RBV].name = pvPrefix + POSITION_RBV();
+	pvs[PV_VELOCITY_RBV].name = pvPrefix + VELOCITY_RBV();
+	pvs[PV_HOMED].name = pvPrefix + HOMED();
+	pvs[PV_MOVING].name = pvPrefix + MOVING();
+	pvs[PV_COMMAND].name = pvPrefix + COMMAND();
+	pvs[PV_POSITIVE_DIR].name = pvPrefix + POSITIVE_DIR();
+	pvs[PV_NEGATIVE_DIR].name = pvPrefix + NEGATIVE_DIR();
+	pvs[PV_STOP].name = STOP().empty() ? "" : pvPrefix + STOP();
+	pvs[PV_LIMIT_FWD].name = LIMIT_FWD();
+	pvs[PV_LIMIT_BWD].name = LIMIT_BWD();
+	int missing = 0;
+	for (int i = 0; i < NUM_AXIS_PVS; ++i) {
+		pvs[i].bound = !pvs[i].name.empty() && (dbNameToAddr(pvs[i].name.c_str(), &pvs[i].addr) == 0);
+		if (!pvs[i].bound && !pvs[i].name.empty()) {
+			++missing;
+		}
+	}
+	if (missing) {
+		printf("Axis %i: %i PVs not found\n", axisNo, missing);
+	}
+	bindStatusStruct();
+	// the MOVING record may not exist before the IOC is running
+	if (interruptAccept) {
+		subscribeMoving();
+	} else {
+		if (!movingHookRegistered) {
+			movingHookRegistered = (initHookRegister(movingInitHook) == 0);
+		}
+		movingAxes.push_back(this);
+	}
+}
+
+/**
+  * Binds the binary record of the whole status structure, if there is one.
+  *
+  * Values which are found in the structure are decoded from a single read of
+  * the binary record, so that all of them come from the same PLC cycle. Their
+  * locations in the structure are resolved by mapStatusStruct.
+  */
+void devMotorAxis::bindStatusStruct() {
+	std::string name = STATUS_STRUCT();
+	if (name.empty()) {
+		return;
+	}
+	name = pvPrefix + name;
+	if (dbNameToAddr(name.c_str(), &statusAddr) || (statusAddr.field_type != DBF_UCHAR)) {
+		return;
+	}
+	statusBound = true;
+}
+
+/**
+  * Maps the status values to their locations in the status structure.
+  *
+  * The location of each status value is derived from the TwinCAT locations of
+  * the structure and of the individual records, as reported by the IOC.
+  *
+  * \param[in] group The index group of the structure
+  * \param[in] offset The index offset of the structure
+  * \param[in] size The size of the structure in bytes
+  */
+void devMotorAxis::mapStatusStruct(unsigned long group, unsigned long offset, unsigned long size) {
+	int mapped = 0;
+	for (int i = 0; i < NUM_AXIS_PVS; ++i) {
+		unsigned long g, o, s, r;
+		pvs[i].structOffset = 0;
+		pvs[i].structSize = 0;
+		if (!pvs[i].bound || tcGetRecordLocation(pvs[i].name.c_str(), &g, &o, &s, &r) || 
+			(g != group) || (o < offset) || (o + s > offset + size)) {
+			continue;
+		}
+		// only plain numbers are decoded
+		if ((s != 1) && (s != 2) && (s != 4) && (s != 8)) {
+			continue;
+		}
+		pvs[i].structOffset = o - offset;
+		pvs[i].structSize = s;
+		++mapped;
+	}
+	if (statusBuffer.size() != size) {
+		statusBuffer.assign(size, 0);
+	}
+	if (mapped != statusMapped) {
+		printf("Axis %i: %i status values read from %s\n", axisNo, mapped, 
+			(pvPrefix + STATUS_STRUCT()).c_str());
+		statusMapped = mapped;
+	}
+}
+
+/**
+  * Reads the binary record of the whole status structure.
+  *
+  * The structure is mapped on the first read and again whenever a reload of
+  * the tpy file has moved the symbols. After a reload the record may still
+  * hold data in the old layout, so the values are read from their own PVs
+  * until the record has been processed with data read after the remap.
+  */
+void devMotorAxis::readStatusStruct() {
+	const std::string name = pvPrefix + STATUS_STRUCT();
+	unsigned long group, offset, size, reloads;
+	if (tcGetRecordLocation(name.c_str(), &group, &offset, &size, &reloads)) {
+		return;
+	}
+	if ((statusMapped < 0) || (reloads != statusReloads)) {
+		statusStale = (statusMapped >= 0);
+		epicsTimeGetCurrent(&statusRemapTime);
+		mapStatusStruct(group, offset, size);
+		statusReloads = reloads;
+	}
+	if (statusMapped == 0) {
+		return;
+	}
+	if (statusStale) {
+		if (!epicsTimeGreaterThan(&statusAddr.precord->time, &statusRemapTime)) {
+			return;
+		}
+		statusStale = false;
+	}
+    long options = 0;
+    long no_elements = MIN(statusAddr.no_elements, (long)statusBuffer.size());
+    if (dbGet(&statusAddr, DBR_UCHAR, statusBuffer.data(), &options, &no_elements, NULL) != 0 ||
+		(no_elements != (long)statusBuffer.size())) {
+        throw std::runtime_error("Could not get value from PV: " + name);
+    }
+	// a reload during the read may have changed the layout of the data
+	if (tcGetRecordLocation(name.c_str(), &group, &offset, &size, &reloads) || 
+		(reloads != statusReloads)) {
+		return;
+	}
+	if (statusAddr.precord->stat) {
+		std::ostringstream os;
+		os << "PV " + name + " in alarm with status " << statusAddr.precord->stat 
+		   << " and severity " << statusAddr.precord->sevr;
+		throw std::runtime_error(os.str());
+	}
+	statusValid = true;
+}
+
+/**
+  * Decodes a value from the last read of the status structure.
+  *
+  * \param[in] pv The axis PV
+  * \param[out] pvalue The epicsFloat64 or epicsInt32 to store the value in
+  * \param[in] isDouble True for a floating point value
+  *
+  * \return True if the value was decoded, false if it has to be read from its PV.
+  */
+bool devMotorAxis::getStructValue(axisPVIndex pv, void* pvalue, bool isDouble) {
+	const axis_pv_type& entry = pvs[pv];
+	if (!statusValid || (entry.structSize == 0)) {
+		return false;
+	}
+	const char* p = statusBuffer.data() + entry.structOffset;
+	if (isDouble) {
+		if (entry.structSize == 4) {
+			epicsFloat32 f;
+			memcpy(&f, p, sizeof(f));
+			*(epicsFloat64*)pvalue = f;
+		} else if (entry.structSize == 8) {
+			memcpy(pvalue, p, sizeof(epicsFloat64));
+		} else {
+			return false;
+		}
+	} else {
+		switch (entry.structSize) {
+		case 1: 
+			*(epicsInt32*)pvalue = *(const epicsUInt8*)p;
+			break;
+		case 2: {
+			epicsInt16 i;
+			memcpy(&i, p, sizeof(i));
+			*(epicsInt32*)pvalue = i;
+			break;
+		}
+		case 4:
+			memcpy(pvalue, p, sizeof(epicsInt32));
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+  * Subscribes to value changes of the MOVING PV.
+  *
+  * Commands which wait for the axis to start moving are woken up by the
+  * subscription. Without it they fall back to polling. The subscription is
+  * made once the IOC is running, or on the first move if the init hook did
+  * not run. A failure is reported once.
+  */
+void devMotorAxis::subscribeMoving() {
+	if (movingSub || movingTried || !movingEvent) {
+		return;
+	}
+	movingTried = true;
+	epicsThreadOnce(&movingEventOnce, movingEventInit, NULL);
+	if (!movingEventCtx) {
+		return;
+	}
+	movingChan = dbChannelCreate(pvs[PV_MOVING].name.c_str());
+	if (!movingChan || dbChannelOpen(movingChan)) {
+		if (movingChan) {
+			dbChannelDelete(movingChan);
+			movingChan = 0;
+		}
+		printf("Axis %i: cannot monitor %s, polling for motion\n", axisNo, pvs[PV_MOVING].name.c_str());
+		return;
+	}
+	movingSub = db_add_event(movingEventCtx, movingChan, movingChanged, movingEvent, DBE_VALUE);
+	if (movingSub) {
+		db_event_enable(movingSub);
+	}
+}
+
+/**
+  * Waits until the PLC reports that the axis is moving.
+  *
+  * The wait is woken by the MOVING subscription, so it returns as soon as the
+  * PLC reports motion rather than at the next fixed poll.
+  *
+  * \param[in] timeout The longest time to wait in seconds.
+  */
+void devMotorAxis::waitForMoving(double timeout) {
+	st_axis_status_type st_axis_status;
+	epicsTimeStamp start, now;
+	epicsTimeGetCurrent(&start);
+	double remaining = timeout;
+	for (;;) {
+		pollAll(&st_axis_status);
+		if (st_axis_status.bMoving != 0 || remaining <= 0) {
+			break;
+		}
+		if (movingSub) {
+			epicsEventWaitWithTimeout(movingEvent, remaining);
+		} else {
+			epicsThreadSleep(MIN(0.05, remaining));
+		}
+		epicsTimeGetCurrent(&now);
+		remaining = timeout - epicsTimeDiffInSeconds(&now, &start);
+	}
+}
+
+/**
+  * Gets the database address of an axis PV.
+  *
+  * \param[in] pv The axis PV.
+  *
+  * \return The database address, throws if the PV cannot be found.
+  */
+DBADDR* devMotorAxis::getAddr(axisPVIndex pv) {
+	axis_pv_type& entry = pvs[pv];
+	if (!entry.bound) {
+		if (entry.name.empty() || dbNameToAddr(entry.name.c_str(), &entry.addr)) {
+			throw std::runtime_error("PV not found: " + entry.name);
+		}
+		entry.bound = true;
+	}
+	return &entry.addr;
 }
 
 /** 
@@ -61,10 +404,14 @@ extern "C" int devMotorCreateAxis(const char *devMotorName, int axisNo, int vers
         return asynError;
     }
     pC->lock();
+	devMotorAxis* pAxis = 0;
 	if (versionNumber == 0) {
-		new ISISMotorAxis(pC, axisNo);
+		pAxis = new ISISMotorAxis(pC, axisNo);
 	} else if (versionNumber == 1) {
-		new twincatMotorAxis(pC, axisNo);
+		pAxis = new twincatMotorAxis(pC, axisNo);
+	}
+	if (pAxis) {
+		pAxis->bindPVs();
 	}
     pC->unlock();
     return asynSuccess;
@@ -81,8 +428,10 @@ extern "C" int devMotorCreateAxis(const char *devMotorName, int axisNo, int vers
   */
 asynStatus devMotorAxis::sendCommand(const int command) {
     int exec = 1;
-    int status = putDb(COMMAND(), &command);
-    status |= putDb(EXECUTE(), &exec);
+    int status = putDb(PV_COMMAND, &command);
+    status |= putDb(PV_EXECUTE, &exec);
+    // poll straight away so the readbacks follow the command
+    pC_->wakeupPoller();
     return (asynStatus)status;
 }
 
@@ -102,22 +451,21 @@ asynStatus devMotorAxis::move(double position, int relative, double minVelocity,
 		scaleValueFromMotorRecord(&position);
 		scaleValueFromMotorRecord(&maxVelocity);
 
-		int status = putDb(VELOCITY_SP(), &maxVelocity);
+		int status = putDb(PV_VELOCITY_SP, &maxVelocity);
 		
+		subscribeMoving();
+		// discard notifications from before the command
+		if (movingEvent) {
+			epicsEventTryWait(movingEvent);
+		}
 		if (relative == 0) {
-			status |= putDb(POSITION_SP(), &position);
+			status |= putDb(PV_POSITION_SP, &position);
 			status |= sendCommand(MOVE_ABS_COMMAND());
 		} else {
-			status |= putDb(DISTANCE_SP(), &position);
+			status |= putDb(PV_DISTANCE_SP, &position);
 			status |= sendCommand(MOVE_RELATIVE_COMMAND());
 		}
-		st_axis_status_type st_axis_status;
-		int movingCheckPolls = 10;
-		double movingCheckDelay = 0.05;
-		do {
-			epicsThreadSleep(movingCheckDelay);
-			pollAll(&st_axis_status);
-		} while (st_axis_status.bMoving == 0 && --movingCheckPolls > 0);
+		waitForMoving(MOVING_CHECK_TIMEOUT);
 		return (asynStatus)status;
 	}  catch (const std::runtime_error& e) {
 		asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR|ASYN_TRACEIO_DRIVER,
@@ -159,7 +507,7 @@ asynStatus devMotorAxis::moveVelocity(double minVelocity, double maxVelocity, do
     try {
 		scaleValueFromMotorRecord(&maxVelocity);
 		
-		int status = putDb(VELOCITY_SP(), &maxVelocity);
+		int status = putDb(PV_VELOCITY_SP, &maxVelocity);
 		status |= sendCommand(MOVE_VELO_COMMAND());
 		return (asynStatus)status;
     }  catch (const std::runtime_error& e) {
@@ -185,7 +533,7 @@ asynStatus ISISMotorAxis::sendStop() {
   */
 asynStatus twincatMotorAxis::sendStop() {
 	int stop = 1;
-	return (asynStatus)putDb(STOP(), &stop);
+	return (asynStatus)putDb(PV_STOP, &stop);
 }
 
 /** 
@@ -243,14 +591,12 @@ void devMotorAxis::scaleValueToMotorRecord(double* value) {
     *value /= getMotorResolution();
 }
 
-void twincatMotorAxis::populateLimitStatus(st_axis_status_type *axis_status) { 
-	getInteger("STINPUTS-BLIMITFWD", &axis_status->bLimitFwd); 
-	getInteger("STINPUTS-BLIMITBWD", &axis_status->bLimitBwd);
+std::string ISISMotorAxis::LIMIT_FWD() {
+	return pC_->pvPrefix + "FWLIMIT_" + std::to_string(axisNo + 1);
 }
 
-void ISISMotorAxis::populateLimitStatus(st_axis_status_type *axis_status) {
-	getInteger("FWLIMIT_" + std::to_string(axisNo + 1), &axis_status->bLimitFwd, &pC_->pvPrefix); 
-	getInteger("BWLIMIT_" + std::to_string(axisNo + 1), &axis_status->bLimitBwd, &pC_->pvPrefix);
+std::string ISISMotorAxis::LIMIT_BWD() {
+	return pC_->pvPrefix + "BWLIMIT_" + std::to_string(axisNo + 1);
 }
 
 /**
@@ -264,8 +610,8 @@ void ISISMotorAxis::populateLimitStatus(st_axis_status_type *axis_status) {
 void devMotorAxis::getDirection(int* direction) {
 	int positiveDirection = 0;
 	int negativeDirection = 0;
-	getInteger(POSITIVE_DIR(), &positiveDirection);
-	getInteger(NEGATIVE_DIR(), &negativeDirection);
+	getInteger(PV_POSITIVE_DIR, &positiveDirection);
+	getInteger(PV_NEGATIVE_DIR, &negativeDirection);
 	if (positiveDirection && negativeDirection) {
 		throw std::runtime_error(std::string("Axis is running in both directions"));
 	}
@@ -278,68 +624,85 @@ void devMotorAxis::getDirection(int* direction) {
 }
 
 
+/* The status fields which are read in one pass by pollAll */
+typedef struct {
+	axisPVIndex pv;
+	size_t offset;
+	bool isDouble;
+} axis_status_field_type;
+
+static const axis_status_field_type axisStatusFields[] = {
+	{PV_ENABLE_STATUS, offsetof(st_axis_status_type, bEnable), false},
+	{PV_EXECUTE, offsetof(st_axis_status_type, bExecute), false},
+	{PV_VELOCITY_SP, offsetof(st_axis_status_type, fVelocity), true},
+	{PV_POSITION_SP, offsetof(st_axis_status_type, fPosition), true},
+	{PV_ERROR_STATUS, offsetof(st_axis_status_type, bError), false},
+	{PV_POSITION_RBV, offsetof(st_axis_status_type, fActPosition), true},
+	{PV_VELOCITY_RBV, offsetof(st_axis_status_type, fActVelocity), true},
+	{PV_HOMED, offsetof(st_axis_status_type, bHomed), false},
+	{PV_MOVING, offsetof(st_axis_status_type, bMoving), false},
+	{PV_LIMIT_FWD, offsetof(st_axis_status_type, bLimitFwd), false},
+	{PV_LIMIT_BWD, offsetof(st_axis_status_type, bLimitBwd), false}
+};
+
 /**
   * Pulls all relevant values out of the PLC.
   *
+  * The status PVs are read in one pass through their cached database addresses.
+  * Values which are part of the binary status structure record are decoded from
+  * one read of that record instead.
+  *
   * \param[out] axis_status The st_axis_status_type variable to put the information into.
   *
   * \return The status code for the polling.
   */
 asynStatus devMotorAxis::pollAll(st_axis_status_type *axis_status) {
 	memset(axis_status, 0, sizeof(st_axis_status_type));
-	getInteger(ENABLE_STATUS(), &axis_status->bEnable);
-	getInteger(EXECUTE(), &axis_status->bExecute);
-	getDouble(VELOCITY_SP(), &axis_status->fVelocity);
-	getDouble(POSITION_SP(), &axis_status->fPosition);
-	getInteger(ERROR_STATUS(), &axis_status->bError);
-	getDouble(POSITION_RBV(), &axis_status->fActPosition);
-	getDouble(VELOCITY_RBV(), &axis_status->fActVelocity);
-	getInteger(HOMED(), &axis_status->bHomed);
-	getInteger(MOVING(), &axis_status->bMoving);
+	char* base = (char*)axis_status;
+	statusValid = false;
+	if (statusBound) {
+		readStatusStruct();
+	}
+	for (size_t i = 0; i < sizeof(axisStatusFields) / sizeof(axisStatusFields[0]); ++i) {
+		const axis_status_field_type& field = axisStatusFields[i];
+		if (field.isDouble) {
+			getDouble(field.pv, (epicsFloat64*)(base + field.offset));
+		} else {
+			getInteger(field.pv, (epicsInt32*)(base + field.offset));
+		}
+	}
 	getDirection(&axis_status->bDirection);
-	populateLimitStatus(axis_status);
+	statusValid = false;
     return asynSuccess;
 }
 
 /**
   * Puts a value into a PV.
   *
-  * \param[in] pvSuffix The name of the PV to put into (without the PV prefix)
+  * \param[in] pv The axis PV to put into
   * \param[in] value The value to put into the PV. This is a void pointer as this method will work for both ints and doubles.
   * 
   * \return The status code from doing the put.
   */
-asynStatus devMotorAxis::putDb(std::string pvSuffix, const void *value) {
-    DBADDR addr;
-	std::string fullPV = pvPrefix + pvSuffix;
-    if (dbNameToAddr(fullPV.c_str(), &addr)) {
-		throw std::runtime_error("PV not found: " + fullPV);
-        return asynError;
-    }
-
-    return (asynStatus) dbPutField(&addr, addr.dbr_field_type, value, 1);
+asynStatus devMotorAxis::putDb(axisPVIndex pv, const void *value) {
+    DBADDR* addr = getAddr(pv);
+    return (asynStatus) dbPutField(addr, addr->dbr_field_type, value, 1);
 }
 
 /**
   * Get a value from a PV.
   *
-  * \param[in] pvSuffix The name of the PV to get from (without the PV prefix)
-  * \param[out] addr The DBADDR structure to store metadata about the PV
+  * \param[in] pv The axis PV to get from
+  * \param[out] paddr The cached DBADDR structure with metadata about the PV
   * \param[out] pbuffer The buffer to store the value retrieved from the PV
-  * \param[in] prefix The prefix to use for the PV, if not specified then will default to the one setup in the constructor
   */
-void devMotorAxis::getPVValue(std::string& pvSuffix, DBADDR* addr, long* pbuffer, const std::string* prefix) {
+void devMotorAxis::getPVValue(axisPVIndex pv, DBADDR** paddr, long* pbuffer) {
     long options = 0;
     long no_elements;
     
-	if (!prefix) {
-		prefix = &pvPrefix;
-	}
-
-	std::string fullPV = *prefix + pvSuffix;
-    if (dbNameToAddr(fullPV.c_str(), addr)) {
-        throw std::runtime_error("PV not found: " + fullPV);
-    }
+    DBADDR* addr = getAddr(pv);
+    *paddr = addr;
+    const std::string& fullPV = pvs[pv].name;
       
     no_elements = MIN(addr->no_elements, PV_BUFFER_LEN/addr->field_size);
     if (dbGet(addr, addr->dbr_field_type, pbuffer, &options, &no_elements, NULL) != 0) {
@@ -359,17 +722,20 @@ void devMotorAxis::getPVValue(std::string& pvSuffix, DBADDR* addr, long* pbuffer
 /**
   * Get a double value from a PV.
   *
-  * \param[in] pvSuffix The name of the PV to get from (without the PV prefix)
+  * \param[in] pv The axis PV to get from
   * \param[out] pvalue The object to store the value retrieved from the PV
   */
-void devMotorAxis::getDouble(std::string pvSuffix, epicsFloat64* pvalue) {
+void devMotorAxis::getDouble(axisPVIndex pv, epicsFloat64* pvalue) {
+    if (getStructValue(pv, pvalue, true)) {
+        return;
+    }
     long buffer[PV_BUFFER_LEN];
 	long *pbuffer=&buffer[0];
-    DBADDR addr;
+    DBADDR* addr;
 
-    getPVValue(pvSuffix, &addr, pbuffer);
+    getPVValue(pv, &addr, pbuffer);
     
-    if (addr.dbr_field_type == DBR_DOUBLE) {
+    if (addr->dbr_field_type == DBR_DOUBLE) {
         *pvalue = (*(epicsFloat64 *) pbuffer);
     }
 }
@@ -377,20 +743,22 @@ void devMotorAxis::getDouble(std::string pvSuffix, epicsFloat64* pvalue) {
 /**
   * Get a integer value from a PV.
   *
-  * \param[in] pvSuffix The name of the PV to get from (without the PV prefix)
+  * \param[in] pv The axis PV to get from
   * \param[out] pvalue The object to store the value retrieved from the PV
-  * \param[in] prefix The prefix to use for the PV, if not specified then will default to the one setup in the constructor
   */
-void devMotorAxis::getInteger(std::string pvSuffix, epicsInt32* pvalue, const std::string* prefix) {
+void devMotorAxis::getInteger(axisPVIndex pv, epicsInt32* pvalue) {
+    if (getStructValue(pv, pvalue, false)) {
+        return;
+    }
     long buffer[PV_BUFFER_LEN];
     long *pbuffer=&buffer[0];
-    DBADDR addr;
+    DBADDR* addr;
     
-    getPVValue(pvSuffix, &addr, pbuffer, prefix);
+    getPVValue(pv, &addr, pbuffer);
     
-    if (addr.dbr_field_type == DBR_LONG) {
+    if (addr->dbr_field_type == DBR_LONG) {
         *pvalue = (*(epicsInt32 *) pbuffer);
-    } else if (addr.dbr_field_type == DBR_ENUM) {
+    } else if (addr->dbr_field_type == DBR_ENUM) {
         *pvalue = (*(epicsEnum16 *) pbuffer);
     }
 }
@@ -440,6 +808,7 @@ asynStatus devMotorAxis::poll(bool *moving) {
   int nowMoving = st_axis_status.bMoving;
   setIntegerParam(pC_->motorStatusMoving_, nowMoving);
   setIntegerParam(pC_->motorStatusDone_, !nowMoving);
+  // A command forces a few fast polls until the axis reports motion
   *moving = nowMoving ? true : false;
 
   callParamCallbacks();
@@ -18,10 +18,12 @@
   * \param[in] portName          The name of the asyn port that will be created for this driver
   * \param[in] MotorPortName     The name of the drvAsynSerialPort that was created previously to connect to the devMotor controller
   * \param[in] numAxes           The number of axes that this controller supports
+  * \param[in] pvPrefix          The PV prefix of the axis records
   * \param[in] movingPollPeriod  The time between polls when any axis is moving
   * \param[in] idlePollPeriod    The time between polls when no axis is moving
   */
-devMotorController::devMotorController(const char *portName, const char *MotorPortName, int numAxes, const char *pvPrefix)
+devMotorController::devMotorController(const char *portName, const char *MotorPortName, int numAxes, const char *pvPrefix,
+                                       double movingPollPeriod, double idlePollPeriod)
   :  asynMotorController(portName, numAxes, NUM_VIRTUAL_MOTOR_PARAMS,
                          0, // No additional interfaces beyond those in base class
                          0, // No additional callback interfaces beyond those in base class
@@ -31,7 +33,9 @@ devMotorController::devMotorController(const char *portName, const char *MotorPo
 	pvPrefix(pvPrefix)
 {
 	printf("Created Controller\n");
-	startPoller(1/5.0, 1/5.0, 2);
+	// Poll fast while any axis is moving, slow when all are idle.
+	// Commands wake up the poller for a few fast polls.
+	startPoller(movingPollPeriod, idlePollPeriod, FORCED_FAST_POLLS);
 }
 
 
@@ -40,10 +44,16 @@ devMotorController::devMotorController(const char *portName, const char *MotorPo
   * \param[in] portName          The name of the asyn port that will be created for this driver
   * \param[in] MotorPortName  The name of the drvAsynIPPPort that was created previously to connect to the devMotor controller
   * \param[in] numAxes           The number of axes that this controller supports (0 is not used)
+  * \param[in] pvPrefix          The PV prefix of the axis records
+  * \param[in] movingPollPeriod  The time in ms between polls when any axis is moving (0 for default)
+  * \param[in] idlePollPeriod    The time in ms between polls when no axis is moving (0 for default)
   */
-extern "C" int devMotorCreateController(const char *portName, const char *MotorPortName, int numAxes, const char *pvPrefix)
+extern "C" int devMotorCreateController(const char *portName, const char *MotorPortName, int numAxes, const char *pvPrefix,
+                                        int movingPollPeriod, int idlePollPeriod)
 {
-	new devMotorController(portName, MotorPortName, 1+numAxes, pvPrefix);
+	double moving = (movingPollPeriod > 0) ? movingPollPeriod / 1000.0 : DEFAULT_MOVING_POLL_PERIOD;
+	double idle = (idlePollPeriod > 0) ? idlePollPeriod / 1000.0 : DEFAULT_IDLE_POLL_PERIOD;
+	new devMotorController(portName, MotorPortName, 1+numAxes, pvPrefix, moving, idle);
 	return(asynSuccess);
 }
 
@@ -67,14 +77,18 @@ static const iocshArg devMotorCreateControllerArg0 = {"Port name", iocshArgStrin
 static const iocshArg devMotorCreateControllerArg1 = {"EPICS ASYN TCP motor port name", iocshArgString};
 static const iocshArg devMotorCreateControllerArg2 = {"Number of axes", iocshArgInt};
 static const iocshArg devMotorCreateControllerArg3 = {"PV prefix", iocshArgString};
+static const iocshArg devMotorCreateControllerArg4 = {"Moving poll period (ms)", iocshArgInt};
+static const iocshArg devMotorCreateControllerArg5 = {"Idle poll period (ms)", iocshArgInt};
 static const iocshArg * const devMotorCreateControllerArgs[] = {&devMotorCreateControllerArg0,
                                                              &devMotorCreateControllerArg1,
                                                              &devMotorCreateControllerArg2,
-															 &devMotorCreateControllerArg3};
-static const iocshFuncDef devMotorCreateControllerDef = {"devMotorCreateController", 4, devMotorCreateControllerArgs};
+															 &devMotorCreateControllerArg3,
+															 &devMotorCreateControllerArg4,
+															 &devMotorCreateControllerArg5};
+static const iocshFuncDef devMotorCreateControllerDef = {"devMotorCreateController", 6, devMotorCreateControllerArgs};
 static void devMotorCreateContollerCallFunc(const iocshArgBuf *args)
 {
-  devMotorCreateController(args[0].sval, args[1].sval, args[2].ival, args[3].sval);
+  devMotorCreateController(args[0].sval, args[1].sval, args[2].ival, args[3].sval, args[4].ival, args[5].ival);
 }
 
 
@@ -142,7 +142,9 @@ DataValue& DataValue::operator= (const DataValue& dval) noexcept
 		*(type_wstring*) mydata = *(type_wstring*)dval.mydata;
 		break;
 	case data_type_enum::dtBinary:
-		memcpy (mydata, (const type_binary)mydata, mysize);
+		while (dval.mybinlock.test_and_set()) {}
+		memcpy (mydata, (const type_binary)dval.mydata, mysize);
+		dval.mybinlock.clear();
 		break;
 	}
 	myuserdirty.store (dval.myuserdirty.load(), DataValueTypeDef::memory_order);
@@ -170,6 +172,7 @@ void DataValue::Init (data_type_enum rt, size_type len) noexcept
 	}
 	mydata = nullptr;
 	mytype = rt;
+	mybinlock.clear();
 	switch (mytype) 
 	{
 	case data_type_enum::dtInvalid:
@@ -239,6 +242,7 @@ void DataValue::Init (data_type_enum rt, size_type len) noexcept
 		break;
 	case data_type_enum::dtBinary:
 		mydata = (data_type) new (std::nothrow) char[len];
+		if (mydata) memset (mydata, 0, len);
 		mysize = len;
 		break;
 	}
@@ -410,10 +414,10 @@ DataValue::ReadBinary (atomic_bool& dirty, type_binary p, size_type len) const n
 		if (len != mysize) {
 			return 0;
 		}
-		// Really need a mutex here to protect the memcpy.
-		// However, this is currently not used.
+		while (mybinlock.test_and_set()) {}
 		dirty.store (false, DataValueTypeDef::memory_order); // must be first
 		memcpy (p, (const type_binary)mydata, len);
+		mybinlock.clear();
 		return mysize;
 	default:
 		return 0;
@@ -461,12 +465,13 @@ DataValue::WriteBinary (atomic_bool& dirty, const atomic_bool& pend,
 		if (len != mysize) {
 			return 0;
 		}
-		if (pend.load(DataValueTypeDef::memory_order)) return false;
-		// Really need a mutex here to protect the memcpy; also doesn't
-		// check if the new value is different form the old, always sets dirty.
-		// However, this is currently not used.
+		if (pend.load(DataValueTypeDef::memory_order)) return 0;
+		// doesn't check if the new value is different form the old, always sets dirty
+		while (mybinlock.test_and_set()) {}
 		memcpy ((type_binary)mydata, p, len);
-		dirty.store (false, DataValueTypeDef::memory_order); // must be last
+		mybinlock.clear();
+		myvalid.store (true, DataValueTypeDef::memory_order);
+		dirty.store (true, DataValueTypeDef::memory_order); // must be last
 		return mysize;
 	default:
 		return 0;
@@ -503,10 +508,28 @@ bool DataValue::GetValid (atomic_bool& dirty) const noexcept
  ************************************************************************/
 BasePLC::time_type BaseRecord::get_timestamp() const noexcept
 {
+	if (valuestamp.get()) return valuestamp.get();
+	const time_stamp* const ts = plc ? plc->get_time_stamp() : nullptr;
+	if (ts) return ts->get();
 	if (!parent) return 0;
 	return parent->get_timestamp();
 }
 
+/* BaseRecord::get_timestamp_epics
+ ************************************************************************/
+void BaseRecord::get_timestamp_epics (unsigned int& sec, unsigned int& nsec) const noexcept
+{
+	const time_stamp* ts = valuestamp.get() ? &valuestamp : nullptr;
+	if (!ts && plc) ts = plc->get_time_stamp();
+	if (!ts && parent) ts = &parent->get_time_stamp();
+	if (ts) {
+		ts->get_epics (sec, nsec);
+	}
+	else {
+		sec = nsec = 0;
+	}
+}
+
 /************************************************************************/
 /* BasePLC */
 /************************************************************************/
@@ -514,7 +537,7 @@ BasePLC::time_type BaseRecord::get_timestamp() const noexcept
 /* BasePLC::BasePLC
  ************************************************************************/
 BasePLC::BasePLC() noexcept
-	: timestamp (0), read_scanner_period (1000), write_scanner_period (1000),
+	: read_scanner_period (1000), write_scanner_period (1000),
 	update_scanner_period (1000), scanners_active (false)
 {
 	records.max_load_factor (0.5);
@@ -578,16 +601,56 @@ bool BasePLC::get_next (BaseRecordPtr& next, const BaseRecord* prev) const
 	return true;
 }
 
-/* BasePLC::get_timestamp_unix
- ************************************************************************/
+/************************************************************************/
+/* time_stamp */
+/************************************************************************/
+
 static constexpr BasePLC::time_type TICKS_PER_SECOND = 10000000ULL;
 static constexpr BasePLC::time_type EPOCH_DIFFERENCE = 11644473600ULL;
+/// Seconds between the unix epoch and the EPICS epoch (1990-01-01)
+static constexpr BasePLC::time_type EPICS_EPOCH_DIFFERENCE = 631152000ULL;
+
+/* time_stamp::get
+ ************************************************************************/
+time_stamp::time_type time_stamp::get() const noexcept
+{
+	const time_type e = epics.load();
+	if (!e) return 0;
+	return ((e >> 32) + EPOCH_DIFFERENCE + EPICS_EPOCH_DIFFERENCE) * TICKS_PER_SECOND +
+		(e & 0xFFFFFFFFULL) / 100;
+}
+
+/* time_stamp::set
+ ************************************************************************/
+void time_stamp::set (time_type ft) noexcept
+{
+	const time_type sec = ft / TICKS_PER_SECOND;
+	time_type e = 0;
+	// before the EPICS epoch: leave zero
+	if (sec >= EPOCH_DIFFERENCE + EPICS_EPOCH_DIFFERENCE) {
+		e = ((sec - EPOCH_DIFFERENCE - EPICS_EPOCH_DIFFERENCE) << 32) |
+			((ft % TICKS_PER_SECOND) * 100);
+	}
+	epics = e;
+}
+
+/* time_stamp::update
+ ************************************************************************/
+void time_stamp::update() noexcept
+{
+	time_type ft = 0;
+	GetSystemTimePreciseAsFileTime ((LPFILETIME)&ft);
+	set (ft);
+}
+
+/* BasePLC::get_timestamp_unix
+ ************************************************************************/
 
 time_t BasePLC::get_timestamp_unix() const noexcept
 {
     time_type temp;
 	//convert from 100ns intervals to seconds
-    temp = timestamp / TICKS_PER_SECOND; 
+    temp = timestamp.get() / TICKS_PER_SECOND; 
 	// too early? return 0
 	if (temp < EPOCH_DIFFERENCE) {
 		return 0;
@@ -602,7 +665,7 @@ time_t BasePLC::get_timestamp_unix() const noexcept
  ************************************************************************/
 void BasePLC::update_timestamp() noexcept
 {
-	GetSystemTimeAsFileTime ((LPFILETIME )&timestamp);
+	timestamp.update();
 }
 
 /* BasePLC::count
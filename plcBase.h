@@ -20,12 +20,94 @@ class BaseRecord;
 class BasePLC;
 
 
+/** This is an enumerated type listing all the available data types
+    @brief Data type enumeration
+ ************************************************************************/
+enum class data_type_enum 
+{
+	/// Invalid data type
+	dtInvalid,
+	/// Boolean
+	dtBool,
+	/// 1-byte integer
+	dtInt8,
+	/// 1-byte unsigned integer
+	dtUInt8,
+	/// 2-byte integer
+	dtInt16,
+	/// 2-byte unsigned integer
+	dtUInt16,
+	/// 4-byte integer
+	dtInt32,
+	/// 4-byte unsigned integer
+	dtUInt32,
+	/// 8-byte integer
+	dtInt64,
+	/// 8-byte unsigned integer
+	dtUInt64,
+	/// 4-byte single precision floating point
+	dtFloat,
+	/// 8-byte double precision floating point
+	dtDouble,
+	/// string class
+	dtString,
+	/// wstring class
+	dtWString,
+	/// binary object
+	dtBinary
+};
+
 /** This is a smart pointer to a PLC 
     @brief Smart pointer to PLC
 ************************************************************************/
 using BasePLCPtr = std::shared_ptr<BasePLC>;
 
 
+/** Time stamp of a read. Keeps the time in the EPICS representation 
+	(seconds and nanoseconds since 1990-01-01 UTC), which is computed once
+	when the time stamp is set from a file time (100ns ticks since 
+	1601-01-01 UTC). Device support copies it instead of converting the 
+	time for every record. Seconds and nanoseconds are packed into a 
+	single atomic, since the scanner sets the time stamp while records 
+	read it. Times before the EPICS epoch are stored as zero (not set).
+	@brief Time stamp
+ ************************************************************************/
+class time_stamp
+{
+public:
+	/// Define file time type
+	using time_type = unsigned long long;
+
+	/// Default constructor
+	time_stamp() noexcept = default;
+	/// Copy constructor
+	time_stamp (const time_stamp& ts) noexcept
+		: epics (ts.epics.load()) {}
+	/// Assignment operator
+	time_stamp& operator= (const time_stamp& ts) noexcept {
+		epics = ts.epics.load(); return *this; }
+
+	/// Get file time (0 if never set)
+	time_type get() const noexcept;
+	/// Get EPICS time stamp
+	/// @param sec Seconds since 1990-01-01 (return)
+	/// @param nsec Nanoseconds (return)
+	void get_epics (unsigned int& sec, unsigned int& nsec) const noexcept {
+		const time_type e = epics.load();
+		sec = (unsigned int)(e >> 32); 
+		nsec = (unsigned int)(e & 0xFFFFFFFFULL); }
+	/// Set file time and compute the EPICS time stamp
+	/// @param ft File time (100ns ticks since 1601-01-01)
+	void set (time_type ft) noexcept;
+	/// Set to the current time (high resolution)
+	void update() noexcept;
+
+protected:
+	/// EPICS seconds (upper 32 bits) and nanoseconds (lower 32 bits)
+	std::atomic<time_type>	epics = 0;
+};
+
+
 /** This is a base class for an abstract interface to access the PLC 
     (slave) or the user side (master).
     @brief Abstract interface
@@ -58,6 +140,13 @@ public:
 	virtual void printVal (FILE* fp) {}
 	/// Get symbol name
 	virtual const char* get_symbol_name() const noexcept { return nullptr; }
+	/// Get element type of an array (dtInvalid if not an array)
+	virtual data_type_enum get_element_type() const noexcept { 
+		return data_type_enum::dtInvalid; }
+	/// Get time stamp of the last read
+	/// @return Time stamp, nullptr to use the time stamp of the PLC
+	virtual const time_stamp* get_time_stamp() const noexcept { 
+		return nullptr; }
 protected:
 	/// Pointer to tag/channel record associated with this interface
 	BaseRecord&			record;
@@ -68,42 +157,6 @@ protected:
  ************************************************************************/
 using InterfacePtr = std::unique_ptr<Interface>;
 
-/** This is an enumerated type listing all the available data types
-    @brief Data type enumeration
- ************************************************************************/
-enum class data_type_enum 
-{
-	/// Invalid data type
-	dtInvalid,
-	/// Boolean
-	dtBool,
-	/// 1-byte integer
-	dtInt8,
-	/// 1-byte unsigned integer
-	dtUInt8,
-	/// 2-byte integer
-	dtInt16,
-	/// 2-byte unsigned integer
-	dtUInt16,
-	/// 4-byte integer
-	dtInt32,
-	/// 4-byte unsigned integer
-	dtUInt32,
-	/// 8-byte integer
-	dtInt64,
-	/// 8-byte unsigned integer
-	dtUInt64,
-	/// 4-byte single precision floating point
-	dtFloat,
-	/// 8-byte double precision floating point
-	dtDouble,
-	/// string class
-	dtString,
-	/// wstring class
-	dtWString,
-	/// binary object
-	dtBinary
-};
 
 /** Traits class for data value
     @brief Data value traits
@@ -207,8 +260,7 @@ struct DataValueTypeDef
 	The same logic applies for writes by the user and reads by the plc.
 
 	Data access is guaranteed to be atomic and MT safe for the simple
-	data types. For strings a mutex is used. If binary data is used, it 
-	is not atomic and no mutex is used. Construction, initialization 
+	data types. For strings and binary data a spin lock is used. Construction, initialization 
 	and destruction is not MT safe and all data access has to be 
 	stopped during these operations. 
 
@@ -472,6 +524,8 @@ protected:
 	mutable atomic_bool		myuserdirty;
 	/// Dirty flag indicating plc needs to update
 	mutable atomic_bool		myplcdirty;
+	/// Spin lock protecting binary data
+	mutable std::atomic_flag mybinlock;
 };
 
 /** Enum for access rights of a record
@@ -511,6 +565,16 @@ public:
 		data_type_enum rt, Interface* puser = nullptr, Interface* pplc = nullptr) noexcept
 		: name (recordName), access (access_rights_enum::read_write), process (true), value (rt), 
 		plc (pplc), user(puser), parent (nullptr) {}
+	/// Constructor
+	/// @param recordName Name of tag/channel
+	/// @param rt Data type
+	/// @param len Length of data (binary only)
+	/// @param puser Pointer to user interface object (will be adopted!)
+	/// @param pplc Pointer to plc interface object (will be adopted!)
+	BaseRecord (const std::stringcase& recordName, data_type_enum rt, size_type len,
+		Interface* puser = nullptr, Interface* pplc = nullptr) noexcept
+		: name (recordName), access (access_rights_enum::read_write), process (true), value (rt, len), 
+		plc (pplc), user(puser), parent (nullptr) {}
 	/// Desctructor
 	virtual ~BaseRecord() {};
 
@@ -528,6 +592,16 @@ public:
 	void set_access_rights(access_rights_enum rights) noexcept { access = rights; };
 	/// Get time stamp
 	time_type get_timestamp() const noexcept;
+	/// Get time stamp in EPICS representation
+	/// @param sec Seconds since 1990-01-01 (return)
+	/// @param nsec Nanoseconds (return)
+	void get_timestamp_epics (unsigned int& sec, unsigned int& nsec) const noexcept;
+	/// Set the time stamp of the value as provided by the PLC
+	/// Takes precedence over the read and PLC time stamps
+	/// @param tstamp File time (100ns ticks since 1601-01-01)
+	void PlcSetTimestamp (time_type tstamp) noexcept { valuestamp.set (tstamp); }
+	/// Clear the time stamp of the value provided by the PLC
+	void PlcClearTimestamp() noexcept { valuestamp.set (0); }
 
 	/// Get pointer to user interface (no ownership transfer)
 	virtual Interface* get_userInterface() const noexcept { return user.get(); };
@@ -692,6 +766,8 @@ protected:
 	atomic_bool				process;
 	/// Data value
 	DataValue				value;
+	/// Time stamp of the value provided by the PLC (0 if none)
+	time_stamp				valuestamp;
 	/// PLC interface (master)
 	InterfacePtr			plc;
 	/// User interface (slave)
@@ -819,12 +895,14 @@ public:
 	virtual void printRecord (const std::string& var) {};
 
 	/// Get time stamp
-	virtual time_type get_timestamp() const noexcept { return timestamp; }
+	virtual time_type get_timestamp() const noexcept { return timestamp.get(); }
+	/// Get time stamp including its EPICS representation
+	const time_stamp& get_time_stamp() const noexcept { return timestamp; }
 	/// Get time stamp as unix time (seconds since 1970-01-01 00:00:00)
 	/// Does not include leap seconds
 	virtual time_t get_timestamp_unix() const noexcept;
 	/// Set time stamp
-	virtual void set_timestamp (time_type tstamp) noexcept { timestamp = tstamp; }
+	virtual void set_timestamp (time_type tstamp) noexcept { timestamp.set (tstamp); }
 	/// Set time stamp to current time
 	virtual void update_timestamp() noexcept;
 
@@ -863,7 +941,7 @@ protected:
 	/// The load factor is initialized to 0.5.
 	BaseRecordList		records;
 	/// Time stamp
-	time_type			timestamp;
+	time_stamp			timestamp;
 	/// read scanner period in ms
 	int					read_scanner_period;
 	/// write scanner period in ms
@@ -0,0 +1,298 @@
+#include "tcBench.h"
+#include "devTc.h"
+#include "tcSim.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbLock.h"
+#include "epicsThread.h"
+#include <chrono>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/** @file tcBench.cpp
+	Defines methods for the IOC throughput benchmark.
+ ************************************************************************/
+
+using namespace std;
+using namespace TcComms;
+
+namespace DevTc {
+
+/** Get the CPU time used by the process in seconds
+	@brief Process CPU time
+ ************************************************************************/
+static double process_cpu_time() noexcept
+{
+#ifdef _WIN32
+	FILETIME create, exit, kernel, user;
+	if (!GetProcessTimes (GetCurrentProcess(), &create, &exit, &kernel, &user)) {
+		return 0;
+	}
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return 1E-7 * (double)(k.QuadPart + u.QuadPart);
+#else
+	struct rusage ru {};
+	if (getrusage (RUSAGE_SELF, &ru)) {
+		return 0;
+	}
+	return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+		1E-6 * (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+#endif
+}
+
+/* tcBenchmark::~tcBenchmark
+ ************************************************************************/
+tcBenchmark::~tcBenchmark()
+{
+	unsubscribe();
+}
+
+/* tcBenchmark::value_changed
+ ************************************************************************/
+void tcBenchmark::value_changed (void* user, dbChannel* chan,
+	int eventsRemaining, db_field_log* pfl)
+{
+	probe* const p = static_cast<probe*>(user);
+	if (!p || !p->bench->measuring.load (memory_order_relaxed)) return;
+	const auto now = chrono::steady_clock::now();
+	++p->bench->changes;
+	if (!p->latency) return;
+	// the value written by the simulation identifies the change
+	double val = 0;
+	long nreq = 1;
+	dbScanLock (dbChannelRecord (chan));
+	const long status = dbChannelGet (chan, DBR_DOUBLE, &val, nullptr, &nreq, pfl);
+	dbScanUnlock (dbChannelRecord (chan));
+	chrono::steady_clock::time_point t;
+	if (status || !tcSimulation::get().get_change_time (val, p->group, p->offset, t)) {
+		return;
+	}
+	try {
+		std::lock_guard lock (p->bench->sampleMutex);
+		if (p->bench->samples.size() < bench_max_samples) {
+			p->bench->samples.push_back (chrono::duration<double, milli>(now - t).count());
+		}
+	}
+	catch (...) {}
+}
+
+/* tcBenchmark::subscribe
+ ************************************************************************/
+bool tcBenchmark::subscribe()
+{
+	// collect the records of the simulated PLCs
+	vector<std::string> names;
+	res.records = 0;
+	plc::System::get().for_each ([this, &names](plc::BasePLC* plc) {
+		const TcPLC* const tcplc = dynamic_cast<const TcPLC*>(plc);
+		if (!tcplc) return;
+		const AmsAddr addr = tcplc->get_addr();
+		if (!tcSimulation::get().find (&addr)) return;
+		plc->for_each ([this, &names](plc::BaseRecord* rec) {
+			++res.records;
+			const EpicsInterface* const epics =
+				dynamic_cast<const EpicsInterface*>(rec->get_userInterface());
+			const TCatInterface* const tcat =
+				dynamic_cast<const TCatInterface*>(rec->get_plcInterface());
+			const dbCommon* const prec = epics ? epics->get_pEpicsRecord() : nullptr;
+			if (!prec || !tcat) return;
+			bool latency = false;
+			switch (rec->get_data().get_data_type()) {
+			case plc::data_type_enum::dtInt32:
+			case plc::data_type_enum::dtUInt32:
+			case plc::data_type_enum::dtInt64:
+			case plc::data_type_enum::dtUInt64:
+			case plc::data_type_enum::dtFloat:
+			case plc::data_type_enum::dtDouble:
+				latency = true;
+				break;
+			default:
+				break;
+			}
+			names.push_back (prec->name);
+			probes.push_back (make_unique<probe>(probe{this, nullptr, nullptr,
+				tcat->get_indexGroup(), tcat->get_indexOffset(), latency}));
+		});
+	});
+	if (probes.empty()) {
+		printf ("No records of a simulated ADS target\n");
+		return false;
+	}
+
+	// subscribe to value changes
+	eventCtx = db_init_events();
+	if (!eventCtx || db_start_events (eventCtx, "tcBench", nullptr, nullptr,
+		epicsThreadPriorityMedium)) {
+		printf ("Failed to start the event task\n");
+		return false;
+	}
+	res.monitored = 0;
+	res.probes = 0;
+	for (size_t i = 0; i < probes.size(); ++i) {
+		probe& p = *probes[i];
+		p.chan = dbChannelCreate (names[i].c_str());
+		if (!p.chan) continue;
+		if (dbChannelOpen (p.chan)) {
+			dbChannelDelete (p.chan);
+			p.chan = nullptr;
+			continue;
+		}
+		p.sub = db_add_event (eventCtx, p.chan, value_changed, &p, DBE_VALUE);
+		if (!p.sub) continue;
+		db_event_enable (p.sub);
+		++res.monitored;
+		if (p.latency) ++res.probes;
+	}
+	return res.monitored > 0;
+}
+
+/* tcBenchmark::unsubscribe
+ ************************************************************************/
+void tcBenchmark::unsubscribe() noexcept
+{
+	measuring = false;
+	for (auto& p : probes) {
+		if (p->sub) db_cancel_event (p->sub);
+		if (p->chan) dbChannelDelete (p->chan);
+	}
+	probes.clear();
+	if (eventCtx) {
+		db_close_events (eventCtx);
+		eventCtx = nullptr;
+	}
+}
+
+/* tcBenchmark::run
+ ************************************************************************/
+bool tcBenchmark::run (double seconds)
+{
+	if (!plc::System::get().is_ioc_running()) {
+		printf ("IOC is not initialized\n");
+		return false;
+	}
+	if (!tcSimulation::get().is_active()) {
+		printf ("No simulated ADS target, use tcSimTarget\n");
+		return false;
+	}
+	res = results{};
+	if (!subscribe()) {
+		unsubscribe();
+		return false;
+	}
+	printf ("Benchmark of %i records (%i latency probes) for %g s\n",
+		res.monitored, res.probes, seconds);
+
+	// let the initial monitors pass
+	epicsThreadSleep (bench_settle_time);
+	EpicsInterface::set_callback_queue_highwatermark_reset();
+	samples.clear();
+	changes = 0;
+	const tcSimTarget::statistics s0 = tcSimulation::get().get_statistics();
+	const double cpu0 = process_cpu_time();
+	const auto t0 = chrono::steady_clock::now();
+	measuring = true;
+
+	// poll the callback queues (updates the high water mark on EPICS 3)
+	int used[bench_priorities] = {};
+	auto t1 = t0;
+	while (chrono::duration<double>(t1 - t0).count() < seconds) {
+		for (int pri = 0; pri < bench_priorities; ++pri) {
+			used[pri] = std::max (used[pri], EpicsInterface::get_callback_queue_used (pri));
+		}
+		epicsThreadSleep (1E-3 * bench_poll_period);
+		t1 = chrono::steady_clock::now();
+	}
+
+	measuring = false;
+	const double cpu1 = process_cpu_time();
+	const tcSimTarget::statistics s1 = tcSimulation::get().get_statistics();
+	for (int pri = 0; pri < bench_priorities; ++pri) {
+		res.queueSize[pri] = EpicsInterface::get_callback_queue_size (pri);
+		res.queueHighWater[pri] = std::max (used[pri],
+			EpicsInterface::get_callback_queue_highwatermark (pri));
+		res.queueOverflow[pri] = EpicsInterface::get_callback_queue_overflow (pri);
+	}
+	unsubscribe();
+
+	// evaluate
+	res.duration = chrono::duration<double>(t1 - t0).count();
+	if (res.duration <= 0) return false;
+	res.plcChanges = (double)(s1.changes - s0.changes) / res.duration;
+	res.recordChanges = (double)changes.load() / res.duration;
+	res.readBytes = (double)(s1.readBytes - s0.readBytes) / res.duration;
+	res.notifications = (double)(s1.notifications - s0.notifications) / res.duration;
+	res.cpu = 100.0 * (cpu1 - cpu0) / res.duration;
+	res.cpuPer10k = (res.records > 0) ? res.cpu * 10000.0 / res.records : 0;
+	std::lock_guard lock (sampleMutex);
+	res.samples = (int)samples.size();
+	if (!samples.empty()) {
+		sort (samples.begin(), samples.end());
+		const double q[4] = {0.5, 0.9, 0.99, 0.999};
+		for (int i = 0; i < 4; ++i) {
+			const size_t idx = std::min (samples.size() - 1, (size_t)(q[i] * samples.size()));
+			res.latency[i] = samples[idx];
+		}
+		res.latency[4] = samples.back();
+	}
+	return true;
+}
+
+/* tcBenchmark::print
+ ************************************************************************/
+void tcBenchmark::print (FILE* fp) const
+{
+	if (!fp) return;
+	static const char* const priority[bench_priorities] = {"low", "medium", "high"};
+	fprintf (fp, "Records:             %i (%i monitored, %i latency probes)\n",
+		res.records, res.monitored, res.probes);
+	fprintf (fp, "Duration:            %.1f s\n", res.duration);
+	fprintf (fp, "PLC changes:         %.0f /s\n", res.plcChanges);
+	fprintf (fp, "Record changes:      %.0f /s\n", res.recordChanges);
+	fprintf (fp, "ADS read:            %.3f MB/s\n", 1E-6 * res.readBytes);
+	fprintf (fp, "ADS notifications:   %.0f /s\n", res.notifications);
+	fprintf (fp, "Latency (ms):        p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f (%i samples)\n",
+		res.latency[0], res.latency[1], res.latency[2], res.latency[3], res.latency[4], res.samples);
+	for (int pri = 0; pri < bench_priorities; ++pri) {
+		fprintf (fp, "Callback queue %-6s high water mark %i of %i, %i overflows\n",
+			priority[pri], res.queueHighWater[pri], res.queueSize[pri], res.queueOverflow[pri]);
+	}
+	fprintf (fp, "CPU:                 %.1f %% (%.2f %% per 10k records)\n",
+		res.cpu, res.cpuPer10k);
+}
+
+/* tcBenchmark::write_json
+ ************************************************************************/
+bool tcBenchmark::write_json (const std::stringcase& fname) const
+{
+	FILE* fp = nullptr;
+	if (fopen_s (&fp, fname.c_str(), "w") || !fp) {
+		return false;
+	}
+	fprintf (fp, "{\n  \"records\": %i,\n  \"monitored\": %i,\n  \"probes\": %i,\n",
+		res.records, res.monitored, res.probes);
+	fprintf (fp, "  \"seconds\": %.3f,\n  \"plc_changes_per_s\": %.1f,\n"
+		"  \"record_changes_per_s\": %.1f,\n  \"read_bytes_per_s\": %.1f,\n"
+		"  \"notifications_per_s\": %.1f,\n",
+		res.duration, res.plcChanges, res.recordChanges, res.readBytes, res.notifications);
+	fprintf (fp, "  \"latency_ms\": {\"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, "
+		"\"p99_9\": %.4f, \"max\": %.4f, \"samples\": %i},\n",
+		res.latency[0], res.latency[1], res.latency[2], res.latency[3], res.latency[4], res.samples);
+	fprintf (fp, "  \"callback_queues\": [");
+	for (int pri = 0; pri < bench_priorities; ++pri) {
+		fprintf (fp, "%s\n    {\"priority\": %i, \"size\": %i, \"high_water\": %i, \"overflows\": %i}",
+			pri ? "," : "", pri, res.queueSize[pri], res.queueHighWater[pri], res.queueOverflow[pri]);
+	}
+	fprintf (fp, "\n  ],\n  \"cpu_percent\": %.2f,\n  \"cpu_percent_per_10k_records\": %.3f\n}\n",
+		res.cpu, res.cpuPer10k);
+	return fclose (fp) == 0;
+}
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "stdafx.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include "dbEvent.h"
+
+/** @file tcBench.h
+	Header which includes a throughput benchmark of the IOC running
+	against simulated ADS targets.
+ ************************************************************************/
+
+/** Forward declaration
+ ************************************************************************/
+struct dbChannel;
+struct db_field_log;
+
+namespace DevTc {
+
+/** @defgroup tcbenchgroup IOC benchmark
+ ************************************************************************/
+/** @{ */
+
+/// Number of callback queue priorities
+constexpr int bench_priorities = 3;
+/// Maximum number of latency samples
+constexpr int bench_max_samples = 1000000;
+/// Time in seconds to let the initial monitors settle before measuring
+constexpr double bench_settle_time = 2.0;
+/// Period in ms to poll the callback queues
+constexpr int bench_poll_period = 10;
+
+/** This class measures the throughput of the IOC, when the TwinCAT
+	records are served by simulated ADS targets. It subscribes to the
+	value of every record and measures the value changes delivered per
+	second, the latency from the change in the simulated PLC memory to
+	the monitor of the record, the high water marks of the callback
+	queues and the CPU time used per 10k records.
+	@brief IOC throughput benchmark
+ ************************************************************************/
+class tcBenchmark
+{
+public:
+	/// Results of a benchmark
+	struct results {
+		/// Number of records of simulated PLCs
+		int records = 0;
+		/// Number of records with a monitor
+		int monitored = 0;
+		/// Number of records which measure the latency
+		int probes = 0;
+		/// Measurement time in seconds
+		double duration = 0;
+		/// Value changes per second in the simulated PLC memory
+		double plcChanges = 0;
+		/// Value changes per second delivered to the records
+		double recordChanges = 0;
+		/// Bytes per second read from the simulated PLCs
+		double readBytes = 0;
+		/// Notifications per second sent by the simulated PLCs
+		double notifications = 0;
+		/// Number of latency samples
+		int samples = 0;
+		/// Latency percentiles 50, 90, 99, 99.9 and maximum in ms
+		double latency[5] = {};
+		/// Size of the callback queues
+		int queueSize[bench_priorities] = {};
+		/// High water mark of the callback queues
+		int queueHighWater[bench_priorities] = {};
+		/// Number of callback queue overflows
+		int queueOverflow[bench_priorities] = {};
+		/// Process CPU time in % of one core
+		double cpu = 0;
+		/// Process CPU time in % of one core per 10k records
+		double cpuPer10k = 0;
+	};
+
+	/// Constructor
+	tcBenchmark() = default;
+	/// Destructor
+	~tcBenchmark();
+	/// Deleted copy constructor
+	tcBenchmark (const tcBenchmark&) = delete;
+	/// Deleted copy assignment
+	tcBenchmark& operator= (const tcBenchmark&) = delete;
+
+	/// Run the benchmark
+	/// @param seconds Measurement time in seconds
+	/// @return true if successful
+	bool run (double seconds);
+	/// Get the results
+	const results& get_results() const noexcept { return res; }
+	/// Print the results
+	void print (FILE* fp) const;
+	/// Write the results as JSON
+	/// @param fname Name of JSON file
+	/// @return true if successful
+	bool write_json (const std::stringcase& fname) const;
+
+protected:
+	/// Monitored record
+	struct probe {
+		/// Benchmark
+		tcBenchmark*	bench;
+		/// Channel of the record value
+		dbChannel*		chan;
+		/// Event subscription
+		dbEventSubscription	sub;
+		/// Index group of the TwinCAT symbol
+		unsigned long	group;
+		/// Index offset of the TwinCAT symbol
+		unsigned long	offset;
+		/// Measure the latency of this record
+		bool			latency;
+	};
+
+	/// Subscribe to the records of all simulated PLCs
+	bool subscribe();
+	/// Cancel all subscriptions
+	void unsubscribe() noexcept;
+	/// Monitor callback
+	static void value_changed (void* user, dbChannel* chan,
+		int eventsRemaining, db_field_log* pfl);
+
+	/// Event context
+	dbEventCtx		eventCtx = nullptr;
+	/// Monitored records
+	std::vector<std::unique_ptr<probe>> probes;
+	/// True while measuring
+	std::atomic<bool> measuring = false;
+	/// Value changes delivered to the records
+	std::atomic<long long> changes = 0;
+	/// Latency samples in ms
+	std::vector<double> samples;
+	/// Mutex for samples
+	std::mutex		sampleMutex;
+	/// Results
+	results			res;
+};
+
+/** @} */
+
+}
@@ -1,4 +1,5 @@
 #include "tcComms.h"
+#include "tcSim.h"
 #include "infoPlc.h"
 #include "ParseTpy.h"
 #include "windows.h"
@@ -84,6 +85,166 @@ void errorPrintf(int nErr) noexcept
 		printf("Error code %i: ~~~MYSTERY ERROR!!!~~~ Go Google \"ADS return codes\"!\n",nErr);
 }
 
+/* Error codes which have no name in TcAdsDef.h
+ ************************************************************************/
+/// AMS error: port disabled
+constexpr long ads_err_port_disabled = 18;
+/// AMS error: port already connected
+constexpr long ads_err_port_connected = 19;
+/// AMS error: invalid AMS port
+constexpr long ads_err_invalid_port = 24;
+/// ADS error: server is in invalid state
+constexpr long ads_err_server_state = ERR_ADSERRS + 0x76;
+
+/** Checks if an ADS error code indicates a lost connection rather than 
+	an unreadable memory region
+	@brief is_connection_error
+ ************************************************************************/
+static bool is_connection_error(int nErr) noexcept
+{
+	switch (nErr) {
+	case GLOBALERR_TARGET_PORT:
+	case GLOBALERR_MISSING_ROUTE:
+	case ads_err_port_disabled:
+	case ads_err_port_connected:
+	case ads_err_invalid_port:
+	case ROUTERERR_NOTINITIALIZED:
+	case ROUTERERR_NOTACTIVATED:
+	case ADSERR_CLIENT_SYNCTIMEOUT:
+	case ADSERR_CLIENT_PORTNOTOPEN:
+	case ads_err_server_state:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Opens an ADS port, or a port of the simulated target of the address
+	@brief ads_open_port
+ ************************************************************************/
+static long ads_open_port (const AmsAddr* addr) noexcept
+{
+	tcSimTarget* const sim = tcSimulation::get().find (addr);
+	return sim ? sim->open_port() : AdsPortOpenEx();
+}
+
+/** Closes an ADS port, ports of simulated targets need no closing
+	@brief ads_close_port
+ ************************************************************************/
+static void ads_close_port (long port) noexcept
+{
+	if (!tcSimulation::is_sim_port (port)) {
+		AdsPortCloseEx (port);
+	}
+}
+
+/** ADS read, served by the simulated target if the address has one
+	@brief ads_read
+ ************************************************************************/
+static long ads_read (long port, AmsAddr* addr, unsigned long group, 
+	unsigned long offset, unsigned long length, void* data, 
+	unsigned long* ret) noexcept
+{
+	tcSimTarget* const sim = tcSimulation::get().find (addr);
+	return sim ? sim->read (group, offset, length, data, ret) :
+		AdsSyncReadReqEx2 (port, addr, group, offset, length, data, ret);
+}
+
+/** ADS read/write, served by the simulated target if the address has one
+	@brief ads_read_write
+ ************************************************************************/
+static long ads_read_write (long port, AmsAddr* addr, unsigned long group, 
+	unsigned long offset, unsigned long rlength, void* rdata, 
+	unsigned long wlength, void* wdata, unsigned long* ret) noexcept
+{
+	tcSimTarget* const sim = tcSimulation::get().find (addr);
+	return sim ? sim->read_write (group, offset, rlength, rdata, wlength, wdata, ret) :
+		AdsSyncReadWriteReqEx2 (port, addr, group, offset, rlength, rdata, 
+			wlength, wdata, ret);
+}
+
+/** Adds an ADS notification, served by the simulated target if the
+	address has one
+	@brief ads_add_notification
+ ************************************************************************/
+static long ads_add_notification (long port, AmsAddr* addr, unsigned long group,
+	unsigned long offset, AdsNotificationAttrib* attrib, 
+	PAdsNotificationFuncEx callback, unsigned long user, 
+	unsigned long* handle) noexcept
+{
+	tcSimTarget* const sim = tcSimulation::get().find (addr);
+	return sim ? sim->add_notification (group, offset, attrib, callback, user, handle) :
+		AdsSyncAddDeviceNotificationReqEx (port, addr, group, offset, attrib, 
+			callback, user, handle);
+}
+
+/** Deletes an ADS notification, served by the simulated target if the
+	address has one
+	@brief ads_del_notification
+ ************************************************************************/
+static long ads_del_notification (long port, AmsAddr* addr, 
+	unsigned long handle) noexcept
+{
+	tcSimTarget* const sim = tcSimulation::get().find (addr);
+	return sim ? sim->del_notification (handle) :
+		AdsSyncDelDeviceNotificationReqEx (port, addr, handle);
+}
+
+/* upload_symbols
+ ************************************************************************/
+bool upload_symbols (ParseTpy::symbol_upload& upload) noexcept
+{
+	try {
+		AmsAddr addr = {};
+		if (!upload.get_target().get (addr.netId.b[0], addr.netId.b[1], addr.netId.b[2],
+			addr.netId.b[3], addr.netId.b[4], addr.netId.b[5])) {
+			return false;
+		}
+		addr.port = upload.get_target().get_port();
+		const long port = ads_open_port (&addr);
+		if (port == 0) {
+			return false;
+		}
+		long nErr = 0;
+		// Optain local ADS address if netid is zero
+		if (!tcSimulation::is_sim_port (port) && (addr.netId.b[0] == 0) && (addr.netId.b[1] == 0) && (addr.netId.b[2] == 0) &&
+			(addr.netId.b[3] == 0) && (addr.netId.b[4] == 0) && (addr.netId.b[5] == 0)) {
+			const unsigned short p = addr.port;
+			nErr = AdsGetLocalAddressEx (port, &addr);
+			addr.port = p;
+		}
+		AdsSymbolUploadInfo2 info = {};
+		unsigned long ret = 0;
+		if (!nErr) {
+			nErr = ads_read (port, &addr, ADSIGRP_SYM_UPLOADINFO2, 0,
+				sizeof (info), &info, &ret);
+		}
+		if (!nErr) {
+			upload.get_symbols().resize (info.nSymSize);
+			nErr = ads_read (port, &addr, ADSIGRP_SYM_UPLOAD, 0,
+				info.nSymSize, upload.get_symbols().data(), &ret);
+			upload.get_symbols().resize (nErr ? 0 : ret);
+		}
+		if (!nErr) {
+			upload.get_datatypes().resize (info.nDatatypeSize);
+			nErr = ads_read (port, &addr, ADSIGRP_SYM_DT_UPLOAD, 0,
+				info.nDatatypeSize, upload.get_datatypes().data(), &ret);
+			upload.get_datatypes().resize (nErr ? 0 : ret);
+		}
+		ads_close_port (port);
+		if (nErr) {
+			upload.get_symbols().clear();
+			errorPrintf (nErr);
+			return false;
+		}
+		return true;
+	}
+	catch (...) {
+		upload.get_symbols().clear();
+		return false;
+	}
+}
+
 /************************************************************************
   TCatInterface
  ************************************************************************/
@@ -132,6 +293,15 @@ const TcPLC* TCatInterface::get_parent() const noexcept
 	return dynamic_cast<const TcPLC*>(record.get_parent());
 }
 
+/* TCatInterface::get_time_stamp
+ ************************************************************************/
+const plc::time_stamp* TCatInterface::get_time_stamp() const noexcept
+{
+	if (notify) return nullptr;
+	const plc::time_stamp* const ts = requestStamp.load();
+	return (ts && ts->get()) ? ts : nullptr;
+}
+
 /* TCatInterface::printTCatVal
  ************************************************************************/
 void TCatInterface::printVal (FILE* fp) noexcept
@@ -189,6 +359,10 @@ void TCatInterface::printVal (FILE* fp) noexcept
 	else {
 		fprintf(fp,"INVALID!!!");
 	}
+	// arrays only print the first element
+	if (elementType != plc::data_type_enum::dtInvalid) {
+		fprintf(fp, ", ... (%lu bytes)", tCatSymbol.length);
+	}
 	fprintf(fp,"\n");
 }
 
@@ -231,7 +405,7 @@ void tcProcWrite::operator () (BaseRecord* prec)
 {
 	if (!prec || !prec->PlcIsDirty()) return;
 	const TCatInterface* const tcat = dynamic_cast<TCatInterface*> (prec->get_plcInterface());
-	if (!tcat) return;
+	if (!tcat || !tcat->is_mapped()) return;
 	const long len = tcat->get_size();
 	if (len <= 0) return;
 	if (add (tcat->get_indexGroup(), tcat->get_indexOffset(), len)) {
@@ -309,7 +483,7 @@ void tcProcWrite::tcwrite() noexcept
 	char* ret = new (std::nothrow) char [4 * count];
 	if (!ret) return;
 	unsigned long read = 0;
-	const int nErr = AdsSyncReadWriteReqEx2(port, &addr, 0xF081, 
+	const int nErr = ads_read_write (port, &addr, 0xF081, 
 		static_cast<unsigned long>(count),
 		static_cast<unsigned long>(sizeof(long)*count), ret, 
 		static_cast<unsigned long>(3*sizeof(long)*count + size), ptr, &read);
@@ -325,6 +499,126 @@ void tcProcWrite::tcwrite() noexcept
 }
 
 
+/************************************************************************
+  tcScatterPool
+ ************************************************************************/
+
+/* tcScatterPool::start
+ ************************************************************************/
+bool tcScatterPool::start (int nthreads) noexcept
+{
+	stop();
+	try {
+		quit = false;
+		for (int i = 0; i < nthreads; ++i) {
+			workers.push_back (std::thread (&tcScatterPool::worker, this));
+		}
+	}
+	catch (...) {
+		stop();
+		return false;
+	}
+	return true;
+}
+
+/* tcScatterPool::stop
+ ************************************************************************/
+void tcScatterPool::stop() noexcept
+{
+	try {
+		{
+			std::lock_guard lock (mux);
+			quit = true;
+		}
+		wakeup.notify_all();
+		for (auto& t : workers) {
+			if (t.joinable()) t.join();
+		}
+		workers.clear();
+	}
+	catch (...) {
+		;
+	}
+}
+
+/* tcScatterPool::run
+ ************************************************************************/
+void tcScatterPool::run (size_t num, const shard_func& func) noexcept
+{
+	if (num == 0) return;
+	// nothing to share
+	if (workers.empty() || (num == 1)) {
+		work (num, func);
+		return;
+	}
+	try {
+		{
+			std::lock_guard lock (mux);
+			job = &func;
+			jobsize = num;
+			next = 0;
+			busy = workers.size();
+			++generation;
+		}
+		wakeup.notify_all();
+		// do our share
+		work (num, func);
+		// wait for all workers to finish
+		std::unique_lock lock (mux);
+		finished.wait (lock, [this] () noexcept { return busy == 0; });
+		job = nullptr;
+	}
+	catch (...) {
+		;
+	}
+}
+
+/* tcScatterPool::worker
+ ************************************************************************/
+void tcScatterPool::worker() noexcept
+{
+	unsigned long long seen = 0;
+	try {
+		while (true) {
+			const shard_func* func = nullptr;
+			size_t num = 0;
+			{
+				std::unique_lock lock (mux);
+				wakeup.wait (lock, [this, &seen] () noexcept { 
+					return quit || (generation != seen); });
+				if (quit) return;
+				seen = generation;
+				func = job;
+				num = jobsize;
+			}
+			if (func) work (num, *func);
+			{
+				std::lock_guard lock (mux);
+				if (--busy == 0) finished.notify_one();
+			}
+		}
+	}
+	catch (...) {
+		;
+	}
+}
+
+/* tcScatterPool::work
+ ************************************************************************/
+void tcScatterPool::work (size_t num, const shard_func& func) noexcept
+{
+	size_t i = 0;
+	while ((i = next.fetch_add (1)) < num) {
+		try {
+			func (i);
+		}
+		catch (...) {
+			;
+		}
+	}
+}
+
+
 /************************************************************************
   TcPLC
  ************************************************************************/
@@ -338,15 +632,17 @@ static constexpr time_t FileTimeToUnixSeconds(time_t windowsTicks) noexcept
  /* TcPLC::TcPLC constructor
   ************************************************************************/
 TcPLC::TcPLC (std::string tpyPath)
-	: addr(), pathTpy(tpyPath), timeTpy(0), checkTpy(false), validTpy(true), nRequest(0),
-	scanRateMultiple(default_multiple), cyclesLeft(default_multiple), update_workload (0),
-	ads_state (ADSSTATE_INVALID), ads_handle (0), ads_restart (false), nReadPort(0), nWritePort(0),
+	: addr(), pathTpy(tpyPath), timeTpy(0), checkTpy(false), validTpy(true), reloadActive(false), nRequest(0),
+	scatterThreads(default_scatter_threads), scanRateMultiple(default_multiple), 
+	cyclesLeft(default_multiple), update_workload (0),
+	ads_state (ADSSTATE_INVALID), ads_handle (0), sym_handle (0), symVersion (-1), ads_restart (false), nReadPort(0), nWritePort(0),
 	nNotificationPort(0), read_active(false), plcId(0)
 {
 	// modification time
 	path fpath(pathTpy);
 	//timeTpy = file_time_type::clock::to_time_t (last_write_time (fpath));
-	timeTpy = last_write_time(fpath).time_since_epoch().count();
+	std::error_code ec;
+	timeTpy = last_write_time(fpath, ec).time_since_epoch().count();
 
 	if (debug) {
 		const time_t unixt = FileTimeToUnixSeconds(timeTpy);
@@ -403,7 +699,8 @@ bool TcPLC::start()
 		return false;
 	}
 	// Optain local ADS address if netid is zero
-	if ((addr.netId.b[0] == 0) && (addr.netId.b[1] == 0) && (addr.netId.b[2] == 0) &&
+	tcSimTarget* const sim = tcSimulation::get().find (&addr);
+	if (!sim && (addr.netId.b[0] == 0) && (addr.netId.b[1] == 0) && (addr.netId.b[2] == 0) &&
 		(addr.netId.b[3] == 0) && (addr.netId.b[4] == 0) && (addr.netId.b[5] == 0)) {
 		const unsigned short port = addr.port;
 		const long nErr = AdsGetLocalAddressEx (nReadPort, &addr);
@@ -417,6 +714,21 @@ bool TcPLC::start()
 			addr.netId.b[3], addr.netId.b[4], addr.netId.b[5], port);
 	}
 
+	// start the worker pool distributing the read data
+	if (scatterThreads > 0) {
+		if (scatterPool.start (scatterThreads)) {
+			printf ("Using %i scatter threads for PLC %s\n", scatterThreads, name.c_str());
+		}
+		else {
+			printf ("Failed to start scatter threads for PLC %s\n", name.c_str());
+		}
+	}
+
+	// values of a simulated target change with the records of this PLC
+	if (sim) {
+		sim->attach (*this);
+	}
+
 	// Setup ADS notifications
 	setup_ads_notification();
 	// start scanners
@@ -434,13 +746,36 @@ static bool compByOffset(BaseRecordPtr recA, BaseRecordPtr recB)
 	return ((a->get_indexGroup() <= b->get_indexGroup()) && (a->get_indexOffset() < b->get_indexOffset()));
 }
 
+/* TcPLC::~TcPLC
+ ************************************************************************/
+TcPLC::~TcPLC()
+{
+	try {
+		if (reloadThread.joinable()) reloadThread.join();
+	}
+	catch (...) {
+		;
+	}
+	remove_ads_notification();
+}
+
+/* TcPLC::set_reload_info
+ ************************************************************************/
+void TcPLC::set_reload_info (const std::stringcase& options, 
+	const ParseUtil::replacement_rules& rules)
+{
+	reloadOptions = options;
+	reloadRules = rules;
+}
+
 /* Checks is tpy file is valid, ie. hasn't changed
  ************************************************************************/
 bool TcPLC::is_valid_tpy() noexcept
 {
-	if (validTpy && checkTpy.load()) {
+	// a failed reload is retried at the next check
+	if (checkTpy.load() && !reloadActive.load()) {
 		try {
-			checkTpy = false; // only check when we switch to online
+			checkTpy = false; // only check when we switch to online or symbols change
 			path fpath(pathTpy);
 			if (exists(fpath)) {
 				//time_t modtime = file_time_type::clock::to_time_t(last_write_time(fpath));
@@ -450,24 +785,179 @@ bool TcPLC::is_valid_tpy() noexcept
 			else {
 				validTpy = false;
 			}
-			if (!validTpy) {
-				printf("ABORT! Updated tpy file for PLC %s\nRESTART tcioc!\n", name.c_str());
+			// stop I/O and reload in the background
+			if (!validTpy && !reloadActive.exchange (true)) {
+				printf("Updated tpy file for PLC %s\nReloading...\n", name.c_str());
+				if (reloadThread.joinable()) reloadThread.join();
+				reloadThread = std::thread (&TcPLC::reload_tpy, this);
 			}
 		}
 		catch (...)
 		{
-			;
+			reloadActive = false;
+			printf("ABORT! Updated tpy file for PLC %s\nRetrying when the PLC goes online or its symbols change\n", name.c_str());
 		}
 	}
 	return validTpy;
 }
 
+/** Class for collecting the TCat symbol locations of a reloaded tpy file
+	@brief Remap processing
+ ************************************************************************/
+class tc_remap_processing
+{
+public:
+	/// Location and type name of a TCat symbol
+	using location = std::pair<DataPar, std::stringcase>;
+	/// Map of TCat names to locations
+	using location_map = std::unordered_map<std::stringcase, location>;
+
+	/// Constructor
+	/// @param r Replacement rules used to generate the TCat names
+	explicit tc_remap_processing (const ParseUtil::replacement_rules& r) noexcept
+		: rules (r) {}
+
+	/// Process a variable
+	/// @param arg Process argument describing the variable and type
+	/// @return True if successful
+	bool operator() (const ParseUtil::process_arg& arg) {
+		const ParseUtil::process_arg_tc* targ = 
+			dynamic_cast<const ParseUtil::process_arg_tc*>(&arg);
+		if (!targ) {
+			return false;
+		}
+		std::stringcase tcatname = arg.get_alias();
+		if (rules.HasRules()) {
+			tcatname = rules.apply_replacement_rules (tcatname);
+		}
+		const DataPar loc = { (unsigned long)targ->get_igroup(), 
+			(unsigned long)targ->get_ioffset(), (unsigned long)targ->get_bytesize() };
+		// binary structure records; never replace the waveform of an array
+		if (arg.get_process_type() == ParseUtil::process_type_enum::pt_binary) {
+			return symbols.emplace (tcatname, location (loc, arg.get_type_name())).second;
+		}
+		symbols[tcatname] = location (loc, 
+			arg.get_process_type() == ParseUtil::process_type_enum::pt_enum ? 
+			std::stringcase ("ENUM") : arg.get_type_name());
+		return true;
+	}
+
+	/// Get the collected symbols
+	const location_map& get_symbols() const noexcept { return symbols; }
+
+protected:
+	/// Replacement rules
+	const ParseUtil::replacement_rules& rules;
+	/// Collected symbols
+	location_map	symbols;
+};
+
+/* TcPLC::reload_tpy
+ ************************************************************************/
+void TcPLC::reload_tpy() noexcept
+{
+	const auto abort_reload = [this] () noexcept {
+		printf("ABORT! Updated tpy file for PLC %s\nRetrying when the PLC goes online or its symbols change\n", name.c_str());
+		reloadActive = false;
+	};
+	int nMapped = 0;
+	int nMoved = 0;
+	int nUnmapped = 0;
+	try {
+		// parse the updated tpy file without blocking the scanners
+		path fpath(pathTpy);
+		const time_t modtime = last_write_time(fpath).time_since_epoch().count();
+		FILE* inpf = nullptr;
+		if (fopen_s(&inpf, pathTpy.c_str(), "r") || !inpf) {
+			abort_reload();
+			return;
+		}
+		ParseUtil::optarg options (reloadOptions);
+		ParseTpy::tpy_file tpyfile;
+		tpyfile.getopt (options.argc(), options.argv(), options.argp());
+		const bool parsed = tpyfile.parse (inpf);
+		fclose (inpf);
+		if (!parsed) {
+			abort_reload();
+			return;
+		}
+		tc_remap_processing remap (reloadRules);
+		tpyfile.process_symbols (remap);
+
+		// patch the records and rebuild the request groups
+		std::lock_guard	lockit (sync);
+		guard lock (mux);
+		for (const auto& it : records) {
+			TCatInterface* tcat = dynamic_cast<TCatInterface*>(it.second->get_plcInterface());
+			if (!tcat) continue;
+			const auto sym = remap.get_symbols().find (tcat->get_tCatName());
+			if ((sym == remap.get_symbols().end()) || 
+				(sym->second.first.length != tcat->get_size()) ||
+				(sym->second.second != tcat->get_tCatType())) {
+				if (tcat->is_mapped()) {
+					printf ("Symbol %s not found in updated tpy file\n", tcat->get_tCatName().c_str());
+				}
+				tcat->set_mapped (false);
+				it.second->UserSetValid (false);
+				++nUnmapped;
+				continue;
+			}
+			if ((sym->second.first.indexGroup != tcat->get_indexGroup()) ||
+				(sym->second.first.indexOffset != tcat->get_indexOffset())) {
+				++nMoved;
+			}
+			tcat->set_indexGroup (sym->second.first.indexGroup);
+			tcat->set_indexOffset (sym->second.first.indexOffset);
+			tcat->set_mapped (true);
+			++nMapped;
+		}
+		++reloadCount;
+		remove_data_notifications();
+		if (!optimizeRequests()) {
+			abort_reload();
+			return;
+		}
+		setup_data_notifications();
+		timeTpy = modtime;
+		validTpy = true;
+	}
+	catch (...) {
+		abort_reload();
+		return;
+	}
+	printf ("Reloaded tpy file for PLC %s: %i records mapped (%i moved), %i unmapped\n", 
+		name.c_str(), nMapped, nMoved, nUnmapped);
+	reloadActive = false;
+}
+
+/* TcPLC::get_location
+ ************************************************************************/
+bool TcPLC::get_location (const TCatInterface& tcat, unsigned long& group,
+	unsigned long& offset, unsigned long& size, unsigned long& reloads) const noexcept
+{
+	guard lock (mux);
+	if (!tcat.is_mapped()) {
+		return false;
+	}
+	group = tcat.get_indexGroup();
+	offset = tcat.get_indexOffset();
+	size = tcat.get_size();
+	reloads = reloadCount;
+	return true;
+}
+
 /* Build TCat read request groups: TcPLC::optimizeRequests
  ************************************************************************/
 bool TcPLC::optimizeRequests()
 {
 	// TODO: THIS FUNCTION NEEDS A NEW NAME
 	if (debug) printf("Forming requests...\n");
+	// start from scratch, requests are rebuilt after a tpy reload
+	nRequest = 0;
+	adsGroupReadRequestVector.clear();
+	adsResponseBufferVector.clear();
+	nonTcRecords.clear();
+	notifyRecords.clear();
 	if (records.empty()) {
 		return true;
 	}
@@ -475,10 +965,18 @@ bool TcPLC::optimizeRequests()
 	// Copy records into a list for sorting
 	std::list<BaseRecordPtr> recordList;
 	for (const auto& it : records) {
-		const TCatInterface* const a = dynamic_cast<TCatInterface*>(it.second->get_plcInterface());
-		// add tc records to optimize list
+		TCatInterface* const a = dynamic_cast<TCatInterface*>(it.second->get_plcInterface());
+		// add tc records to optimize list, or to notification list
 		if (a) {
-			recordList.push_back(it.second);
+			a->set_notify (notifyEnabled && 
+				std::regex_match (a->get_tCatName().c_str(), notifyPattern));
+			if (!a->is_mapped()) continue;
+			if (a->is_notify()) {
+				notifyRecords.push_back (a);
+			}
+			else {
+				recordList.push_back(it.second);
+			}
 		}
 		// add all others to non tc list
 		else {
@@ -486,13 +984,18 @@ bool TcPLC::optimizeRequests()
 		}
 	}
 	if (debug) printf("Number of info records %i\n", (int)std::ssize(nonTcRecords));
+	if (debug) printf("Number of notification records %i\n", (int)std::ssize(notifyRecords));
 
 	// Sort record list by group and offset
 	recordList.sort(compByOffset);
 	bool gap = 0;
 	int nextOffs = 0;
 	if (recordList.size() == 0) {
-		return false;
+		// all records are updated by notifications or none is mapped
+		readFaultVector.clear();
+		requestRecords.clear();
+		scatterShards.clear();
+		return true;
 	}
 	TCatInterface* rec = dynamic_cast<TCatInterface*>(
 							recordList.begin()->get()->get_plcInterface());
@@ -518,9 +1021,10 @@ bool TcPLC::optimizeRequests()
 		const long recOffset = rec->get_indexOffset();
 		const long recSize = rec->get_size();
 
-		nextGap = recOffset - nextOffs;
+		// records may overlap (e.g. binary structures and their elements)
+		nextGap = (recOffset > nextOffs) ? recOffset - nextOffs : 0;
 		totalGap += nextGap;
-		nextLength = request.length + recSize + nextGap;
+		nextLength = (int)max((long)request.length, recOffset + recSize - (long)request.indexOffset);
 		relGap = ((double) totalGap) / nextLength;
 
 		// Conditions for making new request
@@ -529,7 +1033,7 @@ bool TcPLC::optimizeRequests()
 			|| recGroup != request.indexGroup;							// different index group
 		
 		// Make new request if gap condition met or if request size too big
-		if (request.length + recSize > MAX_REQ_SIZE || gap)
+		if (nextLength > MAX_REQ_SIZE || gap)
 		{
 			if (debug) printf("Moving to next request... Gap size is %ld\n", recOffset - nextOffs);
 			nRequest++;
@@ -576,6 +1080,45 @@ bool TcPLC::optimizeRequests()
 		if (tcdebug) printf("Record %s linked to ADS response buffer.\n",rec->get_tCatName().c_str());
 	}
 
+	// Collect records and split points for each request group
+	requestRecords.assign(adsGroupReadRequestVector.size(), std::vector<TCatInterface*>());
+	readFaultVector.assign(adsGroupReadRequestVector.size(), ReadFault());
+	// time stamps are never released, since EPICS may read them any time
+	while (requestStamps.size() < readFaultVector.size()) {
+		requestStamps.push_back (std::make_unique<plc::time_stamp>());
+	}
+	for (size_t i = 0; i < readFaultVector.size(); ++i) {
+		requestStamps[i]->set (0);
+		readFaultVector[i].timestamp = requestStamps[i].get();
+	}
+	for (const auto& it : recordList)
+	{
+		rec = dynamic_cast<TCatInterface*>(it.get()->get_plcInterface());
+		if (!rec) continue;
+		rec->set_requestStamp (requestStamps[rec->get_requestNum()].get());
+		requestRecords[rec->get_requestNum()].push_back(rec);
+		readFaultVector[rec->get_requestNum()].splits.push_back(
+			static_cast<unsigned long>(rec->get_requestOffs()));
+	}
+	for (auto& fault : readFaultVector) {
+		std::sort(fault.splits.begin(), fault.splits.end());
+		fault.splits.erase(std::unique(fault.splits.begin(), fault.splits.end()), 
+			fault.splits.end());
+	}
+
+	// Divide records into shards for the read data distribution
+	// A shard never spans more than one request group
+	scatterShards.clear();
+	for (const auto& group : requestRecords)
+	{
+		for (size_t i = 0; i < group.size(); i += scatter_shard_size) {
+			const size_t n = min(group.size() - i, (size_t)scatter_shard_size);
+			scatterShards.push_back(std::vector<TCatInterface*>(
+				group.begin() + i, group.begin() + i + n));
+		}
+	}
+	if (debug) printf("Number of scatter shards %i\n", (int)std::ssize(scatterShards));
+
 	return true;
 }
 
@@ -587,6 +1130,45 @@ TcPLC::buffer_ptr TcPLC::get_responseBuffer(size_t idx) noexcept
 		adsResponseBufferVector[idx] : buffer_ptr();
 }
 
+/* TcPLC::printRequests
+************************************************************************/
+void TcPLC::printRequests (bool all)
+{
+	std::lock_guard	lockit (sync);
+	int nSplit = 0;
+	int nQuarantined = 0;
+	for (const auto& fault : readFaultVector) {
+		if (!fault.sections.empty()) ++nSplit;
+		for (const auto& sec : fault.sections) {
+			if (sec.quarantined) ++nQuarantined;
+		}
+	}
+	fprintf (stdout, "PLC %s: %i read requests, %i split, %i quarantined sections\n",
+		name.c_str(), (int)std::ssize(adsGroupReadRequestVector), nSplit, nQuarantined);
+	for (int request = 0; request < (int)std::ssize(adsGroupReadRequestVector); ++request) {
+		const DataPar& req = adsGroupReadRequestVector[request];
+		const ReadFault& fault = readFaultVector[request];
+		if (!all && fault.sections.empty()) continue;
+		const char* status = "failed";
+		if (fault.status == read_status_enum::success) status = "ok";
+		else if (fault.status == read_status_enum::partial) status = "split";
+		fprintf (stdout, "%6i: %lu/%lu:%lu, %i records, %s, %i errors (last %i)\n",
+			request, req.indexGroup, req.indexOffset, req.length, 
+			(int)std::ssize(requestRecords[request]), status, fault.errors, fault.lastError);
+		for (const auto& sec : fault.sections) {
+			fprintf (stdout, "        %lu/%lu:%lu %s\n", req.indexGroup, 
+				req.indexOffset + sec.offset, sec.length, sec.quarantined ? "quarantined" : "ok");
+			if (!sec.quarantined) continue;
+			for (const TCatInterface* tcat : requestRecords[request]) {
+				if ((tcat->get_requestOffs() < sec.offset + sec.length) &&
+					(tcat->get_requestOffs() + tcat->get_size() > sec.offset)) {
+					fprintf (stdout, "          %s\n", tcat->get_tCatName().c_str());
+				}
+			}
+		}
+	}
+}
+
  /* TcPLC::printAllRecords
  ************************************************************************/
 void TcPLC::printAllRecords()
@@ -704,6 +1286,23 @@ void __stdcall ADScallback (AmsAddr* pAddr, AdsNotificationHeader* pNotification
 	}
 }
 
+/** Callback for ADS data notifications. Takes the time stamp of the 
+	sample from the PLC.
+ ************************************************************************/
+void __stdcall ADSdatacallback (AmsAddr* pAddr, AdsNotificationHeader* pNotification, 
+								unsigned long hUser)
+{
+	std::lock_guard lock(TcPLC::notifyVecMutex);
+	if (hUser >= TcPLC::notifyVec.size()) return;
+	TCatInterface* const tcat = TcPLC::notifyVec[hUser];
+	if (!tcat || !pNotification) return;
+	BaseRecord& rec = tcat->get_record();
+	// time stamp must be set before the value is pushed to the user
+	rec.PlcSetTimestamp ((BaseRecord::time_type)pNotification->nTimeStamp);
+	const unsigned long len = std::min (pNotification->cbSampleSize, tcat->get_size());
+	rec.PlcWriteBinary (pNotification->data, len);
+}
+
 /** TcPLC::set_ads_state
  ************************************************************************/
 void TcPLC::set_ads_state(ADSSTATE state) noexcept
@@ -714,6 +1313,34 @@ void TcPLC::set_ads_state(ADSSTATE state) noexcept
 	} 
 }
 
+/** Callback for ADS symbol version change
+ ************************************************************************/
+void __stdcall ADSsymcallback (AmsAddr* pAddr, AdsNotificationHeader* pNotification, 
+							   unsigned long plcId)
+{
+	TcPLC* tCatPlcUser = nullptr;
+	{
+		std::lock_guard lock(TcPLC::plcVecMutex);
+		if (plcId < TcPLC::plcVec.size()) {
+			tCatPlcUser = TcPLC::plcVec[plcId];
+		}
+	}
+	if (tCatPlcUser && pNotification && pNotification->cbSampleSize) {
+		tCatPlcUser->set_sym_version (*(UCHAR*)pNotification->data);
+	}
+}
+
+/** TcPLC::set_sym_version
+ ************************************************************************/
+void TcPLC::set_sym_version (int version) noexcept
+{
+	const int old = symVersion.exchange (version);
+	if ((old >= 0) && (old != version)) {
+		printf ("Symbols changed on PLC %s\n", name.c_str());
+		checkTpy = true;
+	}
+}
+
 /* TcPLC::setup_ads_notification
  ************************************************************************/
 void TcPLC::setup_ads_notification() noexcept
@@ -727,7 +1354,7 @@ void TcPLC::setup_ads_notification() noexcept
 	adsNotificationAttrib.nCycleTime	 = 0; // in 100ns units
 
 	nNotificationPort = openPort ();
-	const LONG nErr = AdsSyncAddDeviceNotificationReqEx (nNotificationPort, &addr, 
+	const LONG nErr = ads_add_notification (nNotificationPort, &addr, 
 		ADSIGRP_DEVICE_DATA, ADSIOFFS_DEVDATA_ADSSTATE, 
 		&adsNotificationAttrib, ADScallback, plcId, &ads_handle);
 	if (nErr) {
@@ -738,6 +1365,93 @@ void TcPLC::setup_ads_notification() noexcept
 	}
 	else {
 		// set_ads_state (ADSSTATE_RUN);
+		// symbol version changes with every download (optional)
+		adsNotificationAttrib.cbLength = sizeof(UCHAR);
+		if (ads_add_notification (nNotificationPort, &addr, ADSIGRP_SYM_VERSION, 0,
+			&adsNotificationAttrib, ADSsymcallback, plcId, &sym_handle)) {
+			sym_handle = 0;
+		}
+		setup_data_notifications();
+	}
+}
+
+/* TcPLC::set_notify_pattern
+ ************************************************************************/
+void TcPLC::set_notify_pattern (const std::string& pattern)
+{
+	notifyEnabled = !pattern.empty();
+	if (notifyEnabled) {
+		notifyPattern = std::regex (pattern, std::regex_constants::icase);
+	}
+}
+
+/* TcPLC::setup_data_notifications
+ ************************************************************************/
+void TcPLC::setup_data_notifications() noexcept
+{
+	if (!nNotificationPort || notifyRecords.empty()) return;
+	try {
+		AdsNotificationAttrib attrib{};
+		attrib.nTransMode = ADSTRANS_SERVERONCHA;
+		attrib.nMaxDelay = 0; // in 100ns units
+		attrib.nCycleTime = 10000 * get_read_scanner_period(); // in 100ns units
+		int nFailed = 0;
+		for (TCatInterface* tcat : notifyRecords) {
+			if (tcat->notifySlot >= 0) continue;
+			// find a free slot
+			{
+				std::lock_guard lock (notifyVecMutex);
+				const auto free = std::find (notifyVec.begin(), notifyVec.end(), nullptr);
+				tcat->notifySlot = (int)(free - notifyVec.begin());
+				if (free == notifyVec.end()) {
+					notifyVec.push_back (tcat);
+				}
+				else {
+					*free = tcat;
+				}
+			}
+			attrib.cbLength = tcat->get_size();
+			const LONG nErr = ads_add_notification (nNotificationPort, &addr,
+				tcat->get_indexGroup(), tcat->get_indexOffset(), &attrib, 
+				ADSdatacallback, tcat->notifySlot, &tcat->notifyHandle);
+			if (nErr) {
+				if (!nFailed++) errorPrintf (nErr);
+				std::lock_guard lock (notifyVecMutex);
+				notifyVec[tcat->notifySlot] = nullptr;
+				tcat->notifySlot = -1;
+				tcat->notifyHandle = 0;
+				tcat->get_record().PlcClearTimestamp();
+				tcat->get_record().UserSetValid (false);
+			}
+		}
+		if (nFailed) {
+			printf ("Unable to establish %i of %i ADS data notifications for %s\n", 
+				nFailed, (int)std::ssize (notifyRecords), name.c_str());
+		}
+	}
+	catch (...) {}
+}
+
+/* TcPLC::remove_data_notifications
+ ************************************************************************/
+void TcPLC::remove_data_notifications() noexcept
+{
+	for (TCatInterface* tcat : notifyRecords) {
+		if (tcat->notifySlot < 0) continue;
+		try {
+			if (tcat->notifyHandle) {
+				const LONG nErr = ads_del_notification (nNotificationPort, 
+					&addr, tcat->notifyHandle);
+				if (nErr && (nErr != ADSERR_DEVICE_CLIENTUNKNOWN) && 
+					(nErr != ADSERR_DEVICE_NOTIFYHNDINVALID)) errorPrintf(nErr);
+			}
+		}
+		catch (...) {}
+		std::lock_guard lock (notifyVecMutex);
+		notifyVec[tcat->notifySlot] = nullptr;
+		tcat->notifySlot = -1;
+		tcat->notifyHandle = 0;
+		tcat->get_record().PlcClearTimestamp();
 	}
 }
 
@@ -745,9 +1459,14 @@ void TcPLC::setup_ads_notification() noexcept
  ************************************************************************/
 void TcPLC::remove_ads_notification() noexcept
 {
+	remove_data_notifications();
+	if (sym_handle) {
+		ads_del_notification (nNotificationPort, &addr, sym_handle);
+		sym_handle = 0;
+	}
 	if (ads_handle) {
 		try {
-			const LONG nErr = AdsSyncDelDeviceNotificationReqEx(nNotificationPort, &addr, ads_handle);
+			const LONG nErr = ads_del_notification (nNotificationPort, &addr, ads_handle);
 			if (nErr && (nErr != 1813)) errorPrintf(nErr);
 		}
 		catch (...) {}
@@ -755,24 +1474,197 @@ void TcPLC::remove_ads_notification() noexcept
 	if (nNotificationPort) closePort (nNotificationPort);
 }
 
+/* TcPLC::read_request
+ ************************************************************************/
+int TcPLC::read_request (int request) noexcept
+{
+	ReadFault& fault = readFaultVector[request];
+	const DataPar& req = adsGroupReadRequestVector[request];
+	fault.status = read_status_enum::failed;
+	int nErr = 0;
+	int budget = max_bisect_reads;
+	std::vector<ReadSection> sections;
+	try {
+		const time_t t = fault.sections.empty() ? 0 :
+			std::chrono::system_clock::to_time_t (std::chrono::system_clock::now());
+		// read as a whole, or try to re-merge a split request group
+		if (fault.sections.empty() || (t >= fault.retry)) {
+			//The below works if using AdsOpenPortEx()
+			//Note: this no longer includes error flag so +4 may not be necessary
+			unsigned long retsize = 0;
+			nErr = ads_read (nReadPort, &addr,
+				req.indexGroup, req.indexOffset,
+				req.length+4, // we request additional "error"-flag(long) for each ADS-sub commands
+				adsResponseBufferVector[request].get(), 
+				&retsize);
+			if (!nErr) {
+				if (!fault.sections.empty()) {
+					printf ("Read request %i of PLC %s recovered\n", request, name.c_str());
+					fault.sections.clear();
+				}
+				fault.status = read_status_enum::success;
+				if (fault.timestamp) fault.timestamp->update();
+				return 0;
+			}
+			if (is_connection_error (nErr)) {
+				return nErr;
+			}
+			// split the request group to isolate the unreadable sections
+			++fault.errors;
+			fault.lastError = nErr;
+			if (!bisect_request (request, 0, req.length, sections, budget, nErr)) {
+				return nErr;
+			}
+			if (fault.sections.empty()) {
+				printf ("Read request %i of PLC %s failed with error %i, split into %i sections\n",
+					request, name.c_str(), fault.lastError, (int)std::ssize(sections));
+			}
+			fault.retry = (t ? t : std::chrono::system_clock::to_time_t (
+				std::chrono::system_clock::now())) + fault_retry_period;
+		}
+		// read the sections of a split request group
+		else {
+			for (const auto& sec : fault.sections) {
+				if (sec.quarantined) {
+					sections.push_back (sec);
+				}
+				else if (!bisect_request (request, sec.offset, sec.length, sections, budget, nErr)) {
+					return nErr;
+				}
+			}
+		}
+		fault.sections = std::move (sections);
+	}
+	catch (...) {
+		return nErr ? nErr : -1;
+	}
+	// success if at least one section was read
+	for (const auto& sec : fault.sections) {
+		if (!sec.quarantined) {
+			fault.status = read_status_enum::partial;
+			if (fault.timestamp) fault.timestamp->update();
+			return 0;
+		}
+	}
+	return nErr ? nErr : -1;
+}
+
+/* TcPLC::bisect_request
+ ************************************************************************/
+bool TcPLC::bisect_request (int request, unsigned long offs, unsigned long len,
+	std::vector<ReadSection>& sections, int& budget, int& nErr) noexcept
+{
+	const ReadFault& fault = readFaultVector[request];
+	const DataPar& req = adsGroupReadRequestVector[request];
+	try {
+		// read section, quarantine without reading when out of budget
+		if (budget > 0) {
+			--budget;
+			unsigned long retsize = 0;
+			const int err = ads_read (nReadPort, &addr,
+				req.indexGroup, req.indexOffset + offs, len,
+				adsResponseBufferVector[request].get() + offs, &retsize);
+			if (!err) {
+				sections.push_back (ReadSection{offs, len, false});
+				return true;
+			}
+			nErr = err;
+			if (is_connection_error (err)) {
+				return false;
+			}
+		}
+		else {
+			sections.push_back (ReadSection{offs, len, true});
+			return true;
+		}
+		// find the record boundary closest to the middle of the section
+		const auto lo = std::upper_bound (fault.splits.begin(), fault.splits.end(), offs);
+		const auto hi = std::lower_bound (lo, fault.splits.end(), offs + len);
+		if (lo == hi) {
+			// cannot be split any further
+			sections.push_back (ReadSection{offs, len, true});
+			return true;
+		}
+		auto mid = std::lower_bound (lo, hi, offs + len / 2);
+		if ((mid == hi) || ((mid != lo) && (*mid - (offs + len / 2) > (offs + len / 2) - *(mid - 1)))) {
+			--mid;
+		}
+		const unsigned long split = *mid;
+		return bisect_request (request, offs, split - offs, sections, budget, nErr) &&
+			bisect_request (request, split, offs + len - split, sections, budget, nErr);
+	}
+	catch (...) {
+		return false;
+	}
+}
+
+/* TcPLC::is_readable
+ ************************************************************************/
+bool TcPLC::is_readable (const TCatInterface& tcat) const noexcept
+{
+	const ReadFault& fault = readFaultVector[tcat.get_requestNum()];
+	switch (fault.status) {
+	case read_status_enum::success:
+		return true;
+	case read_status_enum::partial:
+		{
+			const size_t beg = tcat.get_requestOffs();
+			const size_t end = beg + tcat.get_size();
+			for (const auto& sec : fault.sections) {
+				if (sec.offset >= end) break;
+				if (sec.offset + sec.length <= beg) continue;
+				if (sec.quarantined) return false;
+			}
+			return true;
+		}
+	case read_status_enum::failed:
+	default:
+		return false;
+	}
+}
+
+/* TcPLC::update_record
+ ************************************************************************/
+void TcPLC::update_record (TCatInterface& tcat, bool readAll) noexcept
+{
+	BaseRecord& rec = tcat.get_record();
+	if (!tcat.is_mapped()) {
+		rec.UserSetValid (false);
+		return;
+	}
+	// notify records are updated by the ADS notifications, but become
+	// invalid when the PLC is lost or leaves RUN
+	if (tcat.is_notify()) {
+		if ((get_ads_state() != ADSSTATE_RUN) || ads_restart.load()) {
+			rec.PlcClearTimestamp();
+			rec.UserSetValid (false);
+		}
+		return;
+	}
+	const bool isReadOnly = (rec.get_access_rights() == access_rights_enum::read_only);
+	if (readAll || !isReadOnly) {
+		if (is_readable (tcat)) {
+			buffer_type* buffer = adsResponseBufferVector[tcat.get_requestNum()].get();
+			rec.PlcWriteBinary(buffer + tcat.get_requestOffs(), tcat.get_size());
+		}
+		else {
+			rec.UserSetValid (false);
+		}
+	}
+}
+
 /* TcPLC::read_scanner
  ************************************************************************/
 void TcPLC::read_scanner()
 {	
 	std::lock_guard	lockit (sync);
 	bool read_success = false;
+	for (auto& fault : readFaultVector) {
+		fault.status = read_status_enum::failed;
+	}
 	if ((get_ads_state() == ADSSTATE_RUN) && is_valid_tpy()) {
-		for (int request = 0; request <= nRequest; ++request) {
-			 //The below works if using AdsOpenPortEx()
-			 //Note: this no longer includes error flag so +4 may not be necessary
-			unsigned long retsize = 0;
-			int nErr = 0;
-			nErr = AdsSyncReadReqEx2 (nReadPort, &addr,
-				adsGroupReadRequestVector[request].indexGroup,
-				adsGroupReadRequestVector[request].indexOffset,
-				adsGroupReadRequestVector[request].length+4, // we request additional "error"-flag(long) for each ADS-sub commands
-				adsResponseBufferVector[request].get(), 
-				&retsize);
+		for (int request = 0; request < (int)std::ssize(readFaultVector); ++request) {
+			const int nErr = read_request (request);
 			if (!nErr) {
 				read_success = true;
 			}
@@ -783,7 +1675,7 @@ void TcPLC::read_scanner()
 					}
 					ads_restart = true;
 				}
-				else if (nErr != 6) {
+				else if ((nErr != 6) && (nErr > 0)) {
 					errorPrintf(nErr);
 				}
 			}
@@ -803,26 +1695,30 @@ void TcPLC::read_scanner()
 	// Reset countdown until EPICS read
 	if (readAll) cyclesLeft = scanRateMultiple;
 
-	// Update all tc records
-	for (const auto& recordsEntry : records) {
-		BaseRecord* pRecord = recordsEntry.second.get();
-		if (!pRecord) continue;
-		TCatInterface* tcat = dynamic_cast<TCatInterface*>(pRecord->get_plcInterface());
-		if (!tcat) continue;
-		const bool isReadOnly = (pRecord->get_access_rights() == access_rights_enum::read_only);
-		buffer_type* buffer = adsResponseBufferVector[tcat->get_requestNum()].get();
-		if (readAll || !isReadOnly) {
-			if (read_success) {
-				pRecord->PlcWriteBinary(buffer + tcat->get_requestOffs(), tcat->get_size());
-			}
-			else {
-				pRecord->UserSetValid (false);
+	// Update all tc records using the worker pool
+	if (scatterPool.size() > 0) {
+		const tcScatterPool::shard_func scatter = 
+			[this, readAll] (size_t shard) noexcept {
+			for (TCatInterface* tcat : scatterShards[shard]) {
+				update_record (*tcat, readAll);
 			}
+		};
+		scatterPool.run (scatterShards.size(), scatter);
+	}
+	// Update all tc records
+	else {
+		for (const auto& recordsEntry : records) {
+			BaseRecord* pRecord = recordsEntry.second.get();
+			if (!pRecord) continue;
+			TCatInterface* tcat = dynamic_cast<TCatInterface*>(pRecord->get_plcInterface());
+			if (!tcat) continue;
+			update_record (*tcat, readAll);
 		}
 	}
 
 	// update non tc records (try using a different cycle to distribute load)
 	if (cyclesLeft == 1) {
+		if (!nonTcRecords.empty()) infoSnapshot.update (*this);
 		for (const auto& it : nonTcRecords) {
 			InfoPlc::InfoInterface* iface = dynamic_cast<InfoPlc::InfoInterface*> (it.second->get_plcInterface());
 			if (iface) {
@@ -891,14 +1787,14 @@ void TcPLC::update_scanner()
  ************************************************************************/
 long TcPLC::openPort() noexcept
 {
-	return AdsPortOpenEx();
+	return ads_open_port (&addr);
 }
 
 /* TcPLC::closePort
  ************************************************************************/
 void TcPLC::closePort(long nPort) noexcept
 {
-	AdsPortCloseEx(nPort);
+	ads_close_port (nPort);
 }
 
 /* TcPLC::plcVec
@@ -909,6 +1805,14 @@ std::vector<TcPLC*> TcPLC::plcVec;
  ************************************************************************/
 std::mutex TcPLC::plcVecMutex;
 
+/* TcPLC::notifyVec
+ ************************************************************************/
+std::vector<TCatInterface*> TcPLC::notifyVec;
+
+/* TcPLC::notifyVecMutex
+ ************************************************************************/
+std::mutex TcPLC::notifyVecMutex;
+
 /************************************************************************ 
   AmsRouterNotification
  ************************************************************************/
@@ -1,7 +1,12 @@
 #pragma once
 #include "stdafx.h"
 #include <TcAdsDef.h>
+#include <thread>
+#include <condition_variable>
+#include <functional>
 #include "plcBase.h"
+#include "ParseUtil.h"
+#include "infoPlc.h"
 
 /** @file tcComms.h
 	Header which includes classes to interface with the TCat system and 
@@ -11,6 +16,9 @@
 /** Forward declaration
  ************************************************************************/
 struct dbCommon;
+namespace ParseTpy {
+	class symbol_upload;
+}
 
 /** @namespace TcComms
 	TcComms name space, which has all the classes and functions used for 
@@ -44,6 +52,16 @@ constexpr int default_multiple = 10;
 constexpr int minimum_multiple = 1;	
 /// maximum multiple for PLC EPICS scan rate (200) 
 constexpr int maximum_multiple = 200;
+/// default number of threads distributing read data to records (0 = off)
+constexpr int default_scatter_threads = 0;
+/// maximum number of threads distributing read data to records (64)
+constexpr int maximum_scatter_threads = 64;
+/// maximum number of records in a single scatter shard
+constexpr int scatter_shard_size = 2048;
+/// period in seconds after which a split request group is read as a whole again
+constexpr int fault_retry_period = 30;
+/// maximum number of ADS reads used to bisect a failing request group
+constexpr int max_bisect_reads = 64;
 
 
 /** Forward declaration
@@ -64,11 +82,65 @@ struct DataPar
 	unsigned long		length;
 };
 
+/** Enumerated type describing the outcome of a request group read
+	@brief Read status enum
+ ************************************************************************/
+enum class read_status_enum 
+{
+	/// Read failed
+	failed,
+	/// Read of the entire request group succeeded
+	success,
+	/// Request group was read in sections, some may be quarantined
+	partial
+};
+
+/** Struct for a section of a request group which is read separately 
+	after the request group failed to be read as a whole
+	@brief Read section struct
+ ************************************************************************/
+struct ReadSection
+{
+	/// offset relative to the beginning of the request group
+	unsigned long		offset;
+	/// count of bytes to read
+	unsigned long		length;
+	/// section failed to read and is excluded until the next re-merge
+	bool				quarantined;
+};
+
+/** Struct keeping track of read failures of a request group. A failing
+	request group is bisected into sections at record boundaries, until 
+	the unreadable sections are isolated. The remaining sections are read
+	separately, whereas the unreadable ones are quarantined. Periodically,
+	the request group is read as a whole again.
+	@brief Read fault struct
+ ************************************************************************/
+struct ReadFault
+{
+	/// Outcome of the last read
+	read_status_enum	status = read_status_enum::failed;
+	/// Sections of a split request group (empty if read as a whole)
+	std::vector<ReadSection> sections;
+	/// Record offsets within the request group, used as split points
+	std::vector<unsigned long> splits;
+	/// Time of the next attempt to read the request group as a whole
+	time_t				retry = 0;
+	/// Number of failed reads of the request group as a whole
+	int					errors = 0;
+	/// Last ADS error code
+	int					lastError = 0;
+	/// Completion time of the last successful read (owned by the PLC)
+	plc::time_stamp*	timestamp = nullptr;
+};
+
 /** This is a class for a TCat interface
 	@brief TCat interface class
  ************************************************************************/
 class TCatInterface	: public plc::Interface
 {
+	/// PLC manages the ADS notifications
+	friend class TcPLC;
 public:
 	/// Constructor
 	explicit TCatInterface (plc::BaseRecord& dval) noexcept
@@ -133,12 +205,35 @@ public:
 	virtual TcPLC* get_parent() noexcept;
 	/// Get parent PLC that owns this record
 	virtual const TcPLC* get_parent() const noexcept;
+	/// Get time stamp of the last read of the request group
+	const plc::time_stamp* get_time_stamp() const noexcept override;
 	/// Get the request group number this record is in
 	int	get_requestNum() noexcept {
 		return requestNum; };
 	/// Set the request group number this record is in
 	void set_requestNum(int rNum) noexcept {
 		requestNum = rNum; };
+	/// Set the completion time stamp of the request group
+	void set_requestStamp(const plc::time_stamp* ts) noexcept {
+		requestStamp = ts; };
+	/// Is the symbol mapped to a memory location in TCat?
+	bool is_mapped() const noexcept {
+		return mapped; };
+	/// Set the mapped state of the symbol
+	void set_mapped(bool map) noexcept {
+		mapped = map; };
+	/// Is the symbol updated by ADS notifications instead of polling?
+	bool is_notify() const noexcept {
+		return notify; };
+	/// Set the notification mode of the symbol
+	void set_notify(bool notif) noexcept {
+		notify = notif; };
+	/// Get element type of an array symbol
+	plc::data_type_enum get_element_type() const noexcept override {
+		return elementType; };
+	/// Set element type of an array symbol
+	void set_element_type(plc::data_type_enum etype) noexcept {
+		elementType = etype; };
 
 	/// Prints TCat symbol value and information
 	/// @param fp File to print symbol to
@@ -159,6 +254,18 @@ protected:
 	int					requestNum;
 	/// Offset into response buffer
 	size_t				requestOffs;
+	/// Completion time stamp of the request group (owned by the PLC)
+	std::atomic<const plc::time_stamp*> requestStamp = nullptr;
+	/// Symbol was found in the current tpy file
+	bool				mapped = true;
+	/// Symbol is updated by ADS notifications
+	bool				notify = false;
+	/// Handle of the ADS notification
+	unsigned long		notifyHandle = 0;
+	/// Slot in the notification list of all PLCs
+	int					notifySlot = -1;
+	/// Element type for array symbols
+	plc::data_type_enum	elementType = plc::data_type_enum::dtInvalid;
 };
 
 
@@ -236,6 +343,74 @@ private:
 };
 
 
+/** Class for a pool of worker threads which distribute the read
+	response buffers into the records. The work is divided into shards
+	which are handed out to the workers and the calling thread. The run 
+	method will only return after all shards have been processed, so the
+	distribution is complete before the read cycle ends.
+
+	@brief TwinCAT scatter pool
+ ************************************************************************/
+class tcScatterPool
+{
+public:
+	/// Function processing a shard by index
+	using shard_func = std::function<void (size_t)>;
+
+	/// Default constructor
+	tcScatterPool() noexcept = default;
+	/// Destructor: will stop the worker threads
+	~tcScatterPool() { stop(); }
+
+	/// Start the worker threads
+	/// @param nthreads Number of worker threads
+	/// @return true if successful
+	bool start (int nthreads) noexcept;
+	/// Stop the worker threads
+	void stop() noexcept;
+	/// Number of worker threads
+	int size() const noexcept { return (int)workers.size(); }
+
+	/// Process shards 0 to num-1, returns when all are done
+	/// @param num Number of shards
+	/// @param func Function processing a shard
+	void run (size_t num, const shard_func& func) noexcept;
+
+protected:
+	/// Worker thread main loop
+	void worker() noexcept;
+	/// Process shards until none are left
+	void work (size_t num, const shard_func& func) noexcept;
+
+	/// Mutex
+	std::mutex					mux;
+	/// Wakes up the workers
+	std::condition_variable		wakeup;
+	/// Signals that all workers are done
+	std::condition_variable		finished;
+	/// Worker threads
+	std::vector<std::thread>	workers;
+	/// Current shard function
+	const shard_func*			job = nullptr;
+	/// Current number of shards
+	size_t						jobsize = 0;
+	/// Next shard to be processed
+	std::atomic<size_t>			next = 0;
+	/// Number of workers still busy with the current job
+	size_t						busy = 0;
+	/// Job generation
+	unsigned long long			generation = 0;
+	/// Terminate workers
+	bool						quit = false;
+
+private:
+	/// Copy constructor (disabled)
+	tcScatterPool (const tcScatterPool&) = delete;
+	/// Assignment operator (disabled)
+	tcScatterPool& operator= (const tcScatterPool&) = delete;
+};
+
+
 /** Class for a connection to a TwinCAT PLC
 	This class is derived from a BasePLC object, and specializes in 
 	managing records that contain a plc interface for TCat. This class 
@@ -256,6 +431,10 @@ class TcPLC	: public plc::BasePLC
 {
 	/// Notification callback is a friend
 	friend void __stdcall ADScallback (AmsAddr*, AdsNotificationHeader*, unsigned long);
+	/// Data notification callback is a friend
+	friend void __stdcall ADSdatacallback (AmsAddr*, AdsNotificationHeader*, unsigned long);
+	/// Symbol version notification callback is a friend
+	friend void __stdcall ADSsymcallback (AmsAddr*, AdsNotificationHeader*, unsigned long);
 public:
 	/// Buffer type
 	using buffer_type = char;
@@ -265,16 +444,33 @@ public:
 	/// Constructor
 	TcPLC(std::string tpyPath);
 	/// Destructor
-	~TcPLC() override { remove_ads_notification(); };
+	~TcPLC() override;
 
 	/// Is typ still valid? Meaning, it hasn't changed
+	/// Starts a reload in the background, if the tpy file was updated
 	bool is_valid_tpy() noexcept;
+	/// Set the parameters needed to reload the tpy file
+	/// @param options Option string passed to tcLoadRecords
+	/// @param rules Replacement rules used to generate the TCat names
+	void set_reload_info (const std::stringcase& options, 
+		const ParseUtil::replacement_rules& rules);
 
 	/// Get AMS netID of TwinCAT system and port number for this PLC
 	AmsAddr	get_addr() const noexcept { return addr; };
 	/// Set AMS address
 	/// @return true if successful
 	bool set_addr(std::stringcase netid, int port);
+	/// Get the location of a TCat record, taken under the PLC lock
+	/// so that it is consistent with a concurrent tpy reload
+	/// @param tcat TCat interface of a record of this PLC
+	/// @param group Index group (return)
+	/// @param offset Index offset (return)
+	/// @param size Size in bytes (return)
+	/// @param reloads Number of tpy reloads (return)
+	/// @return true if the record is mapped
+	bool get_location (const TCatInterface& tcat, unsigned long& group,
+		unsigned long& offset, unsigned long& size, 
+		unsigned long& reloads) const noexcept;
 	/// Get read port number
 	long get_nReadPort() const noexcept { return nReadPort; };
 	/// Get write port number
@@ -285,6 +481,17 @@ public:
 	/// Set slowdown multiple for EPICS read
 	void set_read_scanner_multiple (int mult) noexcept {
 		scanRateMultiple = mult; };
+	/// Set the pattern of symbols updated by ADS notifications
+	/// Must be called before the requests are optimized
+	/// @param pattern Regular expression matching TCat names (empty for none)
+	void set_notify_pattern (const std::string& pattern);
+	/// Get number of threads distributing read data to records
+	int get_scatter_threads() const noexcept {
+		return scatterThreads; };
+	/// Set number of threads distributing read data to records
+	/// Must be called before start, 0 disables the worker pool
+	void set_scatter_threads (int num) noexcept {
+		scatterThreads = num; };
 	/// Get ADS state
 #pragma warning(disable :26812)
 	ADSSTATE get_ads_state() const noexcept { return ads_state.load(); }
@@ -303,6 +510,10 @@ public:
 		return timeTpy;
 	}
 
+	/// Get the info snapshot of the last info cycle
+	const InfoPlc::info_snapshot& get_info_snapshot() const noexcept {
+		return infoSnapshot; }
+
 	/// Starts the appropriate scanners
 	bool start() override;
 
@@ -320,6 +531,10 @@ public:
 	/// @return pointer to buffer
 	buffer_ptr get_responseBuffer(size_t idx) noexcept;
 
+	/// Prints the read request groups and their fault state to console
+	/// @param all Print all request groups, otherwise only split ones
+	void printRequests (bool all);
+
 	/// Prints symbol information for entire list of symbols to console
 	void printAllRecords() override;
 	/// Print a record values to stdout. (override for action)
@@ -334,12 +549,40 @@ protected:
 	/// Makes sure we don't have stale values.
 	void update_scanner() override;
 	
+	/// Reloads the tpy file and remaps the records (runs in background)
+	void reload_tpy() noexcept;
+
+	/// Reads a request group, splits it on failure
+	/// @param request Index of request group
+	/// @return ADS error code if the request group failed, 0 otherwise
+	int read_request (int request) noexcept;
+	/// Reads a section of a request group, bisects it on failure
+	/// @param request Index of request group
+	/// @param offs Offset of section within request group
+	/// @param len Length of section
+	/// @param sections Resulting list of sections (appended)
+	/// @param budget Remaining number of ADS reads for bisecting
+	/// @param nErr ADS error code of the last failed read
+	/// @return false if the connection failed, true otherwise
+	bool bisect_request (int request, unsigned long offs, unsigned long len,
+		std::vector<ReadSection>& sections, int& budget, int& nErr) noexcept;
+	/// Checks if a record was read successfully in the last cycle
+	bool is_readable (const TCatInterface& tcat) const noexcept;
+	/// Updates a record from the read response buffer
+	void update_record (TCatInterface& tcat, bool readAll) noexcept;
+
 	/// Set ADS state
 	void set_ads_state(ADSSTATE state) noexcept;
+	/// Set symbol version, checks the tpy file when it changes
+	void set_sym_version (int version) noexcept;
 	/// Set up ADS status change notification
 	void setup_ads_notification() noexcept;
 	/// Remove ADS status change notification
 	void remove_ads_notification() noexcept;
+	/// Set up ADS data notifications for the notification mode symbols
+	void setup_data_notifications() noexcept;
+	/// Remove ADS data notifications
+	void remove_data_notifications() noexcept;
 
 	/// Opens a new ADS communication port
 	long openPort() noexcept;
@@ -356,9 +599,20 @@ protected:
 	/// Modification time of file
 	time_t timeTpy;
 	/// need to check modifcation time to make sure tpy file hasn't changed
+	/// (set when the PLC goes online or its symbols change)
 	std::atomic<bool> checkTpy;
 	/// tpy file is valid and hasn't changed
 	bool validTpy;
+	/// Option string used to parse the tpy file
+	std::stringcase reloadOptions;
+	/// Replacement rules used to generate the TCat names
+	ParseUtil::replacement_rules reloadRules;
+	/// Thread reloading an updated tpy file
+	std::thread reloadThread;
+	/// Reload of the tpy file in progress
+	std::atomic<bool> reloadActive;
+	/// Number of tpy reloads which remapped the records (protected by mux)
+	unsigned long reloadCount = 0;
 
 	/// Number of read request groups
 	int	nRequest;
@@ -366,8 +620,30 @@ protected:
 	std::vector<DataPar> adsGroupReadRequestVector;
 	/// Vector of buffers for each read request group
 	std::vector<buffer_ptr>	adsResponseBufferVector;
+	/// Vector of read fault states for each read request group
+	std::vector<ReadFault> readFaultVector;
+	/// Completion time stamps of the read request groups. Only grows, so 
+	/// that records read by EPICS keep valid pointers when the request 
+	/// groups are rebuilt by a reload
+	std::vector<std::unique_ptr<plc::time_stamp>> requestStamps;
+	/// Vector of TCat records for each read request group
+	std::vector<std::vector<TCatInterface*>> requestRecords;
 	/// List of all records that don't interface directly with a PLC (info)
 	plc::BaseRecordList	nonTcRecords;
+	/// Info values shared by all info records, updated once per info cycle
+	InfoPlc::info_snapshot infoSnapshot;
+	/// Pattern of symbols updated by ADS notifications
+	std::regex	notifyPattern;
+	/// Notifications are used
+	bool		notifyEnabled = false;
+	/// TCat records updated by ADS notifications instead of polling
+	std::vector<TCatInterface*> notifyRecords;
+	/// TCat records grouped into shards, each within one request group
+	std::vector<std::vector<TCatInterface*>> scatterShards;
+	/// Number of threads distributing read data to records
+	int scatterThreads;
+	/// Worker pool for distributing read data to records
+	tcScatterPool scatterPool;
 
 	/// Slowdown multiple for EPICS read
 	int	scanRateMultiple;
@@ -382,6 +658,10 @@ protected:
 	std::atomic<ADSSTATE> ads_state;
 	/// ADS handle
 	unsigned long ads_handle;
+	/// ADS handle of the symbol version notification
+	unsigned long sym_handle;
+	/// Symbol version of the PLC, -1 if unknown
+	std::atomic<int> symVersion;
 	/// ADS restart
 	std::atomic<bool> ads_restart;
 
@@ -398,6 +678,10 @@ private:
 	static std::vector<TcPLC*> plcVec;
 	/// Mutex for PLC instance vector
 	static std::mutex plcVecMutex;
+	/// Records with ADS data notifications, indexed by notification slot
+	static std::vector<TCatInterface*> notifyVec;
+	/// Mutex for notification record vector
+	static std::mutex notifyVecMutex;
 	/// PLC ID
 	unsigned plcId;
 };
@@ -457,6 +741,14 @@ private:
 	static AmsRouterNotification gAmsRouterNotification;
 };
 
+/** Uploads the symbol and data type tables from a TwinCAT PLC using
+	ADSIGRP_SYM_UPLOADINFO2, ADSIGRP_SYM_UPLOAD and ADSIGRP_SYM_DT_UPLOAD.
+	@param upload Symbol upload with ADS target set (return)
+	@return True if successful
+	@brief Upload the symbol table
+ ************************************************************************/
+bool upload_symbols (ParseTpy::symbol_upload& upload) noexcept;
+
 /** @} */
 
 
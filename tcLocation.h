@@ -0,0 +1,33 @@
+#pragma once
+#include "shareLib.h"
+
+/** @file tcLocation.h
+	Header which declares the lookup of the TwinCAT location of a record
+	for other support modules, such as the motor support. It does not
+	depend on the ADS library or on the internal classes of the IOC.
+ ************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Gets the current location of a record, which is linked to a TwinCAT
+	symbol through the tcat device support. The location is taken from
+	the record itself, so that it follows a reload of the tpy file. It
+	only changes, when the returned number of reloads changes.
+	Can only be called after the records are initialized by iocInit.
+	@param recname Name of the EPICS record
+	@param group Index group (return)
+	@param offset Index offset (return)
+	@param size Size in bytes (return)
+	@param reloads Number of tpy reloads of the PLC (return)
+	@return 0 if successful, -1 if the record is not a mapped TwinCAT record
+	@brief Get TwinCAT location of a record
+ ************************************************************************/
+epicsShareFunc int tcGetRecordLocation (const char* recname,
+	unsigned long* group, unsigned long* offset, unsigned long* size,
+	unsigned long* reloads);
+
+#ifdef __cplusplus
+}
+#endif
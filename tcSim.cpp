@@ -0,0 +1,600 @@
+#include "tcSim.h"
+#include "tcComms.h"
+#include "windows.h"
+#include "TcAdsDef.h"
+#include <fstream>
+#include <cmath>
+
+/** @file tcSim.cpp
+	Defines methods for the simulated ADS target.
+ ************************************************************************/
+
+using namespace std;
+using namespace plc;
+
+namespace TcComms {
+
+/// ADS error: service not supported by server
+constexpr long sim_err_not_supported = 1793;
+/// ADS error: invalid parameter size
+constexpr long sim_err_invalid_size = 1797;
+/// ADS error: invalid notification handle
+constexpr long sim_err_invalid_handle = 1812;
+/// Maximum number of value changes per tick and target
+constexpr long long sim_max_changes_per_tick = 1000000;
+
+/** Get the current time as a FILETIME (100ns since 1601)
+	@brief Current time as FILETIME
+ ************************************************************************/
+static long long filetime_now() noexcept
+{
+	return chrono::duration_cast<chrono::duration<long long, ratio<1, 10000000>>>(
+		chrono::system_clock::now().time_since_epoch()).count() + 116444736000000000LL;
+}
+
+/** Get the size in bytes of a data type changed by the simulation
+	@brief Size of a simulated data type
+ ************************************************************************/
+static unsigned long sim_type_size (data_type_enum type) noexcept
+{
+	switch (type) {
+	case data_type_enum::dtBool:
+	case data_type_enum::dtInt8:
+	case data_type_enum::dtUInt8:
+		return 1;
+	case data_type_enum::dtInt16:
+	case data_type_enum::dtUInt16:
+		return 2;
+	case data_type_enum::dtInt32:
+	case data_type_enum::dtUInt32:
+	case data_type_enum::dtFloat:
+		return 4;
+	case data_type_enum::dtInt64:
+	case data_type_enum::dtUInt64:
+	case data_type_enum::dtDouble:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+
+/************************************************************************
+  tcSimTarget
+ ************************************************************************/
+
+/* tcSimTarget::load_image
+ ************************************************************************/
+bool tcSimTarget::load_image (const std::stringcase& fname, unsigned long group)
+{
+	ifstream inp (fname.c_str(), ios::in | ios::binary);
+	if (!inp) {
+		return false;
+	}
+	vector<char> image ((istreambuf_iterator<char>(inp)), istreambuf_iterator<char>());
+	if (image.size() > sim_max_group_size) {
+		return false;
+	}
+	std::lock_guard lock (memMutex);
+	groups[group] = std::move (image);
+	return true;
+}
+
+/* tcSimTarget::load_symbols
+ ************************************************************************/
+bool tcSimTarget::load_symbols (const std::stringcase& fname)
+{
+	FILE* inp = nullptr;
+	if (fopen_s (&inp, fname.c_str(), "r") || !inp) {
+		return false;
+	}
+	ParseTpy::tpy_file tpy;
+	const bool succ = tpy.parse (inp);
+	fclose (inp);
+	ParseTpy::symbol_upload tables;
+	if (!succ || !tables.encode (tpy)) {
+		return false;
+	}
+	std::lock_guard lock (memMutex);
+	upload = std::move (tables);
+	numSymbols = (unsigned long)tpy.get_symbols().size();
+	numDatatypes = (unsigned long)tpy.get_types().size();
+	return true;
+}
+
+/* tcSimTarget::attach
+ ************************************************************************/
+void tcSimTarget::attach (plc::BasePLC& plc)
+{
+	vector<slot> s;
+	plc.for_each ([&s](BaseRecord* rec) {
+		const TCatInterface* const tcat =
+			dynamic_cast<const TCatInterface*>(rec->get_plcInterface());
+		const data_type_enum type = rec->get_data().get_data_type();
+		if (tcat && (sim_type_size (type) > 0) && (tcat->get_size() >= sim_type_size (type))) {
+			s.push_back (slot{tcat->get_indexGroup(), tcat->get_indexOffset(), type});
+		}
+	});
+	std::lock_guard lock (memMutex);
+	slots.insert (slots.end(), s.begin(), s.end());
+	stats.slots = slots.size();
+}
+
+/* tcSimTarget::get_statistics
+ ************************************************************************/
+tcSimTarget::statistics tcSimTarget::get_statistics() const noexcept
+{
+	std::lock_guard lock (memMutex);
+	return stats;
+}
+
+/* tcSimTarget::open_port
+ ************************************************************************/
+long tcSimTarget::open_port() noexcept
+{
+	return tcSimulation::get().next_port();
+}
+
+/* tcSimTarget::memory
+ ************************************************************************/
+char* tcSimTarget::memory (unsigned long group, unsigned long offset,
+	unsigned long length)
+{
+	// index groups above 0xF000 are services, not memory
+	if (group >= 0xF000) {
+		return nullptr;
+	}
+	const unsigned long long end = (unsigned long long)offset + length;
+	if (end > sim_max_group_size) {
+		return nullptr;
+	}
+	vector<char>& mem = groups[group];
+	if (mem.size() < end) {
+		mem.resize (end, 0);
+	}
+	return mem.data() + offset;
+}
+
+/* tcSimTarget::read
+ ************************************************************************/
+long tcSimTarget::read (unsigned long group, unsigned long offset,
+	unsigned long length, void* data, unsigned long* ret) noexcept
+{
+	if (ret) *ret = 0;
+	if (!data && length) {
+		return sim_err_invalid_size;
+	}
+	// ADS state and device state
+	if ((group == ADSIGRP_DEVICE_DATA) && (offset == ADSIOFFS_DEVDATA_ADSSTATE)) {
+		const USHORT state[2] = {ADSSTATE_RUN, 0};
+		if (length > sizeof (state)) {
+			return sim_err_invalid_size;
+		}
+		memcpy (data, state, length);
+		if (ret) *ret = length;
+		return 0;
+	}
+	// symbol and data type upload
+	if ((group == ADSIGRP_SYM_UPLOADINFO2) || (group == ADSIGRP_SYM_UPLOAD) ||
+		(group == ADSIGRP_SYM_DT_UPLOAD)) {
+		return read_symbols (group, length, data, ret);
+	}
+	try {
+		std::lock_guard lock (memMutex);
+		const char* const p = memory (group, offset, length);
+		if (!p) {
+			return (group >= 0xF000) ? sim_err_not_supported : sim_err_invalid_size;
+		}
+		memcpy (data, p, length);
+		++stats.reads;
+		stats.readBytes += length;
+	}
+	catch (...) {
+		return sim_err_invalid_size;
+	}
+	if (ret) *ret = length;
+	return 0;
+}
+
+/* tcSimTarget::read_symbols
+ ************************************************************************/
+long tcSimTarget::read_symbols (unsigned long group, unsigned long length,
+	void* data, unsigned long* ret) noexcept
+{
+	std::lock_guard lock (memMutex);
+	if (upload.empty()) {
+		return sim_err_not_supported;
+	}
+	if (group == ADSIGRP_SYM_UPLOADINFO2) {
+		AdsSymbolUploadInfo2 info = {};
+		info.nSymbols = numSymbols;
+		info.nSymSize = (unsigned long)upload.get_symbols().size();
+		info.nDatatypes = numDatatypes;
+		info.nDatatypeSize = (unsigned long)upload.get_datatypes().size();
+		length = std::min<unsigned long> (length, sizeof (info));
+		memcpy (data, &info, length);
+		if (ret) *ret = length;
+		return 0;
+	}
+	const ParseTpy::symbol_upload::buffer_type& buf = (group == ADSIGRP_SYM_UPLOAD) ?
+		upload.get_symbols() : upload.get_datatypes();
+	if (length < buf.size()) {
+		return sim_err_invalid_size;
+	}
+	memcpy (data, buf.data(), buf.size());
+	if (ret) *ret = (unsigned long)buf.size();
+	return 0;
+}
+
+/* tcSimTarget::read_write
+ ************************************************************************/
+long tcSimTarget::read_write (unsigned long group, unsigned long offset,
+	unsigned long rlength, void* rdata, unsigned long wlength,
+	void* wdata, unsigned long* ret) noexcept
+{
+	if (ret) *ret = 0;
+	if (group != 0xF081) {
+		return sim_err_not_supported;
+	}
+	// sum write: offset is the number of sub commands, the write data
+	// holds the (group, offset, size) triples followed by the data
+	const unsigned long count = offset;
+	const size_t header = 3 * sizeof (long) * count;
+	if (!wdata || (wlength < header)) {
+		return sim_err_invalid_size;
+	}
+	const long* const sub = static_cast<const long*>(wdata);
+	const char* data = static_cast<const char*>(wdata) + header;
+	const char* const end = static_cast<const char*>(wdata) + wlength;
+	unsigned long err = 0;
+	try {
+		std::lock_guard lock (memMutex);
+		for (unsigned long i = 0; i < count; ++i) {
+			const unsigned long size = static_cast<unsigned long>(sub[3*i + 2]);
+			if (size > (unsigned long)(end - data)) {
+				err = sim_err_invalid_size;
+				break;
+			}
+			char* const p = memory (static_cast<unsigned long>(sub[3*i]),
+				static_cast<unsigned long>(sub[3*i + 1]), size);
+			const unsigned long code = p ? 0 : sim_err_invalid_size;
+			if (p) {
+				memcpy (p, data, size);
+				++stats.writes;
+			}
+			if (rdata && (4 * (i + 1) <= rlength)) {
+				memcpy (static_cast<char*>(rdata) + 4 * i, &code, 4);
+			}
+			data += size;
+		}
+	}
+	catch (...) {
+		return sim_err_invalid_size;
+	}
+	if (ret) *ret = std::min<unsigned long> (rlength, 4 * count);
+	return err;
+}
+
+/* tcSimTarget::add_notification
+ ************************************************************************/
+long tcSimTarget::add_notification (unsigned long group, unsigned long offset,
+	const AdsNotificationAttrib* attrib, PAdsNotificationFuncEx callback,
+	unsigned long user, unsigned long* handle) noexcept
+{
+	if (!attrib || !callback || !handle) {
+		return sim_err_invalid_size;
+	}
+	try {
+		notification n{group, offset, *attrib, callback, user,
+			chrono::steady_clock::now(), vector<char>(attrib->cbLength, 0)};
+		std::lock_guard lock (notifyMutex);
+		*handle = nextHandle++;
+		notifications.emplace (*handle, std::move (n));
+	}
+	catch (...) {
+		return sim_err_invalid_size;
+	}
+	return 0;
+}
+
+/* tcSimTarget::del_notification
+ ************************************************************************/
+long tcSimTarget::del_notification (unsigned long handle) noexcept
+{
+	std::lock_guard lock (notifyMutex);
+	return notifications.erase (handle) ? 0 : sim_err_invalid_handle;
+}
+
+/* tcSimTarget::tick
+ ************************************************************************/
+void tcSimTarget::tick (double elapsed) noexcept
+{
+	const double r = rate.load();
+	if (r > 0) {
+		try {
+			std::lock_guard lock (memMutex);
+			if (!slots.empty()) {
+				carry += r * elapsed;
+				long long n = (long long)carry;
+				carry -= (double)n;
+				if (n > sim_max_changes_per_tick) {
+					n = sim_max_changes_per_tick;
+					carry = 0;
+				}
+				for (long long i = 0; i < n; ++i) {
+					// xorshift64
+					random ^= random << 13;
+					random ^= random >> 7;
+					random ^= random << 17;
+					mutate (slots[random % slots.size()]);
+				}
+				stats.changes += n;
+			}
+		}
+		catch (...) {}
+	}
+	notify();
+}
+
+/* tcSimTarget::mutate
+ ************************************************************************/
+void tcSimTarget::mutate (const slot& s) noexcept
+{
+	tcSimulation& sim = tcSimulation::get();
+	char* const p = memory (s.group, s.offset, sim_type_size (s.type));
+	if (!p) return;
+	// small types toggle or count up
+	switch (s.type) {
+	case data_type_enum::dtBool:
+		*p = *p ? 0 : 1;
+		return;
+	case data_type_enum::dtInt8:
+	case data_type_enum::dtUInt8:
+		++*p;
+		return;
+	case data_type_enum::dtInt16:
+	case data_type_enum::dtUInt16:
+		{
+			int16_t v;
+			memcpy (&v, p, sizeof (v));
+			++v;
+			memcpy (p, &v, sizeof (v));
+			return;
+		}
+	default:
+		break;
+	}
+	// large types are set to the sequence number
+	const long long seq = sim.next_sequence();
+	const long long val = seq % sim_sequence_wrap;
+	switch (s.type) {
+	case data_type_enum::dtInt32:
+	case data_type_enum::dtUInt32:
+		{
+			const int32_t v = (int32_t)val;
+			memcpy (p, &v, sizeof (v));
+			break;
+		}
+	case data_type_enum::dtInt64:
+	case data_type_enum::dtUInt64:
+		{
+			const int64_t v = val;
+			memcpy (p, &v, sizeof (v));
+			break;
+		}
+	case data_type_enum::dtFloat:
+		{
+			const float v = (float)val;
+			memcpy (p, &v, sizeof (v));
+			break;
+		}
+	case data_type_enum::dtDouble:
+		{
+			const double v = (double)val;
+			memcpy (p, &v, sizeof (v));
+			break;
+		}
+	default:
+		return;
+	}
+	sim.record_change (seq, s.group, s.offset);
+}
+
+/* tcSimTarget::notify
+ ************************************************************************/
+void tcSimTarget::notify() noexcept
+{
+	try {
+		std::lock_guard lock (notifyMutex);
+		if (notifications.empty()) return;
+		const auto now = chrono::steady_clock::now();
+		const long long timestamp = filetime_now();
+		vector<char> buf;
+		for (auto& [handle, n] : notifications) {
+			if (n.due > now) continue;
+			// cycle time is in 100ns units
+			n.due = now + chrono::microseconds (std::max<unsigned long> (
+				n.attrib.nCycleTime / 10, 1000 * sim_tick_period));
+			const unsigned long len = (unsigned long)n.last.size();
+			// ADS state is sent once
+			if ((n.group == ADSIGRP_DEVICE_DATA) && (n.offset == ADSIOFFS_DEVDATA_ADSSTATE)) {
+				if (n.sent) continue;
+				const USHORT state = ADSSTATE_RUN;
+				memcpy (n.last.data(), &state, std::min<size_t> (len, sizeof (state)));
+			}
+			// data is sent on change
+			else {
+				std::lock_guard mlock (memMutex);
+				const char* const p = memory (n.group, n.offset, len);
+				if (!p || (n.sent && (memcmp (n.last.data(), p, len) == 0))) continue;
+				memcpy (n.last.data(), p, len);
+				++stats.notifications;
+			}
+			n.sent = true;
+			buf.resize (sizeof (AdsNotificationHeader) + len);
+			AdsNotificationHeader* const hdr = reinterpret_cast<AdsNotificationHeader*>(buf.data());
+			hdr->nTimeStamp = timestamp;
+			hdr->hNotification = handle;
+			hdr->cbSampleSize = len;
+			memcpy (hdr->data, n.last.data(), len);
+			n.callback (&addr, hdr, n.user);
+		}
+	}
+	catch (...) {}
+}
+
+
+/************************************************************************
+  tcSimulation
+ ************************************************************************/
+
+/* tcSimulation::gSimulation
+ ************************************************************************/
+tcSimulation tcSimulation::gSimulation;
+
+/* tcSimulation::~tcSimulation
+ ************************************************************************/
+tcSimulation::~tcSimulation()
+{
+	stop = true;
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+/* tcSimulation::add
+ ************************************************************************/
+tcSimTarget* tcSimulation::add (const AmsAddr& address)
+{
+	std::lock_guard lock (targetsMutex);
+	tcSimTarget* const t = lookup_locked (&address);
+	if (t) {
+		return t;
+	}
+	if (!history) {
+		history = make_unique<history_entry[]>(sim_history_size);
+	}
+	targets.push_back (make_unique<tcSimTarget>(address));
+	active = true;
+	if (!thread.joinable()) {
+		thread = std::thread (&tcSimulation::run, this);
+	}
+	return targets.back().get();
+}
+
+/* tcSimulation::lookup
+ ************************************************************************/
+tcSimTarget* tcSimulation::lookup (const AmsAddr* address) const noexcept
+{
+	std::lock_guard lock (targetsMutex);
+	return lookup_locked (address);
+}
+
+/* tcSimulation::lookup_locked
+ ************************************************************************/
+tcSimTarget* tcSimulation::lookup_locked (const AmsAddr* address) const noexcept
+{
+	if (!address) return nullptr;
+	for (const auto& t : targets) {
+		const AmsAddr& a = t->get_addr();
+		if ((a.port == address->port) &&
+			(memcmp (a.netId.b, address->netId.b, sizeof (a.netId.b)) == 0)) {
+			return t.get();
+		}
+	}
+	return nullptr;
+}
+
+/* tcSimulation::set_rate
+ ************************************************************************/
+void tcSimulation::set_rate (double rate) noexcept
+{
+	std::lock_guard lock (targetsMutex);
+	for (auto& t : targets) {
+		t->set_rate (rate);
+	}
+}
+
+/* tcSimulation::get_statistics
+ ************************************************************************/
+tcSimTarget::statistics tcSimulation::get_statistics() const noexcept
+{
+	tcSimTarget::statistics sum;
+	std::lock_guard lock (targetsMutex);
+	for (const auto& t : targets) {
+		const tcSimTarget::statistics s = t->get_statistics();
+		sum.changes += s.changes;
+		sum.reads += s.reads;
+		sum.readBytes += s.readBytes;
+		sum.writes += s.writes;
+		sum.notifications += s.notifications;
+		sum.slots += s.slots;
+	}
+	return sum;
+}
+
+/* tcSimulation::record_change
+ ************************************************************************/
+void tcSimulation::record_change (long long seq, unsigned long group,
+	unsigned long offset) noexcept
+{
+	if (!history) return;
+	history_entry& e = history[seq & (sim_history_size - 1)];
+	e.seq.store (-1, memory_order_relaxed);
+	e.location.store (((unsigned long long)group << 32) | offset, memory_order_relaxed);
+	e.time.store (chrono::duration_cast<chrono::nanoseconds>(
+		chrono::steady_clock::now().time_since_epoch()).count(), memory_order_relaxed);
+	e.seq.store (seq, memory_order_release);
+}
+
+/* tcSimulation::get_change_time
+ ************************************************************************/
+bool tcSimulation::get_change_time (double value, unsigned long group,
+	unsigned long offset, std::chrono::steady_clock::time_point& t) const noexcept
+{
+	if (!history || !isfinite (value)) return false;
+	const long long val = llround (value);
+	if ((val < 0) || (val >= sim_sequence_wrap)) return false;
+	// latest sequence number which wrote this value
+	const long long last = sequence.load();
+	const long long seq = last - ((last % sim_sequence_wrap) - val + sim_sequence_wrap) % sim_sequence_wrap;
+	if ((seq <= 0) || (last - seq >= sim_history_size)) return false;
+	const history_entry& e = history[seq & (sim_history_size - 1)];
+	if (e.seq.load (memory_order_acquire) != seq) return false;
+	const unsigned long long loc = e.location.load (memory_order_relaxed);
+	const long long ns = e.time.load (memory_order_relaxed);
+	if ((loc != (((unsigned long long)group << 32) | offset)) ||
+		(e.seq.load (memory_order_acquire) != seq)) {
+		return false;
+	}
+	t = chrono::steady_clock::time_point (chrono::duration_cast<chrono::steady_clock::duration>(
+		chrono::nanoseconds (ns)));
+	return true;
+}
+
+/* tcSimulation::run
+ ************************************************************************/
+void tcSimulation::run() noexcept
+{
+	auto last = chrono::steady_clock::now();
+	vector<tcSimTarget*> list;
+	while (!stop) {
+		this_thread::sleep_for (chrono::milliseconds (sim_tick_period));
+		const auto now = chrono::steady_clock::now();
+		const double elapsed = chrono::duration<double>(now - last).count();
+		last = now;
+		try {
+			list.clear();
+			{
+				std::lock_guard lock (targetsMutex);
+				for (auto& t : targets) list.push_back (t.get());
+			}
+			for (tcSimTarget* t : list) {
+				t->tick (elapsed);
+			}
+		}
+		catch (...) {}
+	}
+}
+
+}
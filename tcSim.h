@@ -0,0 +1,269 @@
+#pragma once
+#include "stdafx.h"
+#include <TcAdsDef.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <map>
+#include "plcBase.h"
+#include "ParseTpy.h"
+
+/** @file tcSim.h
+	Header which includes classes for a simulated ADS target. A simulated
+	target stands in for the ADS router and the PLC, so that the IOC can
+	be benchmarked without a TwinCAT system.
+ ************************************************************************/
+
+namespace TcComms {
+
+/** @defgroup tcsimgroup Simulated ADS target
+ ************************************************************************/
+/** @{ */
+
+/// Index group of the PLC memory (symbols in a tpy file)
+constexpr unsigned long sim_image_group = 0x4040;
+/// Maximum size of the memory of an index group (256 MB)
+constexpr unsigned long sim_max_group_size = 256UL * 1024UL * 1024UL;
+/// Period of the simulation thread in ms
+constexpr int sim_tick_period = 1;
+/// Number of entries in the change history (power of two)
+constexpr int sim_history_size = 1 << 20;
+/// Values written by the simulation wrap around at this number
+/// (all values are exactly representable by a float)
+constexpr long long sim_sequence_wrap = 1LL << 24;
+/// First port number handed out by the simulated targets
+constexpr long sim_port_base = 0x7F000000;
+
+/** This class simulates an ADS target. It serves reads, sum writes and
+	notifications from a memory image, as well as the symbol upload
+	encoded from a tpy file. It changes the values of the attached 
+	records at a configurable rate. Every change of a 32 or 64 bit value
+	writes a sequence number and is kept in a history, so that the time
+	of the change can be looked up from the value.
+	@brief Simulated ADS target
+ ************************************************************************/
+class tcSimTarget
+{
+public:
+	/// Statistics of a simulated target
+	struct statistics {
+		/// Number of values changed
+		uint64_t changes = 0;
+		/// Number of read requests
+		uint64_t reads = 0;
+		/// Number of bytes read
+		uint64_t readBytes = 0;
+		/// Number of values written
+		uint64_t writes = 0;
+		/// Number of notifications sent
+		uint64_t notifications = 0;
+		/// Number of attached values
+		uint64_t slots = 0;
+	};
+
+	/// Constructor
+	/// @param address AMS address of the target
+	explicit tcSimTarget (const AmsAddr& address) noexcept
+		: addr (address) {}
+
+	/// Get AMS address
+	const AmsAddr& get_addr() const noexcept { return addr; }
+	/// Load a memory image into an index group
+	/// @param fname File name of the memory image
+	/// @param group Index group
+	/// @return true if successful
+	bool load_image (const std::stringcase& fname,
+		unsigned long group = sim_image_group);
+	/// Load the symbol and data type tables served by the symbol upload
+	/// @param fname File name of the tpy file
+	/// @return true if successful
+	bool load_symbols (const std::stringcase& fname);
+	/// Get the number of value changes per second
+	double get_rate() const noexcept { return rate; }
+	/// Set the number of value changes per second
+	void set_rate (double r) noexcept { rate = (r > 0) ? r : 0; }
+	/// Attach the records of a PLC as values changed by the simulation
+	/// @param plc PLC which reads from this target
+	void attach (plc::BasePLC& plc);
+	/// Get statistics
+	statistics get_statistics() const noexcept;
+
+	/// Open an ADS port
+	long open_port() noexcept;
+	/// Read data
+	long read (unsigned long group, unsigned long offset,
+		unsigned long length, void* data, unsigned long* ret) noexcept;
+	/// Read and write data (only sum write 0xF081 is supported)
+	long read_write (unsigned long group, unsigned long offset,
+		unsigned long rlength, void* rdata, unsigned long wlength,
+		void* wdata, unsigned long* ret) noexcept;
+	/// Add a device notification
+	long add_notification (unsigned long group, unsigned long offset,
+		const AdsNotificationAttrib* attrib, PAdsNotificationFuncEx callback,
+		unsigned long user, unsigned long* handle) noexcept;
+	/// Delete a device notification
+	long del_notification (unsigned long handle) noexcept;
+
+	/// Advance the simulation (called by the simulation thread)
+	/// @param elapsed Time since the last call in seconds
+	void tick (double elapsed) noexcept;
+
+protected:
+	/// Memory location of a value changed by the simulation
+	struct slot {
+		unsigned long group;
+		unsigned long offset;
+		plc::data_type_enum type;
+	};
+	/// Notification registered by a client
+	struct notification {
+		unsigned long group;
+		unsigned long offset;
+		AdsNotificationAttrib attrib;
+		PAdsNotificationFuncEx callback;
+		unsigned long user;
+		std::chrono::steady_clock::time_point due;
+		std::vector<char> last;
+		bool sent = false;
+	};
+
+	/// Get the memory of a section, grows the group as needed
+	/// Must be called with the memory locked
+	char* memory (unsigned long group, unsigned long offset,
+		unsigned long length);
+	/// Read the symbol upload information or tables
+	long read_symbols (unsigned long group, unsigned long length,
+		void* data, unsigned long* ret) noexcept;
+	/// Change a value
+	/// Must be called with the memory locked
+	void mutate (const slot& s) noexcept;
+	/// Send the pending notifications
+	void notify() noexcept;
+
+	/// AMS address
+	AmsAddr			addr;
+	/// Memory by index group
+	std::map<unsigned long, std::vector<char>> groups;
+	/// Mutex for memory
+	mutable std::mutex memMutex;
+	/// Symbol and data type tables (protected by memory mutex)
+	ParseTpy::symbol_upload upload;
+	/// Number of symbols in the upload
+	unsigned long	numSymbols = 0;
+	/// Number of data types in the upload
+	unsigned long	numDatatypes = 0;
+	/// Values changed by the simulation
+	std::vector<slot> slots;
+	/// Value changes per second
+	std::atomic<double> rate = 0;
+	/// Fractional changes carried to the next tick
+	double			carry = 0;
+	/// State of the random generator
+	uint64_t		random = 0x9E3779B97F4A7C15ULL;
+	/// Notifications by handle
+	std::map<unsigned long, notification> notifications;
+	/// Mutex for notifications
+	mutable std::mutex notifyMutex;
+	/// Next notification handle
+	unsigned long	nextHandle = 1;
+	/// Statistics
+	statistics		stats;
+};
+
+/** This class manages the simulated ADS targets and runs the simulation
+	thread. The ADS calls of a TwinCAT PLC are served by the simulated
+	target which matches its AMS address.
+	@brief Simulation of ADS targets
+ ************************************************************************/
+class tcSimulation
+{
+public:
+	/// Get the simulation
+	static tcSimulation& get() noexcept { return gSimulation; }
+
+	/// Destructor
+	~tcSimulation();
+
+	/// Add a simulated target (returns the existing one for a known address)
+	/// @param address AMS address of the target
+	/// @return Simulated target, nullptr on error
+	tcSimTarget* add (const AmsAddr& address);
+	/// Find the simulated target of an address
+	/// @param address AMS address
+	/// @return Simulated target, nullptr if the address is not simulated
+	tcSimTarget* find (const AmsAddr* address) const noexcept {
+		return active.load (std::memory_order_acquire) ? lookup (address) : nullptr; }
+	/// Check if any target is simulated
+	bool is_active() const noexcept { return active.load(); }
+	/// Check if a port was opened by a simulated target
+	static bool is_sim_port (long port) noexcept { return port >= sim_port_base; }
+	/// Get a new port number
+	long next_port() noexcept { return nextPort++; }
+	/// Set the number of value changes per second of all targets
+	void set_rate (double rate) noexcept;
+	/// Get the statistics summed over all targets
+	tcSimTarget::statistics get_statistics() const noexcept;
+
+	/// Add a value change to the history
+	/// @param seq Sequence number (value written)
+	/// @param group Index group of the changed value
+	/// @param offset Index offset of the changed value
+	void record_change (long long seq, unsigned long group,
+		unsigned long offset) noexcept;
+	/// Look up the time of a change from the value written
+	/// @param value Value read from the record
+	/// @param group Index group of the record
+	/// @param offset Index offset of the record
+	/// @param t Time of the change (return)
+	/// @return true if the change was found in the history
+	bool get_change_time (double value, unsigned long group, unsigned long offset,
+		std::chrono::steady_clock::time_point& t) const noexcept;
+	/// Get the next sequence number
+	long long next_sequence() noexcept { return ++sequence; }
+
+protected:
+	/// Constructor
+	tcSimulation() = default;
+	/// Look up a target by address
+	tcSimTarget* lookup (const AmsAddr* address) const noexcept;
+	/// Look up a target by address (targets must be locked)
+	tcSimTarget* lookup_locked (const AmsAddr* address) const noexcept;
+	/// Simulation thread
+	void run() noexcept;
+
+	/// Entry of the change history
+	struct history_entry {
+		/// Sequence number of the change
+		std::atomic<long long> seq = -1;
+		/// Index group and offset of the change
+		std::atomic<unsigned long long> location = 0;
+		/// Time of the change in ns (steady clock)
+		std::atomic<long long> time = 0;
+	};
+
+	/// Simulated targets
+	std::vector<std::unique_ptr<tcSimTarget>> targets;
+	/// Mutex for targets
+	mutable std::mutex targetsMutex;
+	/// True if any target is simulated
+	std::atomic<bool> active = false;
+	/// Next port number
+	std::atomic<long> nextPort = sim_port_base;
+	/// Sequence number of the last change
+	std::atomic<long long> sequence = 0;
+	/// Change history (ring buffer indexed by sequence number)
+	std::unique_ptr<history_entry[]> history;
+	/// Simulation thread
+	std::thread thread;
+	/// Stop request for the simulation thread
+	std::atomic<bool> stop = false;
+
+	/// The one and only simulation
+	static tcSimulation gSimulation;
+};
+
+/** @} */
+
+}